@@ -2,8 +2,19 @@
 
 #include <iostream>
 #include <iomanip>
+#include <sstream>
+#include <algorithm>
+#include <thread>
+#include <atomic>
+#include <cstring>
 
 #include "TMath.h"
+#include "TEnv.h"
+#include "TBranch.h"
+#include "TROOT.h"
+#include "TMemFile.h"
+#include "TKey.h"
+#include "TObjString.h"
 
 #include "Utilities.hh"
 #include "LightYield.hh"
@@ -15,11 +26,33 @@
 #include "Compound.hh"
 #include "Kinematics.hh"
 #include "Reconstruction.hh"
+#include "TabulatedFunction.hh"
+#include "EnergyLossTable.hh"
+#include "TableCache.hh"
 
 #include "TSpline.h"
 
-Converter::Converter(std::vector<std::string>& inputFileNames, const std::string& outputFileName, Settings* settings)
-    : fSettings(settings) {
+Converter::Converter(std::vector<std::string>& inputFileNames, const std::string& outputFileName, Settings* settings, bool append)
+    : fSettings(settings), fEventBuilder(nullptr), fEntryList(nullptr), fSkimFile(nullptr), fSkimTree(nullptr), fSkimGenTree(nullptr), fSkimNofEvents(0), fOutput(nullptr), fNTupleOutput(nullptr), fUseRNTuple(false), fAppend(append), fNothingToAppend(false) {
+    if(fAppend) {
+        if(FileExists(outputFileName)) {
+            fInputFiles = ReadInputFileRecord(outputFileName);
+        } else {
+            std::cerr<<"Output file '"<<outputFileName<<"' doesn't exist yet, nothing to append to, creating it!"<<std::endl;
+            fAppend = false;
+        }
+    }
+    // Only the histograms can be appended: the tree would have to be read back and extended, a new cycle with just the
+    // new events would hide the earlier ones from everyone reading "tree" (and could push them out of the file).
+    if(fAppend && fSettings->WriteTree()) {
+        std::cerr<<"Can't append to the output tree, set WriteTree to false to append to the histograms of '"<<outputFileName<<"' only!"<<std::endl;
+        return;
+    }
+    // the histograms that are appended to are read from the output file, which has none if they went to separate files
+    if(fAppend && fSettings->SeparateHistogramFiles()) {
+        std::cerr<<"Can't append to histograms written to separate files, set Histograms.SeparateFiles to false to append to the histograms of '"<<outputFileName<<"'!"<<std::endl;
+        return;
+    }
     TistarSettings * trex_settings = NULL;
     //create TChain to read in all input files
     for(auto fileName = inputFileNames.begin(); fileName != inputFileNames.end(); ++fileName) {
@@ -27,22 +60,61 @@ Converter::Converter(std::vector<std::string>& inputFileNames, const std::string
             std::cerr<<"Failed to find file '"<<*fileName<<"', skipping it!"<<std::endl;
             continue;
         }
+        if(std::find(fInputFiles.begin(), fInputFiles.end(), *fileName) != fInputFiles.end()) {
+            std::cerr<<"File '"<<*fileName<<"' is already included in '"<<outputFileName<<"', skipping it!"<<std::endl;
+            continue;
+        }
+        fInputFiles.push_back(*fileName);
         //add sub-directory and tree name to file name
         //fileName->append(fSettings->NtupleName());
         //fChain.Add(fileName->c_str());
         std::string ntuple_name = *fileName + fSettings->NtupleName();
         fChain.Add(ntuple_name.c_str());
+        if(fSettings->UseEventBuilder()) {
+            // every input file is its own stream, the event builder merges them hit by hit
+            if(fEventBuilder == nullptr) {
+                fEventBuilder = new EventBuilder;
+            }
+            TChain* stream = new TChain;
+            stream->Add(ntuple_name.c_str());
+            SetInputBranches(*stream);
+            fEventBuilder->AddStream(stream);
+        }
         
         std::string generator_ntuple_name = *fileName + fSettings->TISTARGenNtupleName();
         fTISTARGenChain.Add(generator_ntuple_name.c_str());
 
         fRandom.SetSeed(1);
         if(!trex_settings) {
-            trex_settings = static_cast<TistarSettings*>(fChain.GetFile()->Get("settings"));
+            TFile* file = fChain.GetFile();
+            if(file == nullptr) {
+                std::cerr<<"Failed to open '"<<*fileName<<"' to read the TI-STAR settings!"<<std::endl;
+                continue;
+            }
+            trex_settings = static_cast<TistarSettings*>(file->Get("settings"));
+            if(trex_settings == nullptr) {
+                std::cerr<<"No TI-STAR settings in '"<<*fileName<<"'!"<<std::endl;
+                continue;
+            }
             trex_settings->Print();
             fSettings->SetTistarSettings(trex_settings);
         }
     }
+
+    // without new input files there is nothing to do, and the output file is left untouched
+    if(fChain.GetNtrees() == 0) {
+        if(fAppend) {
+            std::cout<<"All input files are already included in '"<<outputFileName<<"', nothing to append!"<<std::endl;
+            fNothingToAppend = true;
+        } else {
+            std::cerr<<"None of the input files could be found!"<<std::endl;
+        }
+        return;
+    }
+    if(trex_settings == nullptr) {
+        std::cerr<<"Failed to read the TI-STAR settings from any of the input files!"<<std::endl;
+        return;
+    }
  
     fTISTARGenGammaEnergy = 0;
     fTISTARGenGammaTheta = 0;
@@ -430,17 +502,6 @@ Converter::Converter(std::vector<std::string>& inputFileNames, const std::string
     };
     memcpy(GriffinDetMap, thisGriffinDetMap, sizeof(GriffinDetMap));
 
-    double thisGriffinDetMapCombos[7][2] = {
-        {0, 16},
-        {45, 32},
-        {60, 48},
-        {90, 64},
-        {120, 48},
-        {135, 32},
-        {180, 16}
-    };
-    memcpy(GriffinDetMapCombos, thisGriffinDetMapCombos, sizeof(GriffinDetMapCombos));
-
     double thisGriffinCryMap[64][64] = {
         {0.0000, 19.131, 27.184, 19.131, 49.631, 60.157, 46.607, 33.166, 72.817, 91.582, 88.418, 69.473, 49.631, 65.195, 76.694, 62.720, 60.157, 76.694, 86.721, 71.054, 44.341, 63.403, 66.891, 48.703, 53.690, 71.054, 65.195, 46.607, 78.429, 93.836, 82.965, 67.049, 103.31, 119.84, 108.95, 93.279, 116.60, 135.66, 131.30, 113.11, 108.95, 126.31, 133.39, 114.81, 86.164, 101.57, 112.95, 97.035, 88.418, 107.18, 110.53, 91.582, 114.81, 130.37, 117.28, 103.31, 160.87, 180.00, 160.87, 152.82, 119.84, 130.37, 146.83, 133.39},
         {19.131, 0.0000, 19.131, 27.184, 65.195, 71.054, 53.690, 46.607, 91.582, 110.53, 107.18, 88.418, 60.157, 71.054, 86.721, 76.694, 49.631, 62.720, 76.694, 65.195, 25.235, 44.341, 48.703, 31.860, 46.607, 60.157, 49.631, 33.166, 82.965, 93.836, 78.429, 67.049, 117.28, 130.37, 114.81, 103.31, 135.66, 154.77, 148.14, 131.30, 119.84, 133.39, 146.83, 130.37, 86.164, 97.035, 112.95, 101.57, 69.473, 88.418, 91.582, 72.817, 108.95, 119.84, 103.31, 93.279, 180.00, 160.87, 152.82, 160.87, 108.95, 114.81, 133.39, 126.31},
@@ -509,92 +570,19 @@ Converter::Converter(std::vector<std::string>& inputFileNames, const std::string
     };
     memcpy(GriffinCryMap, thisGriffinCryMap, sizeof(GriffinCryMap));
 
-    double thisGriffinCryMapCombos[52][2] = {
-        {0.0000, 64},
-        {19.131, 128},
-        {25.235, 64},
-        {27.184, 64},
-        {31.860, 64},
-        {33.166, 48},
-        {44.341, 128},
-        {46.607, 96},
-        {48.703, 128},
-        {49.631, 96},
-        {53.690, 48},
-        {60.157, 96},
-        {62.720, 48},
-        {63.403, 64},
-        {65.195, 96},
-        {66.891, 64},
-        {67.049, 64},
-        {69.473, 64},
-        {71.054, 96},
-        {72.817, 64},
-        {76.694, 96},
-        {78.429, 64},
-        {82.965, 64},
-        {86.164, 64},
-        {86.721, 48},
-        {88.418, 128},
-        {91.582, 128},
-        {93.279, 48},
-        {93.836, 64},
-        {97.035, 64},
-        {101.57, 64},
-        {103.31, 96},
-        {107.18, 64},
-        {108.95, 96},
-        {110.53, 64},
-        {112.95, 64},
-        {113.11, 64},
-        {114.81, 96},
-        {116.60, 64},
-        {117.28, 48},
-        {119.84, 96},
-        {126.31, 48},
-        {130.37, 96},
-        {131.30, 128},
-        {133.39, 96},
-        {135.66, 128},
-        {146.83, 48},
-        {148.14, 64},
-        {152.82, 64},
-        {154.77, 64},
-        {160.87, 128},
-        {180.00, 64}
-    };
-    memcpy(GriffinCryMapCombos, thisGriffinCryMapCombos, sizeof(GriffinCryMapCombos));
-
     //----------------------------------------------------------------------------------------------------
 
-    if(fSettings->WriteGriffinAddbackVector()) {
-        for(int i = 0; i < 4; i++) {
-            for(int j = 0; j < 16; j++) {
-                GriffinCrystalCenterVectors[i+(j*4)] = GriffinCrystalCenterPosition(i,j);
-                //std::cout << "cry = " << i << " det = " << j << " : x = " << GriffinCrystalCenterVectors[i+(j*4)].X() << " mm - y = " << GriffinCrystalCenterVectors[i+(j*4)].Y() << " mm - z = " << GriffinCrystalCenterVectors[i+(j*4)].Z() << " mm" << std::endl;
-            }
-        }
+    // replace the default geometry with the one from the geometry file (if there is one)
+    if(!fSettings->GeometryFile().empty()) {
+        ReadGeometry(fSettings->GeometryFile());
     }
+    // and compile the tables into the lookup tables used in the event loop
+    CompileGeometry();
 
     fSceptarHit = false;
 
     //add branches to input chain
-    fChain.SetBranchAddress("eventNumber", &fEventNumber);
-    fChain.SetBranchAddress("trackID", &fTrackID);
-    fChain.SetBranchAddress("parentID", &fParentID);
-    fChain.SetBranchAddress("stepNumber", &fStepNumber);
-    fChain.SetBranchAddress("particleType", &fParticleType);
-    fChain.SetBranchAddress("processType", &fProcessType);
-    fChain.SetBranchAddress("systemID", &fSystemID);
-    fChain.SetBranchAddress("detNumber", &fDetNumber);
-    fChain.SetBranchAddress("cryNumber", &fCryNumber);
-    fChain.SetBranchAddress("depEnergy", &fDepEnergy);
-    fChain.SetBranchAddress("posx", &fPosx);
-    fChain.SetBranchAddress("posy", &fPosy);
-    fChain.SetBranchAddress("posz", &fPosz);
-    fChain.SetBranchAddress("time", &fTime);
-    fChain.SetBranchAddress("targetZ", &fTargetZ);
-    fChain.SetBranchAddress("targetA", &fTargetA);
+    SetInputBranches(fChain);
 
     // add branches from the TRex derived generators
     // treeGen
@@ -618,18 +606,53 @@ Converter::Converter(std::vector<std::string>& inputFileNames, const std::string
     fTISTARGenChain.SetBranchAddress("gammaTheta",  &fTISTARGenGammaTheta,  &branchGammaTheta);
     fTISTARGenChain.SetBranchAddress("gammaPhi",    &fTISTARGenGammaPhi,    &branchGammaPhi);
 
+    // with implicit MT the baskets of the output tree (and the RNTuple pages) are compressed in parallel when they are flushed,
+    // so the event loop only waits for the slowest basket instead of all of them
+    if(fSettings->ImplicitMTThreads() != 0) {
+        ROOT::EnableImplicitMT(fSettings->ImplicitMTThreads() > 0 ? fSettings->ImplicitMTThreads() : 0);
+        if(fSettings->VerbosityLevel() > 0) {
+            std::cout<<"Using "<<ROOT::GetThreadPoolSize()<<" threads for output compression"<<std::endl;
+        }
+    }
+
     //create output file
-    fOutput = new TFile(outputFileName.c_str(),"recreate");
+    fOutput = new TFile(outputFileName.c_str(), fAppend ? "update" : "recreate");
     if(!fOutput->IsOpen()) {
         std::cerr<<"Failed to open file '"<<outputFileName<<"', check permissions on directory and disk space!"<<std::endl;
-        throw;
+        delete fOutput;
+        fOutput = nullptr;
+        return;
+    }
+    SetCompression(fOutput);
+    if(fAppend) {
+        LoadHistograms();
+    }
+
+    if(!fSettings->SkimFile().empty()) {
+        OpenSkim(fSettings->SkimFile());
     }
 
     //set tree to belong to output file
     if(fSettings->WriteTree())
         fTree.SetDirectory(fOutput);
 
+    // the RNTuple writer is created once all collections are known, the tree then stays without branches
+    if(fSettings->OutputFormat() == "RNTuple") {
+        if(!fSettings->WriteTree()) {
+            std::cerr<<"RNTuple output selected, but WriteTree is false, nothing will be written!"<<std::endl;
+        } else if(!RNTupleOutput::Available()) {
+            std::cerr<<"RNTuple output requires ROOT 6.34 or newer and a build with C++17, writing a TTree instead!"<<std::endl;
+        } else {
+            fUseRNTuple = true;
+        }
+    } else if(fSettings->OutputFormat() != "TTree") {
+        std::cerr<<"Unknown output format '"<<fSettings->OutputFormat()<<"', writing a TTree instead!"<<std::endl;
+    }
+
     //create branches for output tree
+    if(fSettings->FlatTree() && !fUseRNTuple) {
+        fTree.Branch("eventNumber", &fFlatEventNumber, "eventNumber/I", fSettings->BufferSize());
+    }
     // GRIFFIN
     fGriffinCrystal       = new std::vector<Detector>;
     fGriffinDetector      = new std::vector<Detector>;
@@ -638,132 +661,690 @@ Converter::Converter(std::vector<std::string>& inputFileNames, const std::string
     fGriffinArray         = new std::vector<Detector>;
     fGriffinBgo           = new std::vector<Detector>;
     fGriffinBgoBack       = new std::vector<Detector>;
-    fTree.Branch("GriffinCrystal",&fGriffinCrystal, fSettings->BufferSize());
-    fTree.Branch("GriffinDetector",&fGriffinDetector, fSettings->BufferSize());
-    fTree.Branch("GriffinNeighbour",&fGriffinNeighbour, fSettings->BufferSize());
-    fTree.Branch("GriffinNeighbourVector",&fGriffinNeighbourVector, fSettings->BufferSize());
-    fTree.Branch("GriffinArray",&fGriffinArray, fSettings->BufferSize());
-    fTree.Branch("GriffinBgo",&fGriffinBgo, fSettings->BufferSize());
-    fTree.Branch("GriffinBgo",&fGriffinBgoBack, fSettings->BufferSize());
+    AddOutputBranch("GriffinCrystal", fGriffinCrystal);
+    AddOutputBranch("GriffinDetector", fGriffinDetector);
+    AddOutputBranch("GriffinNeighbour", fGriffinNeighbour);
+    AddOutputBranch("GriffinNeighbourVector", fGriffinNeighbourVector);
+    AddOutputBranch("GriffinArray", fGriffinArray);
+    AddOutputBranch("GriffinBgo", fGriffinBgo);
+    AddOutputBranch("GriffinBgoBack", fGriffinBgoBack);
 
     // LaBr
     fLaBrArray            = new std::vector<Detector>;
     fLaBrDetector         = new std::vector<Detector>;
-    fTree.Branch("LaBrArray",&fLaBrArray, fSettings->BufferSize());
-    fTree.Branch("LaBrDetector",&fLaBrDetector, fSettings->BufferSize());
+    AddOutputBranch("LaBrArray", fLaBrArray);
+    AddOutputBranch("LaBrDetector", fLaBrDetector);
 
     // EightPi
     fEightPiArray            = new std::vector<Detector>;
     fEightPiDetector         = new std::vector<Detector>;
     fEightPiBgoDetector         = new std::vector<Detector>;
-    fTree.Branch("EightPiArray",&fEightPiArray, fSettings->BufferSize());
-    fTree.Branch("EightPiDetector",&fEightPiDetector, fSettings->BufferSize());
-    fTree.Branch("EightPiBgoDetector",&fEightPiBgoDetector, fSettings->BufferSize());
+    AddOutputBranch("EightPiArray", fEightPiArray);
+    AddOutputBranch("EightPiDetector", fEightPiDetector);
+    AddOutputBranch("EightPiBgoDetector", fEightPiBgoDetector);
 
     // Ancillary Detector
     fAncillaryBgoCrystal  = new std::vector<Detector>;
     fAncillaryBgoDetector = new std::vector<Detector>;
     fAncillaryBgoArray    = new std::vector<Detector>;
-    fTree.Branch("AncillaryBgoCrystal",&fAncillaryBgoCrystal, fSettings->BufferSize());
-    fTree.Branch("AncillaryBgoDetector",&fAncillaryBgoDetector, fSettings->BufferSize());
-    fTree.Branch("AncillaryBgoArray",&fAncillaryBgoArray, fSettings->BufferSize());
+    AddOutputBranch("AncillaryBgoCrystal", fAncillaryBgoCrystal);
+    AddOutputBranch("AncillaryBgoDetector", fAncillaryBgoDetector);
+    AddOutputBranch("AncillaryBgoArray", fAncillaryBgoArray);
 
     // SCEPTAR
     fSceptarArray         = new std::vector<Detector>;
     fSceptarDetector      = new std::vector<Detector>;
-    fTree.Branch("SceptarArray",&fSceptarArray, fSettings->BufferSize());
-    fTree.Branch("SceptarDetector",&fSceptarDetector, fSettings->BufferSize());
+    AddOutputBranch("SceptarArray", fSceptarArray);
+    AddOutputBranch("SceptarDetector", fSceptarDetector);
 
     // DESCANT
     fDescantArray            = new std::vector<Detector>;
-    fTree.Branch("DescantArray",&fDescantArray, fSettings->BufferSize());
+    AddOutputBranch("DescantArray", fDescantArray);
     fDescantBlueDetector = new std::vector<Detector>;
     fDescantGreenDetector = new std::vector<Detector>;
     fDescantRedDetector = new std::vector<Detector>;
     fDescantWhiteDetector = new std::vector<Detector>;
     fDescantYellowDetector = new std::vector<Detector>;
-    fTree.Branch("DescantBlueDetector",&fDescantBlueDetector, fSettings->BufferSize());
-    fTree.Branch("DescantGreenDetector",&fDescantGreenDetector, fSettings->BufferSize());
-    fTree.Branch("DescantRedDetector",&fDescantRedDetector, fSettings->BufferSize());
-    fTree.Branch("DescantWhiteDetector",&fDescantWhiteDetector, fSettings->BufferSize());
-    fTree.Branch("DescantYellowDetector",&fDescantYellowDetector, fSettings->BufferSize());
+    AddOutputBranch("DescantBlueDetector", fDescantBlueDetector);
+    AddOutputBranch("DescantGreenDetector", fDescantGreenDetector);
+    AddOutputBranch("DescantRedDetector", fDescantRedDetector);
+    AddOutputBranch("DescantWhiteDetector", fDescantWhiteDetector);
+    AddOutputBranch("DescantYellowDetector", fDescantYellowDetector);
 
     // Testcan
     fTestcanDetector         = new std::vector<Detector>;
-    fTree.Branch("TestcanDetector", &fTestcanDetector, fSettings->BufferSize());
+    AddOutputBranch("TestcanDetector", fTestcanDetector);
 
     // PACES
     fPacesArray         = new std::vector<Detector>;
     fPacesDetector      = new std::vector<Detector>;
-    fTree.Branch("PacesArray",&fPacesArray, fSettings->BufferSize());
-    fTree.Branch("PacesDetector",&fPacesDetector, fSettings->BufferSize());
+    AddOutputBranch("PacesArray", fPacesArray);
+    AddOutputBranch("PacesDetector", fPacesDetector);
 
     // TI-STAR
     fTISTARArray        = new std::vector<Detector>;
     fTISTARLayer1       = new std::vector<Detector>;
     fTISTARLayer2       = new std::vector<Detector>;
     fTISTARLayer3       = new std::vector<Detector>;
-    fTree.Branch("TISTARArray",         &fTISTARArray,       fSettings->BufferSize());     
-    fTree.Branch("TISTARLayer1",        &fTISTARLayer1,      fSettings->BufferSize());     
-    fTree.Branch("TISTARLayer2",        &fTISTARLayer2,      fSettings->BufferSize());     
-    fTree.Branch("TISTARLayer3",        &fTISTARLayer3,      fSettings->BufferSize());     
+    AddOutputBranch("TISTARArray", fTISTARArray);
+    AddOutputBranch("TISTARLayer1", fTISTARLayer1);
+    AddOutputBranch("TISTARLayer2", fTISTARLayer2);
+    AddOutputBranch("TISTARLayer3", fTISTARLayer3);
     
     fTISTARParticleVector = new std::vector<Particle>;
-    fTree.Branch("TISTARParticleVector", &fTISTARParticleVector, fSettings->BufferSize());
+    if(fUseRNTuple) {
+        fNTupleOutput = new RNTupleOutput(fOutput, "tree", fOutputCollections, fTISTARParticleVector);
+        if(!fNTupleOutput->IsOpen()) {
+            std::cerr<<"Failed to open the RNTuple output, writing a TTree instead!"<<std::endl;
+            delete fNTupleOutput;
+            fNTupleOutput = nullptr;
+            fUseRNTuple = false;
+            if(fSettings->FlatTree()) {
+                fTree.Branch("eventNumber", &fFlatEventNumber, "eventNumber/I", fSettings->BufferSize());
+            }
+            // no collections are added anymore, so the tree can point at the pointers stored in the list
+            for(auto collection = fOutputCollections.begin(); collection != fOutputCollections.end(); ++collection) {
+                AddTreeBranch(collection->first, collection->second);
+            }
+        }
+    }
+    if(!fUseRNTuple) {
+        fTree.Branch("TISTARParticleVector", &fTISTARParticleVector, fSettings->BufferSize());
+    }
 
+    // ring buffer of recent events for the pile-up overlay, big enough that the events piled up on
+    // one event (on average 2*rate*window) are rarely taken from the same event twice
+    fOverlayNext = 0;
+    fOverlayFilled = 0;
+    if(fSettings->OverlayRate() > 0.) {
+        if(fSettings->OverlayWindow() <= 0.) {
+            std::cerr<<"Overlay rate of "<<fSettings->OverlayRate()<<" Hz requires a positive overlay window, not "<<fSettings->OverlayWindow()<<" s, disabling overlay!"<<std::endl;
+        } else {
+            double expected = 2.*fSettings->OverlayRate()*fSettings->OverlayWindow();
+            fOverlayEvents.resize(1 + static_cast<size_t>(expected + 5.*TMath::Sqrt(expected)));
+            if(fSettings->VerbosityLevel() > 0) {
+                std::cout<<"Overlaying on average "<<expected<<" events, keeping the last "<<fOverlayEvents.size()<<" events"<<std::endl;
+            }
+        }
+    }
+
+    // detector systems, adding a new system only needs a new entry here
+    fSystemIndex.assign(10000, -1);
+    MapSystem(1000, RegisterSystem("GriffinCrystal", fGriffinCrystal, kMergeByCrystal, &Converter::FillGriffinHistograms, nullptr, true));
+    int index = RegisterSystem("GriffinBgo", fGriffinBgo, kNoMerge);
+    for(int systemId = 1010; systemId <= 1040; systemId += 10) {
+        MapSystem(systemId, index);
+    }
+    MapSystem(1050, RegisterSystem("GriffinBgoBack", fGriffinBgoBack, kNoMerge));
+    MapSystem(2000, RegisterSystem("LaBrDetector", fLaBrDetector, kMergeByDetector, &Converter::FillLaBrHistograms));
+    MapSystem(3000, RegisterSystem("AncillaryBgoCrystal", fAncillaryBgoCrystal, kMergeByCrystal));
+    MapSystem(5000, RegisterSystem("SceptarDetector", fSceptarDetector, kMergeByDetector, &Converter::FillSceptarHistograms, &fSceptarHit));
+    MapSystem(6000, RegisterSystem("EightPiDetector", fEightPiDetector, kMergeByDetector, &Converter::FillEightPiHistograms));
+    index = RegisterSystem("EightPiBgoDetector", fEightPiBgoDetector, kNoMerge);
+    for(int systemId = 6010; systemId <= 6030; systemId += 10) {
+        MapSystem(systemId, index);
+    }
+    MapSystem(8010, RegisterSystem("DescantBlueDetector", fDescantBlueDetector, kMergeByDetector, &Converter::FillDescantHistograms));
+    MapSystem(8020, RegisterSystem("DescantGreenDetector", fDescantGreenDetector, kMergeByDetector, &Converter::FillDescantHistograms));
+    MapSystem(8030, RegisterSystem("DescantRedDetector", fDescantRedDetector, kMergeByDetector, &Converter::FillDescantHistograms));
+    MapSystem(8040, RegisterSystem("DescantWhiteDetector", fDescantWhiteDetector, kMergeByDetector, &Converter::FillDescantHistograms));
+    MapSystem(8050, RegisterSystem("DescantYellowDetector", fDescantYellowDetector, kMergeByDetector, &Converter::FillDescantHistograms));
+    MapSystem(8500, RegisterSystem("TestcanDetector", fTestcanDetector, kNoMerge, &Converter::FillTestcanHistograms));
+    MapSystem(9000, RegisterSystem("PacesDetector", fPacesDetector, kMergeByDetector, &Converter::FillPacesHistograms));
+    index = RegisterSystem("TISTARArray", fTISTARArray, kNoMerge, &Converter::FillTistarHistograms);
+    fSystems[index].fLayers.push_back(fTISTARLayer1);
+    fSystems[index].fLayers.push_back(fTISTARLayer2);
+    fSystems[index].fLayers.push_back(fTISTARLayer3);
+    MapSystem(9500, index);
 }
 
-Converter::~Converter() {
-    if(fOutput->IsOpen()) {
-        if(fSettings->WriteTree())
-            fTree.Write("tree");
+void Converter::SetInputBranches(TChain& chain) {
+    chain.SetBranchAddress("eventNumber", &fEventNumber);
+    chain.SetBranchAddress("trackID", &fTrackID);
+    chain.SetBranchAddress("parentID", &fParentID);
+    chain.SetBranchAddress("stepNumber", &fStepNumber);
+    chain.SetBranchAddress("particleType", &fParticleType);
+    chain.SetBranchAddress("processType", &fProcessType);
+    chain.SetBranchAddress("systemID", &fSystemID);
+    chain.SetBranchAddress("detNumber", &fDetNumber);
+    chain.SetBranchAddress("cryNumber", &fCryNumber);
+    chain.SetBranchAddress("depEnergy", &fDepEnergy);
+    chain.SetBranchAddress("posx", &fPosx);
+    chain.SetBranchAddress("posy", &fPosy);
+    chain.SetBranchAddress("posz", &fPosz);
+    chain.SetBranchAddress("time", &fTime);
+    chain.SetBranchAddress("targetZ", &fTargetZ);
+    chain.SetBranchAddress("targetA", &fTargetA);
+}
+
+Int_t Converter::ReadEntry(Long64_t entry) {
+    if(fEventBuilder != nullptr) {
+        return fEventBuilder->Next();
+    }
+    if(fEntryList != nullptr) {
+        // entry is the index in the entry list of the prescan
+        return fChain.GetEntry(fChain.GetEntryNumber(entry));
+    }
+    return fChain.GetEntry(entry);
+}
+
+std::string Converter::CurrentInputFileName() {
+    // with the event builder the entries are read from the chain of one of the streams, fChain is never loaded
+    TChain* chain = &fChain;
+    if(fEventBuilder != nullptr) {
+        chain = fEventBuilder->CurrentChain();
+    }
+    if(chain == nullptr || chain->GetFile() == nullptr) {
+        return "<unknown>";
+    }
+    return chain->GetFile()->GetName();
+}
+
+bool Converter::Sampled(Long64_t eventIndex, Int_t eventNumber) {
+    // the random draw is done for every event, so the subsample only depends on the seed and the input
+    bool random = fSampleRandom.Uniform() < fSettings->SampleFraction();
+    if(eventIndex%fSettings->SampleStride() != 0) {
+        return false;
+    }
+    if(!fSettings->SampleRanges().empty()) {
+        bool inRange = false;
+        for(auto range = fSettings->SampleRanges().begin(); range != fSettings->SampleRanges().end(); ++range) {
+            if(range->first <= eventNumber && eventNumber <= range->second) {
+                inRange = true;
+                break;
+            }
+        }
+        if(!inRange) {
+            return false;
+        }
+    }
+    return random;
+}
+
+TEntryList* Converter::BuildEntryList() {
+    // First pass over the input that only reads the branches needed for the sampling and the trigger condition.
+    // All entries of accepted events go into the entry list, the full sort then only reads those.
+    // Once the maximum number of events has been accepted, neither this pass nor the sort reads any further.
+    bool trigger = fSettings->Prescan();
+    std::vector<bool> triggerSystem(fSystemIndex.size(), fSettings->TriggerSystems().empty());
+    for(auto systemId = fSettings->TriggerSystems().begin(); systemId != fSettings->TriggerSystems().end(); ++systemId) {
+        if(*systemId < 0 || *systemId >= static_cast<int>(triggerSystem.size())) {
+            std::cerr<<"Trigger system ID "<<*systemId<<" out of range, ignoring it!"<<std::endl;
+            continue;
+        }
+        triggerSystem[*systemId] = true;
+    }
+    fSampleRandom.SetSeed(fSettings->SampleSeed());
+
+    fChain.SetBranchStatus("*", 0);
+    fChain.SetBranchStatus("eventNumber", 1);
+    if(trigger) {
+        fChain.SetBranchStatus("systemID", 1);
+        fChain.SetBranchStatus("depEnergy", 1);
+    }
+
+    TEntryList* entryList = new TEntryList("prescan", "entries of sampled events passing the prescan trigger", &fChain);
+    Long64_t nEntries = fChain.GetEntries();
+    Long64_t firstEntry = 0;
+    int multiplicity = 0;
+    double energySum = 0.;
+    Long64_t nofEvents = 0;
+    Long64_t nofAccepted = 0;
+    int eventNumber = 0;
+    for(Long64_t i = 0; i <= nEntries; ++i) {
+        // one past the last entry flushes the last event
+        if(i < nEntries && fChain.GetEntry(i) <= 0) {
+            std::cerr<<"Error occured, couldn't read entry "<<i<<" from tree "<<fChain.GetName()<<" during the prescan"<<std::endl;
+            continue;
+        }
+        // events past SortNumberOfEvents aren't sorted, so the pass stops at the first entry of such an event
+        bool last = (i == nEntries || (fSettings->SortNumberOfEvents() > 0 && fEventNumber > fSettings->SortNumberOfEvents()));
+        if(last || (i > firstEntry && fEventNumber != eventNumber)) {
+            bool accepted = Sampled(nofEvents, eventNumber);
+            if(accepted && trigger) {
+                accepted = multiplicity >= fSettings->TriggerMultiplicity() && energySum >= fSettings->TriggerEnergySum();
+            }
+            ++nofEvents;
+            if(accepted) {
+                ++nofAccepted;
+                for(Long64_t entry = firstEntry; entry < i; ++entry) {
+                    entryList->Enter(entry, &fChain);
+                }
+                if(fSettings->SampleMaxEvents() > 0 && nofAccepted >= fSettings->SampleMaxEvents()) {
+                    break;
+                }
+            }
+            firstEntry = i;
+            multiplicity = 0;
+            energySum = 0.;
+        }
+        if(last) {
+            break;
+        }
+        eventNumber = fEventNumber;
+        if(trigger && fSystemID >= 0 && fSystemID < static_cast<int>(triggerSystem.size()) && triggerSystem[fSystemID] && fDepEnergy > fSettings->TriggerHitThreshold()) {
+            ++multiplicity;
+            energySum += fDepEnergy;
+        }
+    }
+
+    fChain.SetBranchStatus("*", 1);
+    fChain.SetEntryList(entryList);
+
+    if(fSettings->VerbosityLevel() > 0) {
+        std::cout<<"Prescan accepted "<<nofAccepted<<" of "<<nofEvents<<" events read ("<<entryList->GetN()<<" of "<<nEntries<<" entries)"<<std::endl;
+    }
+
+    return entryList;
+}
+
+static std::string TreeName(const std::string& ntupleName) {
+    // the ntuple names in the settings are paths inside the file, e.g. "/ntuple"
+    size_t slash = ntupleName.find_last_of('/');
+    if(slash == std::string::npos) {
+        return ntupleName;
+    }
+    return ntupleName.substr(slash+1);
+}
+
+void Converter::OpenSkim(const std::string& fileName) {
+    // The skim has the same layout as the simulation output, so it can be sorted again like any other input file:
+    // the hit ntuple, the generator tree, and the TI-STAR settings.
+    TDirectory* directory = gDirectory;
+    fSkimFile = new TFile(fileName.c_str(),"recreate");
+    if(!fSkimFile->IsOpen()) {
+        std::cerr<<"Failed to open skim file '"<<fileName<<"', not writing a skim!"<<std::endl;
+        delete fSkimFile;
+        fSkimFile = nullptr;
+        directory->cd();
+        return;
+    }
+    SetCompression(fSkimFile);
+    fSkimTree = new TTree(TreeName(fSettings->NtupleName()).c_str(), "skimmed hits");
+    fSkimTree->Branch("eventNumber", &fSkimHit.fEventNumber, "eventNumber/I");
+    fSkimTree->Branch("trackID", &fSkimHit.fTrackID, "trackID/I");
+    fSkimTree->Branch("parentID", &fSkimHit.fParentID, "parentID/I");
+    fSkimTree->Branch("stepNumber", &fSkimHit.fStepNumber, "stepNumber/I");
+    fSkimTree->Branch("particleType", &fSkimHit.fParticleType, "particleType/I");
+    fSkimTree->Branch("processType", &fSkimHit.fProcessType, "processType/I");
+    fSkimTree->Branch("systemID", &fSkimHit.fSystemID, "systemID/I");
+    fSkimTree->Branch("detNumber", &fSkimHit.fDetNumber, "detNumber/I");
+    fSkimTree->Branch("cryNumber", &fSkimHit.fCryNumber, "cryNumber/I");
+    fSkimTree->Branch("depEnergy", &fSkimHit.fDepEnergy, "depEnergy/D");
+    fSkimTree->Branch("posx", &fSkimHit.fPosx, "posx/D");
+    fSkimTree->Branch("posy", &fSkimHit.fPosy, "posy/D");
+    fSkimTree->Branch("posz", &fSkimHit.fPosz, "posz/D");
+    fSkimTree->Branch("time", &fSkimHit.fTime, "time/D");
+    fSkimTree->Branch("targetZ", &fSkimHit.fTargetZ, "targetZ/I");
+    fSkimTree->Branch("targetA", &fSkimHit.fTargetA, "targetA/D");
+
+    // the clone shares the branch addresses of the generator chain, so filling it copies the current generator entry
+    fTISTARGenChain.LoadTree(0);
+    fSkimGenTree = fTISTARGenChain.CloneTree(0);
+    if(fSkimGenTree != nullptr) {
+        fSkimGenTree->SetName(TreeName(fSettings->TISTARGenNtupleName()).c_str());
+        fSkimGenTree->SetDirectory(fSkimFile);
+    } else {
+        std::cerr<<"Failed to clone generator tree "<<fTISTARGenChain.GetName()<<", the skim won't have one!"<<std::endl;
+    }
+    // histograms are created later on, they must not end up in the skim file
+    directory->cd();
+}
+
+void Converter::WriteSkimEvent() {
+    // The generator tree has one entry per event, and the sort looks up the generator entry by event number.
+    // So the skimmed events are renumbered to stay in step with their generator entries.
+    for(auto hit = fSkimHits.begin(); hit != fSkimHits.end(); ++hit) {
+        fSkimHit = *hit;
+        fSkimHit.fEventNumber = fSkimNofEvents;
+        fSkimTree->Fill();
+    }
+    if(fSkimGenTree != nullptr) {
+        fSkimGenTree->Fill();
+    }
+    ++fSkimNofEvents;
+}
+
+std::vector<std::string> Converter::ReadInputFileRecord(const std::string& fileName) {
+    std::vector<std::string> result;
+    TFile file(fileName.c_str());
+    if(!file.IsOpen()) {
+        std::cerr<<"Failed to open '"<<fileName<<"' to read its list of input files!"<<std::endl;
+        return result;
+    }
+    TList* record = static_cast<TList*>(file.Get("inputFiles"));
+    if(record == nullptr) {
+        std::cerr<<"No list of input files in '"<<fileName<<"', can't check for files that are already included!"<<std::endl;
+        return result;
+    }
+    TIter next(record);
+    TObject* name;
+    while((name = next()) != nullptr) {
+        result.push_back(name->GetName());
+    }
+    record->Delete();
+    delete record;
+    if(fSettings->VerbosityLevel() > 0) {
+        std::cout<<fileName<<" already includes "<<result.size()<<" input files"<<std::endl;
+    }
+    return result;
+}
+
+void Converter::LoadHistograms() {
+    // The histograms of the existing output become the starting point. They are kept in the top directory like newly
+    // created ones, so the Get*Histogram functions find and keep filling them, and are written back over the old ones.
+    TIter nextDirectory(fOutput->GetListOfKeys());
+    TKey* directoryKey;
+    int nofHistograms = 0;
+    while((directoryKey = static_cast<TKey*>(nextDirectory())) != nullptr) {
+        if(strcmp(directoryKey->GetClassName(), "TDirectoryFile") != 0) {
+            continue;
+        }
+        TDirectory* directory = fOutput->GetDirectory(directoryKey->GetName());
+        if(directory == nullptr) {
+            continue;
+        }
+        if(fHistograms.find(directoryKey->GetName()) == fHistograms.end()) {
+            fHistograms[directoryKey->GetName()] = new TList;
+        }
+        TIter nextHistogram(directory->GetListOfKeys());
+        TKey* histogramKey;
+        while((histogramKey = static_cast<TKey*>(nextHistogram())) != nullptr) {
+            TObject* object = histogramKey->ReadObj();
+            if(object == nullptr) {
+                std::cerr<<"Failed to read "<<directoryKey->GetName()<<"/"<<histogramKey->GetName()<<" from "<<fOutput->GetName()<<", it will be replaced!"<<std::endl;
+                continue;
+            }
+            if(object->InheritsFrom(TH1::Class())) {
+                static_cast<TH1*>(object)->SetDirectory(fOutput);
+            } else {
+                fOutput->Append(object);
+            }
+            fHistograms[directoryKey->GetName()]->Add(object);
+            ++nofHistograms;
+        }
+    }
+    if(fSettings->VerbosityLevel() > 0) {
+        std::cout<<"Loaded "<<nofHistograms<<" histograms in "<<fHistograms.size()<<" directories from "<<fOutput->GetName()<<std::endl;
+    }
+}
+
+void Converter::SetCompression(TFile* file) {
+    // ROOT encodes the compression as 100*algorithm + level, the algorithm numbers are those of ROOT::RCompressionSetting::EAlgorithm
+    int algorithm = file->GetCompressionAlgorithm();
+    int level = file->GetCompressionLevel();
+    std::string name = fSettings->CompressionAlgorithm();
+    if(name == "ZLIB") {
+        algorithm = 1;
+    } else if(name == "LZMA") {
+        algorithm = 2;
+    } else if(name == "LZ4") {
+        algorithm = 4;
+    } else if(name == "ZSTD") {
+        algorithm = 5;
+    } else if(!name.empty()) {
+        std::cerr<<"Unknown compression algorithm '"<<name<<"', using the default for "<<file->GetName()<<"!"<<std::endl;
+    }
+    if(fSettings->CompressionLevel() > 9) {
+        std::cerr<<"Compression level "<<fSettings->CompressionLevel()<<" out of range (0-9), using the default for "<<file->GetName()<<"!"<<std::endl;
+    } else if(fSettings->CompressionLevel() >= 0) {
+        level = fSettings->CompressionLevel();
+    }
+    file->SetCompressionSettings(100*algorithm + level);
+}
+
+void Converter::AddOutputBranch(const std::string& name, std::vector<Detector>*& hits) {
+    fOutputCollections.push_back(std::make_pair(name, hits));
+    if(!fUseRNTuple) {
+        AddTreeBranch(name, hits);
+    }
+}
+
+void Converter::AddTreeBranch(const std::string& name, std::vector<Detector>*& hits) {
+    if(!fSettings->FlatTree()) {
+        fTree.Branch(name.c_str(), &hits, fSettings->BufferSize());
+        return;
+    }
+    // Flat schema: the number of hits and one plain array per field, no TObjects involved.
+    // Empty arrays only cost the hit count.
+    FlatBranch* branch = new FlatBranch;
+    branch->fName = name;
+    branch->fHits = hits;
+    branch->fN = 0;
+    std::string count = "n" + name;
+    fTree.Branch(count.c_str(), &(branch->fN), (count + "/I").c_str(), fSettings->BufferSize());
+    SetFlatCapacity(*branch, 16);
+    fFlatBranches.push_back(branch);
+}
+
+void Converter::SetFlatCapacity(FlatBranch& branch, size_t capacity) {
+    // the branches point directly into the arrays, so they have to be updated whenever the arrays are reallocated
+    branch.fDetector.resize(capacity);
+    branch.fCrystal.resize(capacity);
+    branch.fEnergy.resize(capacity);
+    branch.fSimulationEnergy.resize(capacity);
+    branch.fX.resize(capacity);
+    branch.fY.resize(capacity);
+    branch.fZ.resize(capacity);
+    branch.fTime.resize(capacity);
+    void* address[8] = { &branch.fDetector[0], &branch.fCrystal[0], &branch.fEnergy[0], &branch.fSimulationEnergy[0], &branch.fX[0], &branch.fY[0], &branch.fZ[0], &branch.fTime[0] };
+    if(branch.fBranches.empty()) {
+        const char* field[8] = { "detector", "crystal", "energy", "simEnergy", "x", "y", "z", "time" };
+        const char* type[8] = { "I", "I", "F", "F", "F", "F", "F", "D" };
+        for(int i = 0; i < 8; ++i) {
+            std::string leaf = branch.fName + "_" + field[i];
+            branch.fBranches.push_back(fTree.Branch(leaf.c_str(), address[i], (leaf + "[n" + branch.fName + "]/" + type[i]).c_str(), fSettings->BufferSize()));
+        }
+    } else {
+        for(int i = 0; i < 8; ++i) {
+            branch.fBranches[i]->SetAddress(address[i]);
+        }
+    }
+}
+
+void Converter::FillTree(Int_t eventNumber) {
+    if(!fSettings->FlatTree() && fNTupleOutput == nullptr) {
+        fTree.Fill();
+        return;
+    }
+    // events without any hits aren't written to the flat tree or the RNTuple at all
+    bool empty = fTISTARParticleVector->empty();
+    for(auto collection = fOutputCollections.begin(); collection != fOutputCollections.end() && empty; ++collection) {
+        empty = collection->second->empty();
+    }
+    if(empty) {
+        return;
+    }
+    if(fNTupleOutput != nullptr) {
+        fNTupleOutput->Fill(eventNumber);
+        return;
+    }
+    fFlatEventNumber = eventNumber;
+    for(auto it = fFlatBranches.begin(); it != fFlatBranches.end(); ++it) {
+        FlatBranch& branch = **it;
+        std::vector<Detector>& hits = *(branch.fHits);
+        branch.fN = hits.size();
+        if(hits.size() > branch.fEnergy.size()) {
+            SetFlatCapacity(branch, std::max(hits.size(), 2*branch.fEnergy.size()));
+        }
+        for(size_t i = 0; i < hits.size(); ++i) {
+            TVector3 position = hits[i].Position();
+            branch.fDetector[i] = hits[i].DetectorId();
+            branch.fCrystal[i] = hits[i].CrystalId();
+            branch.fEnergy[i] = hits[i].Energy();
+            branch.fSimulationEnergy[i] = hits[i].SimulationEnergy();
+            branch.fX[i] = position.X();
+            branch.fY[i] = position.Y();
+            branch.fZ[i] = position.Z();
+            branch.fTime[i] = hits[i].Time();
+        }
+    }
+    fTree.Fill();
+}
+
+void Converter::WriteHistograms() {
+    // record of the input files, so a later append doesn't include them twice
+    TList inputFiles;
+    inputFiles.SetOwner();
+    for(auto fileName = fInputFiles.begin(); fileName != fInputFiles.end(); ++fileName) {
+        inputFiles.Add(new TObjString(fileName->c_str()));
+    }
+    fOutput->cd();
+    inputFiles.Write("inputFiles", TObject::kSingleKey | TObject::kOverwrite);
+
+    if(fSettings->HistogramWriteThreads() <= 1 && !fSettings->SeparateHistogramFiles()) {
         for(auto list = fHistograms.begin(); list != fHistograms.end(); ++list) {
-            fOutput->mkdir(list->first.c_str());
+            // in append mode the directories exist already and the summed histograms replace the old ones
+            if(fOutput->GetDirectory(list->first.c_str()) == nullptr) {
+                fOutput->mkdir(list->first.c_str());
+            }
             fOutput->cd(list->first.c_str());
-            list->second->Write();
+            list->second->Write(nullptr, TObject::kOverwrite);
+        }
+        return;
+    }
+    // Each directory is compressed by one of the worker threads, either into a file of its own (same layout as the
+    // output file), or into an in-memory file whose keys are copied into the output file afterwards in the usual order.
+    // Copying a key takes its compressed buffer as is, so the main thread only does the I/O.
+    std::vector<std::pair<std::string, TList*> > directories(fHistograms.begin(), fHistograms.end());
+    std::vector<TFile*> files(directories.size(), nullptr);
+    bool separate = fSettings->SeparateHistogramFiles();
+    int compression = fOutput->GetCompressionSettings();
+    std::string baseName = fOutput->GetName();
+    if(baseName.size() > 5 && baseName.compare(baseName.size() - 5, 5, ".root") == 0) {
+        baseName.erase(baseName.size() - 5);
+    }
+
+    ROOT::EnableThreadSafety();
+    std::atomic<size_t> next(0);
+    auto worker = [&]() {
+        for(size_t i = next++; i < directories.size(); i = next++) {
+            TFile* file;
+            if(separate) {
+                file = new TFile((baseName + "_" + directories[i].first + ".root").c_str(), "recreate");
+            } else {
+                file = new TMemFile(Form("%s_%d", directories[i].first.c_str(), static_cast<int>(i)), "recreate");
+            }
+            if(!file->IsOpen()) {
+                std::cerr<<"Failed to open file '"<<file->GetName()<<"' for directory "<<directories[i].first<<", skipping it!"<<std::endl;
+                delete file;
+                continue;
+            }
+            file->SetCompressionSettings(compression);
+            if(separate) {
+                file->mkdir(directories[i].first.c_str());
+                file->cd(directories[i].first.c_str());
+            }
+            directories[i].second->Write();
+            if(separate) {
+                file->Close();
+                delete file;
+            } else {
+                files[i] = file;
+            }
+        }
+    };
+    size_t nofThreads = std::min(static_cast<size_t>(std::max(fSettings->HistogramWriteThreads(), 1)), directories.size());
+    std::vector<std::thread> threads;
+    for(size_t t = 1; t < nofThreads; ++t) {
+        threads.push_back(std::thread(worker));
+    }
+    worker();
+    for(auto thread = threads.begin(); thread != threads.end(); ++thread) {
+        thread->join();
+    }
+
+    for(size_t i = 0; i < directories.size(); ++i) {
+        if(files[i] == nullptr) {
+            continue;
+        }
+        TDirectory* directory = fOutput->GetDirectory(directories[i].first.c_str());
+        if(directory == nullptr) {
+            directory = fOutput->mkdir(directories[i].first.c_str());
+        }
+        TIter nextKey(files[i]->GetListOfKeys());
+        TKey* key;
+        while((key = static_cast<TKey*>(nextKey())) != nullptr) {
+            // the new key belongs to the directory, WriteFile only releases its buffer
+            if(fAppend) {
+                directory->Delete(Form("%s;*", key->GetName()));
+            }
+            TKey* copy = new TKey(directory, *key, 0);
+            copy->WriteFile();
+        }
+        delete files[i];
+    }
+    if(separate && fSettings->VerbosityLevel() > 0) {
+        std::cout<<"Wrote "<<directories.size()<<" histogram directories to "<<baseName<<"_<directory>.root"<<std::endl;
+    }
+}
+
+Converter::~Converter() {
+    if(fSkimFile != nullptr) {
+        fSkimFile->cd();
+        fSkimTree->Write();
+        if(fSkimGenTree != nullptr) {
+            fSkimGenTree->Write();
+        }
+        if(fSettings->GetTistarSettings() != nullptr) {
+            fSettings->GetTistarSettings()->Write("settings");
         }
+        if(fSettings->VerbosityLevel() > 0) {
+            std::cout<<"Wrote "<<fSkimNofEvents<<" events to skim file "<<fSkimFile->GetName()<<std::endl;
+        }
+        fSkimFile->Close();
+    }
+    if(fOutput != nullptr && fOutput->IsOpen()) {
+        // has to be committed before the file is closed
+        if(fNTupleOutput != nullptr) {
+            fOutput->cd();
+            delete fNTupleOutput;
+            fNTupleOutput = nullptr;
+        } else if(fSettings->WriteTree()) {
+            // never in append mode, the constructor refuses to append to the tree
+            fTree.Write("tree");
+        }
+        WriteHistograms();
         fOutput->Close();
     }
+    delete fEventBuilder;
+    for(auto branch = fFlatBranches.begin(); branch != fFlatBranches.end(); ++branch) {
+        delete *branch;
+    }
+    if(fEntryList != nullptr) {
+        fChain.SetEntryList(nullptr);
+        delete fEntryList;
+    }
 }
 
 bool Converter::Run() {
+    if(fNothingToAppend) {
+        return true;
+    }
+    if(fOutput == nullptr) {
+        std::cerr<<"Converter wasn't set up correctly, not processing any events!"<<std::endl;
+        return false;
+    }
     int status;
     int eventNumber = 0;
+    bool skimEvent = false;
     int trackID = 0;
-    // for 3d gamma-gamma correlations
-    int cry1 = 0;
-    int cry2 = 0;
-    int det1 = 0;
-    int det2 = 0;
-    int index = 0;
-    double cry1energy = 0;
-    double cry2energy = 0;
-    double det1energy = 0;
-    double det2energy = 0;
-    double angle = 0;
-    double norm = 0;
-
-    int descantArrayHits;
-    int descantBlueHits;
-    int descantGreenHits;
-    int descantRedHits;
-    int descantWhiteHits;
-    int descantYellowHits;
-
-    int testcanHits;   
 
 //    double buffer1 = 0;
 //    double buffer2 = 0;
 
-    double smearedEnergy;
-    std::map<int,int> belowThreshold;
-    std::map<int,int> outsideTimeWindow;
 
     TH1F* hist1D = NULL;
     TH2F* hist2D = NULL;
-    //TH3I* hist3D;
-    THnSparseF* histND = NULL;
     long int nEntries = fChain.GetEntries();
+    if(fSettings->Prescan() || fSettings->Sampling()) {
+        if(fEventBuilder != nullptr) {
+            std::cerr<<"Prescan and sampling can't be combined with the event builder, sorting all events!"<<std::endl;
+        } else {
+            fEntryList = BuildEntryList();
+            nEntries = fEntryList->GetN();
+        }
+    }
 
     //  const char* charbuffer;
     //  std::string stringbuffer;
@@ -841,22 +1422,42 @@ bool Converter::Run() {
         std::cout <<"Target BackwardZ from Input File: "<< targetBackwardZ<<" mm"<<std::endl;
         std::cout <<"Target Length from Input File: "<< targetLength<<" mm"<<std::endl;
     }
-    TSpline3* energyInTarget = beamTarget->Thickness2EnergyAfter(beamEnergy, targetThickness, targetThickness/1000., true);
-    energyInTarget->Write("energyInTarget");
+    // the splines only depend on the setup, so they are reused from earlier runs if a cache directory is set
+    TableCache tableCache(fSettings->GetTISTARCacheDirectory(), fSettings->VerbosityLevel());
+    TSpline3* energyInTargetSpline = tableCache.Thickness2EnergyAfter(beamTarget, beamEnergy, targetThickness, targetThickness/1000., true);
+    WriteSetupObject(energyInTargetSpline, "energyInTarget");
 
     // variables for recoil energy loss reconstruction (assuming max. recoil energy of 100 MeV!!!)
     Reconstruction* recoilTarget = new Reconstruction(recoil, targetMat);
     Reconstruction* recoilFoil = new Reconstruction(recoil, foilMat);
     Reconstruction* recoilLayer = new Reconstruction(recoil, layerMat);
     Reconstruction* recoilChamberGas = new Reconstruction(recoil, chamberGasMat);
-    TSpline3* recoilTargetRange  = recoilTarget->Energy2Range(100., 0.1, !isSolid);
-    TSpline3* recoilTargetEnergy = recoilTarget->Range2Energy(100., 0.1, !isSolid);
-    TSpline3* recoilFoilRange  = recoilFoil->Energy2Range(100., 0.1, false);
-    TSpline3* recoilFoilEnergy = recoilFoil->Range2Energy(100., 0.1, false);
-    TSpline3* recoilLayerRange  = recoilLayer->Energy2Range(100., 0.1, false);
-    TSpline3* recoilLayerEnergy = recoilLayer->Range2Energy(100., 0.1, false);
-    TSpline3* recoilChamberGasRange  = recoilChamberGas->Energy2Range(100., 0.1, true);
-    TSpline3* recoilChamberGasEnergy = recoilChamberGas->Range2Energy(100., 0.1, true); 
+    TSpline3* recoilTargetRangeSpline  = tableCache.Energy2Range(recoilTarget, 100., 0.1, !isSolid);
+    TSpline3* recoilTargetEnergySpline = tableCache.Range2Energy(recoilTarget, 100., 0.1, !isSolid);
+    TSpline3* recoilFoilRangeSpline  = tableCache.Energy2Range(recoilFoil, 100., 0.1, false);
+    TSpline3* recoilFoilEnergySpline = tableCache.Range2Energy(recoilFoil, 100., 0.1, false);
+    TSpline3* recoilLayerRangeSpline  = tableCache.Energy2Range(recoilLayer, 100., 0.1, false);
+    TSpline3* recoilLayerEnergySpline = tableCache.Range2Energy(recoilLayer, 100., 0.1, false);
+    TSpline3* recoilChamberGasRangeSpline  = tableCache.Energy2Range(recoilChamberGas, 100., 0.1, true);
+    TSpline3* recoilChamberGasEnergySpline = tableCache.Range2Energy(recoilChamberGas, 100., 0.1, true); 
+
+    // the event loop evaluates these many times per event, so they are sampled on uniform grids for O(1) lookups
+    double tableTolerance = fSettings->GetTISTARTableTolerance();
+    bool tableCubic = fSettings->GetTISTARTableCubic();
+    TabulatedFunction* energyInTarget = new TabulatedFunction(energyInTargetSpline, tableTolerance, tableCubic);
+    TabulatedFunction* recoilTargetRange  = new TabulatedFunction(recoilTargetRangeSpline, tableTolerance, tableCubic);
+    TabulatedFunction* recoilTargetEnergy = new TabulatedFunction(recoilTargetEnergySpline, tableTolerance, tableCubic);
+    TabulatedFunction* recoilFoilRange  = new TabulatedFunction(recoilFoilRangeSpline, tableTolerance, tableCubic);
+    TabulatedFunction* recoilFoilEnergy = new TabulatedFunction(recoilFoilEnergySpline, tableTolerance, tableCubic);
+    TabulatedFunction* recoilLayerRange  = new TabulatedFunction(recoilLayerRangeSpline, tableTolerance, tableCubic);
+    TabulatedFunction* recoilLayerEnergy = new TabulatedFunction(recoilLayerEnergySpline, tableTolerance, tableCubic);
+    TabulatedFunction* recoilChamberGasRange  = new TabulatedFunction(recoilChamberGasRangeSpline, tableTolerance, tableCubic);
+    TabulatedFunction* recoilChamberGasEnergy = new TabulatedFunction(recoilChamberGasEnergySpline, tableTolerance, tableCubic);
+    if(fSettings->VerbosityLevel() > 0) {
+        std::cout<<"energy loss tables: energy in target "<<energyInTarget->GetNofPoints()<<" points (max. deviation "<<energyInTarget->GetMaxError()<<" keV), "
+                 <<"recoil range in target/foil/layer/gas "<<recoilTargetRange->GetNofPoints()<<"/"<<recoilFoilRange->GetNofPoints()<<"/"<<recoilLayerRange->GetNofPoints()<<"/"<<recoilChamberGasRange->GetNofPoints()<<" points, "
+                 <<"recoil energy in target/foil/layer/gas "<<recoilTargetEnergy->GetNofPoints()<<"/"<<recoilFoilEnergy->GetNofPoints()<<"/"<<recoilLayerEnergy->GetNofPoints()<<"/"<<recoilChamberGasEnergy->GetNofPoints()<<" points"<<std::endl;
+    }
     
     double foilDistance = sett->GetTargetDiameter()/2.;
 
@@ -882,6 +1483,17 @@ bool Converter::Run() {
     std::cout<<"distance foil - 1. layer "<<firstLayerDistance - foilDistance<<" mm => 1. gas layer thickness = "<<firstGasLayerThicknessMgCm2<<" mg/cm^2"<<std::endl; // Leila
     std::cout<<"distance 1. layer - 2. layer "<<secondLayerDistance - firstLayerDistance<<" mm and chambergasdensity "<<chamberGasMat->GetDensity()<<" => 2. gas layer thickness = "<<secondGasLayerThicknessMgCm2<<" mg/cm^2"<<std::endl;
     std::cout<<"distance 2. layer - pad "<<padDistance - secondLayerDistance<<" mm => 3. gas layer thickness = "<<thirdGasLayerThicknessMgCm2<<" mg/cm^2"<<std::endl;
+
+    // recoils cross the foil and the (gas) target with the same path factor 1/sin(theta), so the energy loss in both is tabulated together
+    EnergyLossTable* recoilFoilTarget = new EnergyLossTable;
+    recoilFoilTarget->AddLayer(recoilFoilRange, recoilFoilEnergy, foilThicknessMgCm2);
+    recoilFoilTarget->AddLayer(recoilTargetRange, recoilTargetEnergy, targetWidthMgCm2);
+    if(!isSolid) {
+        recoilFoilTarget->Build(100000., fSettings->GetTISTARTableEnergyPoints(), fSettings->GetTISTARTableMaxPathFactor(), fSettings->GetTISTARTablePathFactorPoints(), fSettings->GetTISTARTableMaxError());
+        if(fSettings->VerbosityLevel() > 0) {
+            std::cout<<"foil and target energy loss table: max. deviation "<<recoilFoilTarget->GetMaxError()<<" keV, "<<recoilFoilTarget->GetNofInaccurateCells()<<" cells above "<<fSettings->GetTISTARTableMaxError()<<" keV are traced"<<std::endl;
+        }
+    }
   
     Particle part;
 
@@ -890,21 +1502,21 @@ bool Converter::Run() {
     std::cout<<"beam energy at front/middle/back of target: "<<beamEnergy<<"/";
     //transferP->SetEBeam(beamEnergy/sett->GetProjectileA());
     transferP->SetEBeam(beamEnergy);
-    TSpline3* front = transferP->Evslab(0., 180., 1.);
-    front->Write("RecoilEVsThetaLabFront");
+    TSpline3* front = tableCache.Evslab(transferP, 0., 180., 1.);
+    WriteSetupObject(front, "RecoilEVsThetaLabFront");
     //std::cout<<beamTarget->EnergyAfter(beamEnergy, -3, true)/sett->GetProjectileA()<<"/";
     std::cout<<energyInTarget->Eval(targetThickness/2.)/1000.<<"/";
     //transferP->SetEBeam(beamTarget->EnergyAfter(beamEnergy, -3, true)/sett->GetProjectileA());
     transferP->SetEBeam(energyInTarget->Eval(targetThickness/2.)/1000.);
-    TSpline3* middle = transferP->Evslab(0., 180., 1.);
-    middle->Write("RecoilEVsThetaLabMiddle");
+    TSpline3* middle = tableCache.Evslab(transferP, 0., 180., 1.);
+    WriteSetupObject(middle, "RecoilEVsThetaLabMiddle");
     //std::cout<<beamTarget->EnergyAfter(beamEnergy, -3, true)/sett->GetProjectileA()<<std::endl;
     std::cout<<energyInTarget->Eval(targetThickness)/1000.<<std::endl;
     //transferP->SetEBeam(beamTarget->EnergyAfter(beamEnergy, -3, true)/sett->GetProjectileA());
     transferP->SetEBeam(energyInTarget->Eval(targetThickness)/1000.);
 
-    TSpline3* back = transferP->Evslab(0., 180., 1.);
-    back->Write("RecoilEVsThetaLabBack");
+    TSpline3* back = tableCache.Evslab(transferP, 0., 180., 1.);
+    WriteSetupObject(back, "RecoilEVsThetaLabBack");
 
     double dE1Eloss=0;
     double dE2Eloss=0;
@@ -920,13 +1532,17 @@ bool Converter::Run() {
     
     CreateTistarHistograms(transferP);
 
+    if(fEventBuilder != nullptr) {
+        fEventBuilder->Start();
+    }
+
     for(int i = 0; i < nEntries; ++i) {
-        status = fChain.GetEntry(i);
+        status = ReadEntry(i);
         if(status == -1) {
-            std::cerr<<"Error occured, couldn't read entry "<<i<<" from tree "<<fChain.GetName()<<" in file "<<fChain.GetFile()->GetName()<<std::endl;
+            std::cerr<<"Error occured, couldn't read entry "<<i<<" from tree "<<fChain.GetName()<<" in file "<<CurrentInputFileName()<<std::endl;
             continue;
         } else if(status == 0) {
-            std::cerr<<"Error occured, entry "<<i<<" in tree "<<fChain.GetName()<<" in file "<<fChain.GetFile()->GetName()<<" doesn't exist"<<std::endl;
+            std::cerr<<"Error occured, entry "<<i<<" in tree "<<fChain.GetName()<<" in file "<<CurrentInputFileName()<<" doesn't exist"<<std::endl;
             return false;
         }        
 
@@ -943,10 +1559,13 @@ bool Converter::Run() {
         }
 
         //if this entry is from the next event, we fill the tree with everything we've collected so far (after SupressGriffinion) and reset the vector(s)
-        if((fEventNumber != eventNumber) && ((fSettings->SortNumberOfEvents()==0)||(fSettings->SortNumberOfEvents()>=eventNumber))) {
+        if(fEventNumber != eventNumber) {
             if(fSettings->VerbosityLevel() > 1) {
                 std::cout<<"-> Last hit of the event processed, adding to histograms..."<<std::endl;
             }
+
+            // without the TI-STAR requirement every sorted event is skimmed
+            skimEvent = !fSettings->SkimRequireTistar();
             
             // start process TISTAR hits
             // get the entry corresponding to the event we just finished looping over
@@ -1089,431 +1708,415 @@ bool Converter::Run() {
                     std::cout<<"Position of relative vector: "<< part.GetPosition().X()<<" "<<part.GetPosition().Y()<<" "<<part.GetPosition().Z()<<std::endl;
                 }
         
-                // error w/ inf's come up when both first/second position are 
-                // calculated as (0,0,0) so we just skip them for now...
-                if(firstposition == secondposition)  continue;
+                // error w/ inf's come up when both first/second position are
+                // calculated as (0,0,0) so we skip the reconstruction, the rest of the event is still processed
+                if(firstposition != secondposition) {
             
 
-                // reaction angles
-                double recoilThetaSim = fTISTARGenRecoilTheta*180./TMath::Pi();
-                recoilThetaRec = part.GetPosition().Theta()*180./TMath::Pi();
-                double recoilPhiSim = fTISTARGenRecoilPhi*180./TMath::Pi();
-                recoilPhiRec = part.GetPosition().Phi()*180./TMath::Pi();
-                if(fSettings->VerbosityLevel() > 1) std::cout<<"reaction phi from position: "<<recoilPhiRec<<" - "<<recoilPhiSim<<" = "<<(recoilPhiRec - recoilPhiSim)<<std::endl;
-                if(fSettings->VerbosityLevel() > 1) std::cout<<"reaction theta from position: "<<recoilThetaRec<<" - "<<recoilThetaSim<<" = "<<(recoilThetaRec - recoilThetaSim)<<std::endl;
+                    // reaction angles
+                    double recoilThetaSim = fTISTARGenRecoilTheta*180./TMath::Pi();
+                    recoilThetaRec = part.GetPosition().Theta()*180./TMath::Pi();
+                    double recoilPhiSim = fTISTARGenRecoilPhi*180./TMath::Pi();
+                    recoilPhiRec = part.GetPosition().Phi()*180./TMath::Pi();
+                    if(fSettings->VerbosityLevel() > 1) std::cout<<"reaction phi from position: "<<recoilPhiRec<<" - "<<recoilPhiSim<<" = "<<(recoilPhiRec - recoilPhiSim)<<std::endl;
+                    if(fSettings->VerbosityLevel() > 1) std::cout<<"reaction theta from position: "<<recoilThetaRec<<" - "<<recoilThetaSim<<" = "<<(recoilThetaRec - recoilThetaSim)<<std::endl;
     
-                TVector3 vertex;                   //reconstructed vertex
-                if(!isSolid) {
-                    //find the closest point between beam axis and vector of the two hits in the silicon tracker
-                    TVector3 r = part.GetPosition();  //relative vector from first hit to second hit
-                    TVector3 r2 = secondposition;     // vector to second hit
-                    double t = 0;                          //line parameter to calculate vertex; temp use only
-                    if((r*r - r.Z()*r.Z()) != 0 ) t = (r2*r - (r2.Z()*r.Z()))/(r*r - r.Z()*r.Z());
-                    vertex = r2 -( t*r);
-                } else {
-                    vertex.SetXYZ(0., 0., (targetForwardZ + targetBackwardZ)/2.); // middle of target
-                }
-                // forcing x/y of vertex to be zero
-                //vertex.SetX(0.);
-                //vertex.SetY(0.);
+                    TVector3 vertex;                   //reconstructed vertex
+                    if(!isSolid) {
+                        //find the closest point between beam axis and vector of the two hits in the silicon tracker
+                        TVector3 r = part.GetPosition();  //relative vector from first hit to second hit
+                        TVector3 r2 = secondposition;     // vector to second hit
+                        double t = 0;                          //line parameter to calculate vertex; temp use only
+                        if((r*r - r.Z()*r.Z()) != 0 ) t = (r2*r - (r2.Z()*r.Z()))/(r*r - r.Z()*r.Z());
+                        vertex = r2 -( t*r);
+                    } else {
+                        vertex.SetXYZ(0., 0., (targetForwardZ + targetBackwardZ)/2.); // middle of target
+                    }
+                    // forcing x/y of vertex to be zero
+                    //vertex.SetX(0.);
+                    //vertex.SetY(0.);
                 
-                if(fSettings->VerbosityLevel() > 1) {
-                    std::cout<<"Calculated Vertex:\t"<<vertex.X()<<"\t"<<vertex.Y()<<"\t"<<vertex.Z()<<std::endl;
-                    std::cout<<"Simulated Vertex: \t"<<fTISTARGenReactionX<<"\t"<<fTISTARGenReactionY<<"\t"<<fTISTARGenReactionZ<<std::endl;
-                }
+                    if(fSettings->VerbosityLevel() > 1) {
+                        std::cout<<"Calculated Vertex:\t"<<vertex.X()<<"\t"<<vertex.Y()<<"\t"<<vertex.Z()<<std::endl;
+                        std::cout<<"Simulated Vertex: \t"<<fTISTARGenReactionX<<"\t"<<fTISTARGenReactionY<<"\t"<<fTISTARGenReactionZ<<std::endl;
+                    }
 
-                //update particle information
-                if(vertex.Z() > targetForwardZ) {
-                    if(fSettings->VerbosityLevel() > 1) std::cout<<"Correcting vertex z from "<<vertex.Z();
-                    vertex.SetZ(targetForwardZ);
-                    if(fSettings->VerbosityLevel() > 1) std::cout<<" to "<<vertex.Z()<<std::endl;
-                }
-                if(vertex.Z() < targetBackwardZ) {
-                    if(fSettings->VerbosityLevel() > 1) std::cout<<"Correcting vertex z from "<<vertex.Z();
-                    vertex.SetZ(targetBackwardZ);
-                    if(fSettings->VerbosityLevel() > 1) std::cout<<" to "<<vertex.Z()<<std::endl;
-                }
-                hist1D = Get1DHistogram("DeltaZ_VertexCorrection","TISTAR1D",2000,-100,100);        
-                hist1D->Fill( (fTISTARGenReactionZ-vertex.Z()) );
-
-                // target length at reaction
-                double targetThickEvent;
-                if(isSolid) targetThickEvent = targetThickness/2.;
-                else        targetThickEvent = targetThickness * ( vertex.Z() - targetBackwardZ ) / targetLength;
-                if(fSettings->VerbosityLevel()>1) 
-                    std::cout<<"Target Thickness at reaction: "<<targetThickEvent<<" = "<<targetThickness<<" * ( "<<vertex.Z()<<" - "<<targetBackwardZ<<" ) / "<<targetLength<<std::endl;
+                    //update particle information
+                    if(vertex.Z() > targetForwardZ) {
+                        if(fSettings->VerbosityLevel() > 1) std::cout<<"Correcting vertex z from "<<vertex.Z();
+                        vertex.SetZ(targetForwardZ);
+                        if(fSettings->VerbosityLevel() > 1) std::cout<<" to "<<vertex.Z()<<std::endl;
+                    }
+                    if(vertex.Z() < targetBackwardZ) {
+                        if(fSettings->VerbosityLevel() > 1) std::cout<<"Correcting vertex z from "<<vertex.Z();
+                        vertex.SetZ(targetBackwardZ);
+                        if(fSettings->VerbosityLevel() > 1) std::cout<<" to "<<vertex.Z()<<std::endl;
+                    }
+                    hist1D = Get1DHistogram("DeltaZ_VertexCorrection","TISTAR1D",2000,-100,100);        
+                    hist1D->Fill( (fTISTARGenReactionZ-vertex.Z()) );
+
+                    // target length at reaction
+                    double targetThickEvent;
+                    if(isSolid) targetThickEvent = targetThickness/2.;
+                    else        targetThickEvent = targetThickness * ( vertex.Z() - targetBackwardZ ) / targetLength;
+                    if(fSettings->VerbosityLevel()>1) 
+                        std::cout<<"Target Thickness at reaction: "<<targetThickEvent<<" = "<<targetThickness<<" * ( "<<vertex.Z()<<" - "<<targetBackwardZ<<" ) / "<<targetLength<<std::endl;
     
-                //calculate target thickness for reconstruction of          
-                if(targetThickEvent > 0) beamEnergyRec = energyInTarget->Eval(targetThickEvent)/1000.;
-                else                     beamEnergyRec = beamEnergy;
-                if(fSettings->VerbosityLevel()>1) std::cout<<"Beam Energy at ???????????????????????????????? Reaction: "<<beamEnergyRec<<" MeV"<<std::endl;
-
-                // reconstruct energy of recoil
-                recoilEnergyRecdE    =  hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()-1) + hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1);
-                recoilEnergyRecErest =  hit->GetPadEnergy();
-                recoilEnergyRec = recoilEnergyRecdE + recoilEnergyRecErest;
-                //recoilEnergyRec =  recoilEnergyRecErest;
-                if(fSettings->VerbosityLevel()>1) { 
-                    std::cout<<" 1. layer energy: "<<hit->GetFirstDeltaEEnergy()<<" 2. layer energy: "<<hit->GetSecondDeltaEEnergy()<<" pad energy: "<<hit->GetPadEnergy()
-                             <<" => dE: "<<recoilEnergyRecdE<<", Erest: "<<recoilEnergyRecErest<<" => Erec: "<<recoilEnergyRec<<std::endl;
-                }
-                // reconstruct energy loss in gas and foil
-                double sinTheta = TMath::Sin(recoilThetaRec/180.*TMath::Pi());
-                double cosTheta = TMath::Cos(recoilThetaRec/180.*TMath::Pi());
-                double tmpPhi = recoilPhiRec; while(tmpPhi > 45.) tmpPhi -= 90.; while(tmpPhi < -45.) tmpPhi += 90.;
-                double cosPhi   = TMath::Cos(tmpPhi/180.*TMath::Pi());
-                double recoilEnergyRecEloss;
+                    //calculate target thickness for reconstruction of          
+                    if(targetThickEvent > 0) beamEnergyRec = energyInTarget->Eval(targetThickEvent)/1000.;
+                    else                     beamEnergyRec = beamEnergy;
+                    if(fSettings->VerbosityLevel()>1) std::cout<<"Beam Energy at ???????????????????????????????? Reaction: "<<beamEnergyRec<<" MeV"<<std::endl;
+
+                    // reconstruct energy of recoil
+                    recoilEnergyRecdE    =  hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()-1) + hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1);
+                    recoilEnergyRecErest =  hit->GetPadEnergy();
+                    recoilEnergyRec = recoilEnergyRecdE + recoilEnergyRecErest;
+                    //recoilEnergyRec =  recoilEnergyRecErest;
+                    if(fSettings->VerbosityLevel()>1) { 
+                        std::cout<<" 1. layer energy: "<<hit->GetFirstDeltaEEnergy()<<" 2. layer energy: "<<hit->GetSecondDeltaEEnergy()<<" pad energy: "<<hit->GetPadEnergy()
+                                 <<" => dE: "<<recoilEnergyRecdE<<", Erest: "<<recoilEnergyRecErest<<" => Erec: "<<recoilEnergyRec<<std::endl;
+                    }
+                    // reconstruct energy loss in gas and foil
+                    double sinTheta = TMath::Sin(recoilThetaRec/180.*TMath::Pi());
+                    double cosTheta = TMath::Cos(recoilThetaRec/180.*TMath::Pi());
+                    double tmpPhi = recoilPhiRec; while(tmpPhi > 45.) tmpPhi -= 90.; while(tmpPhi < -45.) tmpPhi += 90.;
+                    double cosPhi   = TMath::Cos(tmpPhi/180.*TMath::Pi());
+                    double recoilEnergyRecEloss;
  
-                if(isSolid) { // FOR SOLID TARGET
-                    //for the solid target we only need to reconstruct the energy loss in the foil and the target (no chamber gas)
-                    double range = recoilFoilRange->Eval(recoilEnergyRec);
-                    //recoilEnergyRecEloss = recoilFoilEnergy->Eval(range + foilThicknessMgCm2/(sinTheta*cosPhi));// original
-                    recoilEnergyRecEloss = recoilFoilEnergy->Eval(range + foilThicknessMgCm2/(sinTheta)); // changed bei Dennis
-                    range = recoilTargetRange->Eval(recoilEnergyRecEloss);
-                    recoilEnergyRecEloss = recoilTargetEnergy->Eval(range + targetThickness/2./TMath::Abs(cosTheta));
-                    // due to changing of the target foil from box to cylinder the ernergy loss is corrected by ommitting cosphi. Leila & Dennis
-                } 
-                else { // FOR GAS TARGET
-                    // need to reconstruct energy loss in chamber gas, foil, and target
-                    double range;
-                    if(fSettings->VerbosityLevel()>1) std::cout<<"theta "<<recoilThetaRec<<", phi "<<recoilPhiRec<<" (sinTheta "<<sinTheta<<", cosTheta "<<cosTheta<<", cosPhi "<<cosPhi<<"): ";
+                    if(isSolid) { // FOR SOLID TARGET
+                        //for the solid target we only need to reconstruct the energy loss in the foil and the target (no chamber gas)
+                        double range = recoilFoilRange->Eval(recoilEnergyRec);
+                        //recoilEnergyRecEloss = recoilFoilEnergy->Eval(range + foilThicknessMgCm2/(sinTheta*cosPhi));// original
+                        recoilEnergyRecEloss = recoilFoilEnergy->Eval(range + foilThicknessMgCm2/(sinTheta)); // changed bei Dennis
+                        range = recoilTargetRange->Eval(recoilEnergyRecEloss);
+                        recoilEnergyRecEloss = recoilTargetEnergy->Eval(range + targetThickness/2./TMath::Abs(cosTheta));
+                        // due to changing of the target foil from box to cylinder the ernergy loss is corrected by ommitting cosphi. Leila & Dennis
+                    } 
+                    else { // FOR GAS TARGET
+                        // need to reconstruct energy loss in chamber gas, foil, and target
+                        double range;
+                        if(fSettings->VerbosityLevel()>1) std::cout<<"theta "<<recoilThetaRec<<", phi "<<recoilPhiRec<<" (sinTheta "<<sinTheta<<", cosTheta "<<cosTheta<<", cosPhi "<<cosPhi<<"): ";
     
-                    //*** energy loss through the pad ***
-                    if(recoilEnergyRecErest > 0. ) {
-                        if(fSettings->VerbosityLevel()>1) std::cout<<"\n\n *** energy loss through the pad *** "<<std::endl;
+                        //*** energy loss through the pad ***
+                        if(recoilEnergyRecErest > 0. ) {
+                            if(fSettings->VerbosityLevel()>1) std::cout<<"\n\n *** energy loss through the pad *** "<<std::endl;
+
+                            if(fSettings->VerbosityLevel()>1) {
+                                std::cout<<"gas thickness: (padDistance - secondLayerDistance)/(sinTheta * cosPhi)"<<std::endl;
+                                std::cout<<"gas thickness: ("<<padDistance<<" - "<<secondLayerDistance<<")/("<<sinTheta<<" * "<<cosPhi<<")"<<std::endl;
+                                std::cout<<"from pad "<<recoilEnergyRecErest<<" through "<<(padDistance - secondLayerDistance)/(sinTheta*cosPhi)<<" mm gas \n";
+                            }
+                            range = recoilChamberGasRange->Eval(recoilEnergyRecErest);
+
+                            if(fSettings->VerbosityLevel()>1) std::cout<<"1. range from the pad Erest "<<range<<std::endl;
+
+                            dE2ElossRange = recoilLayerRange->Eval(recoilChamberGasEnergy->Eval(range + thirdGasLayerThicknessMgCm2/(sinTheta*cosPhi)));
+                            if(fSettings->VerbosityLevel()>1) std::cout<<"5.a second layer thickness: "<<sett->GetLayerDimensionVector()[1][0].x()<<" range of the second layer: "<<dE2ElossRange<<std::endl;
+                            dE2Eloss = recoilLayerEnergy->Eval(dE2ElossRange + secondLayerThicknessMgCm2/(sinTheta*cosPhi)) - recoilChamberGasEnergy->Eval(range + thirdGasLayerThicknessMgCm2/(sinTheta*cosPhi));
+                            dE2MeasMinRec = TMath::Abs(hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()>1) - dE2Eloss);
+                        
+                            Get1DHistogram("hdE2MeasMinRec","TistarAnalysis")->Fill(hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1) - dE2Eloss);                    
+                            Get1DHistogram("hdE2ElossRangeWoEpad0","TistarAnalysis")->Fill(dE2ElossRange);                    
+                            Get1DHistogram("hdE2Eloss","TistarAnalysis")->Fill(dE2Eloss);
+                            Get1DHistogram("hdE2Measured","TistarAnalysis")->Fill(hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1));
+                            Get2DHistogram("hdE2ElossVsMeasuredWoEpad0","TistarAnalysis")->Fill(dE2Eloss,hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1));
+
+                            recoilEnergyRecEloss = recoilChamberGasEnergy->Eval(range + thirdGasLayerThicknessMgCm2/(sinTheta*cosPhi)) + hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()>1);
+
+                            if(fSettings->VerbosityLevel()>1) {
+                                std::cout<<"2. energy loss from the pad + de2 "<<recoilEnergyRecEloss<<std::endl;
+                            }
+                            range = recoilChamberGasRange->Eval(recoilEnergyRecEloss);
+                            if(fSettings->VerbosityLevel()>1) {
+                                std::cout<<"3. range from the pad Eloss "<<range<<std::endl;
+                            }
+
+                            Get1DHistogram("hErestMeasured","TistarAnalysis")->Fill(hit->GetPadEnergy());
+                        }
+                        else {
+                            range = recoilChamberGasRange->Eval(hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()>1));
+                            if(fSettings->VerbosityLevel()>1) {
+                                std::cout<<"\n range from dE2 for Erest=0 "<<range<<std::endl;
+                            }
+                            dE2ElossRange = recoilLayerRange->Eval(range);
+                            dE2Eloss = recoilLayerEnergy->Eval(dE2ElossRange + secondLayerThicknessMgCm2/(sinTheta*cosPhi)) - recoilChamberGasEnergy->Eval(range);
+                            Get2DHistogram("hdE2ElossVsMeasured","TistarAnalysis")->Fill(dE2Eloss,hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()>1));
+                        }
+
+                        //*** energy loss through the second layer ***  
+                        dE1ElossRange = recoilLayerRange->Eval(recoilChamberGasEnergy->Eval(range + secondGasLayerThicknessMgCm2/(sinTheta*cosPhi)));
+                        if(fSettings->VerbosityLevel()>1) std::cout<<"7.a first layer thickness: "<<sett->GetLayerDimensionVector()[0][0].x()<<" range of the first layer: "<<dE1ElossRange<<std::endl;
+                        dE1Eloss = recoilLayerEnergy->Eval(dE1ElossRange + firstLayerThicknessMgCm2/(sinTheta*cosPhi)) - recoilChamberGasEnergy->Eval(range + secondGasLayerThicknessMgCm2/(sinTheta*cosPhi));
+                        dE1MeasMinRec = TMath::Abs(hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1) - dE1Eloss);
+                        Get1DHistogram("hdE1ElossRange","TistarAnalysis")->Fill(dE1ElossRange);
+                        Get1DHistogram("hdE1Eloss","TistarAnalysis")->Fill(dE1Eloss);
+                        Get1DHistogram("hdE1Measured","TistarAnalysis")->Fill(hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1));
+                        Get1DHistogram("hdE1MeasMinRec","TistarAnalysis")->Fill(hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1) - dE1Eloss);
+                        Get2DHistogram("hdE1ElossVsMeasured","TistarAnalysis")->Fill(dE1Eloss,hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1));
+                        if(recoilEnergyRecErest == 0.) Get2DHistogram("hdE1ElossVsMeasuredEpad0","TistarAnalysis")->Fill(dE1Eloss,hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1));
+                        if(recoilEnergyRecErest > 0.)  Get2DHistogram("hdE1ElossVsMeasuredEpadWo0","TistarAnalysis")->Fill(dE1Eloss,hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1));
 
                         if(fSettings->VerbosityLevel()>1) {
-                            std::cout<<"gas thickness: (padDistance - secondLayerDistance)/(sinTheta * cosPhi)"<<std::endl;
-                            std::cout<<"gas thickness: ("<<padDistance<<" - "<<secondLayerDistance<<")/("<<sinTheta<<" * "<<cosPhi<<")"<<std::endl;
-                            std::cout<<"from pad "<<recoilEnergyRecErest<<" through "<<(padDistance - secondLayerDistance)/(sinTheta*cosPhi)<<" mm gas \n";
+                            std::cout<<"7.b first layer thickness: "<<sett->GetLayerDimensionVector()[0][0].x()<<" range of the first layer: "<<dE1ElossRange
+                                     <<" energi loss "<<dE1Eloss<<" the measured energy: "<<hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1)
+                                     <<" total: "<<dE1MeasuredCorr<<std::endl;
+                            std::cout<<"\n\n *** energy loss through the second layer *** "<<std::endl;
+                            std::cout<<" with 2. layer "<<hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()>1)<<" ("<<recoilEnergyRecEloss
+                                     <<") through "<<(secondLayerDistance - firstLayerDistance)/(sinTheta*cosPhi)<<" mm gas \n";
+                            std::cout<<"4. range from the pad or second layer "<<range<<std::endl;
                         }
-                        range = recoilChamberGasRange->Eval(recoilEnergyRecErest);
 
-                        if(fSettings->VerbosityLevel()>1) std::cout<<"1. range from the pad Erest "<<range<<std::endl;
 
-                        dE2ElossRange = recoilLayerRange->Eval(recoilChamberGasEnergy->Eval(range + thirdGasLayerThicknessMgCm2/(sinTheta*cosPhi)));
-                        if(fSettings->VerbosityLevel()>1) std::cout<<"5.a second layer thickness: "<<sett->GetLayerDimensionVector()[1][0].x()<<" range of the second layer: "<<dE2ElossRange<<std::endl;
-                        dE2Eloss = recoilLayerEnergy->Eval(dE2ElossRange + secondLayerThicknessMgCm2/(sinTheta*cosPhi)) - recoilChamberGasEnergy->Eval(range + thirdGasLayerThicknessMgCm2/(sinTheta*cosPhi));
-                        dE2MeasMinRec = TMath::Abs(hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()>1) - dE2Eloss);
-                        
-                        Get1DHistogram("hdE2MeasMinRec","TistarAnalysis")->Fill(hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1) - dE2Eloss);                    
-                        Get1DHistogram("hdE2ElossRangeWoEpad0","TistarAnalysis")->Fill(dE2ElossRange);                    
-                        Get1DHistogram("hdE2Eloss","TistarAnalysis")->Fill(dE2Eloss);
-                        Get1DHistogram("hdE2Measured","TistarAnalysis")->Fill(hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1));
-                        Get2DHistogram("hdE2ElossVsMeasuredWoEpad0","TistarAnalysis")->Fill(dE2Eloss,hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1));
+                        recoilEnergyRecEloss = recoilChamberGasEnergy->Eval(range + secondGasLayerThicknessMgCm2/(sinTheta*cosPhi)) + hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1);
+                        if(fSettings->VerbosityLevel()>1) {
+                            std::cout<<"5. energy loss from the second layer + de1 "<<recoilEnergyRecEloss<<std::endl;
+                        }
 
-                        recoilEnergyRecEloss = recoilChamberGasEnergy->Eval(range + thirdGasLayerThicknessMgCm2/(sinTheta*cosPhi)) + hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()>1);
+                        // for now the foil is box-shaped as well, so we can just continue the same way
 
+                        //*** energy loss through the first layer ***
                         if(fSettings->VerbosityLevel()>1) {
-                            std::cout<<"2. energy loss from the pad + de2 "<<recoilEnergyRecEloss<<std::endl;
+                            std::cout<<"\n\n *** energy loss through the first layer *** "<<std::endl;
+                            std::cout<<" with 1. layer "<<hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1)<<" ("<<recoilEnergyRecEloss<<") through "<<(firstLayerDistance - foilDistance)/(sinTheta*cosPhi)<<" mm gas \n";
                         }
                         range = recoilChamberGasRange->Eval(recoilEnergyRecEloss);
+
                         if(fSettings->VerbosityLevel()>1) {
-                            std::cout<<"3. range from the pad Eloss "<<range<<std::endl;
+                            std::cout<<"6. range from the pad or second layer "<<range<<std::endl;
                         }
+                        //recoilEnergyRecEloss = recoilChamberGasEnergy->Eval(range + firstGasLayerThicknessMgCm2/(sinTheta*cosPhi)); // original
+                        recoilEnergyRecEloss = recoilChamberGasEnergy->Eval(range + (targetWidthMgCm2*(1 - cosPhi) + 100.*chamberGasMat->GetDensity()*(firstLayerDistance - foilDistance)/(sinTheta*cosPhi))); 
+                        // changed by Leila: effectiveLength(firstLayer - vertex)/sinTheta*cosPhi - targetRadii/sinTheta = a0/sinTheta*cosPhi - Rt/sinTheta 
 
-                        Get1DHistogram("hErestMeasured","TistarAnalysis")->Fill(hit->GetPadEnergy());
-                    }
-                    else {
-                        range = recoilChamberGasRange->Eval(hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()>1));
                         if(fSettings->VerbosityLevel()>1) {
-                            std::cout<<"\n range from dE2 for Erest=0 "<<range<<std::endl;
+                            std::cout<<"7. energy loss from the first layer "<<recoilEnergyRecEloss<<std::endl;
                         }
-                        dE2ElossRange = recoilLayerRange->Eval(range);
-                        dE2Eloss = recoilLayerEnergy->Eval(dE2ElossRange + secondLayerThicknessMgCm2/(sinTheta*cosPhi)) - recoilChamberGasEnergy->Eval(range);
-                        Get2DHistogram("hdE2ElossVsMeasured","TistarAnalysis")->Fill(dE2Eloss,hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()>1));
-                    }
 
-                    //*** energy loss through the second layer ***  
-                    dE1ElossRange = recoilLayerRange->Eval(recoilChamberGasEnergy->Eval(range + secondGasLayerThicknessMgCm2/(sinTheta*cosPhi)));
-                    if(fSettings->VerbosityLevel()>1) std::cout<<"7.a first layer thickness: "<<sett->GetLayerDimensionVector()[0][0].x()<<" range of the first layer: "<<dE1ElossRange<<std::endl;
-                    dE1Eloss = recoilLayerEnergy->Eval(dE1ElossRange + firstLayerThicknessMgCm2/(sinTheta*cosPhi)) - recoilChamberGasEnergy->Eval(range + secondGasLayerThicknessMgCm2/(sinTheta*cosPhi));
-                    dE1MeasMinRec = TMath::Abs(hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1) - dE1Eloss);
-                    Get1DHistogram("hdE1ElossRange","TistarAnalysis")->Fill(dE1ElossRange);
-                    Get1DHistogram("hdE1Eloss","TistarAnalysis")->Fill(dE1Eloss);
-                    Get1DHistogram("hdE1Measured","TistarAnalysis")->Fill(hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1));
-                    Get1DHistogram("hdE1MeasMinRec","TistarAnalysis")->Fill(hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1) - dE1Eloss);
-                    Get2DHistogram("hdE1ElossVsMeasured","TistarAnalysis")->Fill(dE1Eloss,hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1));
-                    if(recoilEnergyRecErest == 0.) Get2DHistogram("hdE1ElossVsMeasuredEpad0","TistarAnalysis")->Fill(dE1Eloss,hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1));
-                    if(recoilEnergyRecErest > 0.)  Get2DHistogram("hdE1ElossVsMeasuredEpadWo0","TistarAnalysis")->Fill(dE1Eloss,hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1));
-
-                    if(fSettings->VerbosityLevel()>1) {
-                        std::cout<<"7.b first layer thickness: "<<sett->GetLayerDimensionVector()[0][0].x()<<" range of the first layer: "<<dE1ElossRange
-                                 <<" energi loss "<<dE1Eloss<<" the measured energy: "<<hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1)
-                                 <<" total: "<<dE1MeasuredCorr<<std::endl;
-                        std::cout<<"\n\n *** energy loss through the second layer *** "<<std::endl;
-                        std::cout<<" with 2. layer "<<hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()>1)<<" ("<<recoilEnergyRecEloss
-                                 <<") through "<<(secondLayerDistance - firstLayerDistance)/(sinTheta*cosPhi)<<" mm gas \n";
-                        std::cout<<"4. range from the pad or second layer "<<range<<std::endl;
-                    }
+                        //*** energy loss through the foil and the target ***
+                        // for now assume that the "box" inside the foil is filled with target gas. Not box any more. It is a cylinder --> phi is ommitted!
+                        if(fSettings->VerbosityLevel()>1) {
+                            std::cout<<"\n\n *** energy loss through the foil and the target *** "<<std::endl;
+                            std::cout<<" at "<<recoilEnergyRecEloss<<" through "<<foilThicknessMgCm2/(sinTheta)<<" mg/cm^2 foil and "<<targetWidthMgCm2/(sinTheta)<<" mg/cm^2 gas \n";
+                        }
+                        double energyBeforeFoil = recoilEnergyRecEloss;
+                        if(recoilFoilTarget->Contains(energyBeforeFoil, 1./sinTheta)) {
+                            recoilEnergyRecEloss = recoilFoilTarget->Eval(energyBeforeFoil, 1./sinTheta);
+                        } else {
+                            recoilEnergyRecEloss = recoilFoilTarget->Trace(energyBeforeFoil, 1./sinTheta);
+                        }
 
+                        if(fSettings->VerbosityLevel()>1) {
+                            std::cout<<"8. energy loss from the foil and the target "<<recoilEnergyRecEloss<<" (traced layer by layer "<<recoilFoilTarget->Trace(energyBeforeFoil, 1./sinTheta)<<")"<<std::endl;
+                            std::cout<<" => "<<recoilEnergyRecEloss<<std::endl;
+                        }
 
-                    recoilEnergyRecEloss = recoilChamberGasEnergy->Eval(range + secondGasLayerThicknessMgCm2/(sinTheta*cosPhi)) + hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1);
+
+                    } // end gas target
                     if(fSettings->VerbosityLevel()>1) {
-                        std::cout<<"5. energy loss from the second layer + de1 "<<recoilEnergyRecEloss<<std::endl;
+                        std::cout<<"\n theta "<<recoilThetaRec<<", phi "<<recoilPhiRec<<" (sinTheta "<<sinTheta<<", tmpPhi "<<tmpPhi<<", cosPhi "<<cosPhi<<"): "
+                                 <<foilThicknessMgCm2/(sinTheta)<<" mg/cm^2, "<<recoilEnergyRec<<" => "<<recoilEnergyRecEloss<<", diff "<<recoilEnergyRecEloss-recoilEnergyRec<<std::endl;
                     }
 
-                    // for now the foil is box-shaped as well, so we can just continue the same way
+                    // position has already been set above
+                    part.SetRecEnergy(recoilEnergyRec);
+                    part.SetType(2); //proton; this is for one-neutron transfer, only; this sets the mass of the particle
+                    part.SetReconstructed(); // set TLorentzVector using mass, rec. energy, and position 
 
-                    //*** energy loss through the first layer ***
-                    if(fSettings->VerbosityLevel()>1) {
-                        std::cout<<"\n\n *** energy loss through the first layer *** "<<std::endl;
-                        std::cout<<" with 1. layer "<<hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1)<<" ("<<recoilEnergyRecEloss<<") through "<<(firstLayerDistance - foilDistance)/(sinTheta*cosPhi)<<" mm gas \n";
-                    }
-                    range = recoilChamberGasRange->Eval(recoilEnergyRecEloss);
+                    //////////////////////////
+                    // Q-value reconstruction
+                    //////////////////////////
 
-                    if(fSettings->VerbosityLevel()>1) {
-                        std::cout<<"6. range from the pad or second layer "<<range<<std::endl;
-                    }
-                    //recoilEnergyRecEloss = recoilChamberGasEnergy->Eval(range + firstGasLayerThicknessMgCm2/(sinTheta*cosPhi)); // original
-                    recoilEnergyRecEloss = recoilChamberGasEnergy->Eval(range + (targetWidthMgCm2*(1 - cosPhi) + 100.*chamberGasMat->GetDensity()*(firstLayerDistance - foilDistance)/(sinTheta*cosPhi))); 
-                    // changed by Leila: effectiveLength(firstLayer - vertex)/sinTheta*cosPhi - targetRadii/sinTheta = a0/sinTheta*cosPhi - Rt/sinTheta 
+                    transferP->SetEBeam(beamEnergyRec);
+                    transferP->Final(recoilThetaRec/180.*TMath::Pi(), 2, true);
+                    transferP->SetAngles(recoilThetaRec/180.*TMath::Pi(), 2, true);
+                    double excEnergy = transferP->GetExcEnergy(part.GetReconstructed(), fSettings->VerbosityLevel()-1);
 
+                    double recoilThetaCmRec = transferP->GetThetacm(3)/TMath::Pi()*180.;
                     if(fSettings->VerbosityLevel()>1) {
-                        std::cout<<"7. energy loss from the first layer "<<recoilEnergyRecEloss<<std::endl;
-                    }
+                        std::cout<<"\n beamEnergyRec "<<beamEnergyRec<<" => eex = "<<excEnergy<<" (middle spline at "<<recoilThetaRec<<" = "<<middle->Eval(recoilThetaRec)<<", recoilEnergyRec = "<<recoilEnergyRec<<")"<<std::endl;
+                        std::cout<<"recoilThetaCmRec = "<<recoilThetaCmRec<<", "<<transferP->GetThetacm(3)<<", "<<transferP->GetThetacm(2)<<", "<<transferP->GetThetacm(1)<<", "<<transferP->GetThetacm(0)<<std::endl;
 
-                    //*** energy loss through the foil ***
-                    if(fSettings->VerbosityLevel()>1) {
-                        std::cout<<"\n\n *** energy loss through the foil *** "<<std::endl;
-                        std::cout<<" at "<<recoilEnergyRecEloss<<" through "<<foilThicknessMgCm2/(sinTheta*cosPhi)<<" mm foil \n";
+                        if(excEnergy>5000) std::cout<<"!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!1********************************1 excEnergy: "<<excEnergy<<" 1. layer E "<< hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1)<<" 2. layer E "<< hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()>1)<<" Epad: "<<recoilEnergyRecErest<<" Epad from hit: "<<hit->GetPadEnergy()<<std::endl;
                     }
-                    range = recoilFoilRange->Eval(recoilEnergyRecEloss);
 
-                    if(fSettings->VerbosityLevel()>1) {
-                        std::cout<<"8. range from the foil "<<range<<std::endl;
+                    ///////////////////////
+                    // Fill some histograms
+                    ///////////////////////
+
+                    Get1DHistogram("reaction","TistarAnalysis")->Fill(fTISTARGenReaction);
+                    Get2DHistogram("hitpattern","TistarAnalysis")->Fill(index_first, index_second);
+                    Get2DHistogram("originXY","TistarAnalysis")->Fill(vertex.X(), vertex.Y());
+                    Get2DHistogram("originXYErr","TistarAnalysis")->Fill(vertex.X() - fTISTARGenReactionX, vertex.Y() - fTISTARGenReactionY);
+                    Get2DHistogram("errorOrigin","TistarAnalysis")->Fill(vertex.Z(),  vertex.Z() - fTISTARGenReactionZ );
+                    Get2DHistogram("errorThetaPhi","TistarAnalysis")->Fill(recoilThetaRec - recoilThetaSim, recoilPhiRec - recoilPhiSim);
+                    Get2DHistogram("dE12VsPad","TistarAnalysis")->Fill(recoilEnergyRecErest, recoilEnergyRecdE );
+                    Get2DHistogram("dE12VsE","TistarAnalysis")->Fill(recoilEnergyRec, recoilEnergyRecdE );
+                    Get2DHistogram("dE1VsE","TistarAnalysis")->Fill(recoilEnergyRec, hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()-1));//(firstDeltaE[index_first]->at(0)).GetRear() );
+                    Get2DHistogram("dE2VsE","TistarAnalysis")->Fill(recoilEnergyRec, hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1));//(secondDeltaE[index_second]->at(0)).GetRear() );
+                    Get2DHistogram("dE1VsdE2","TistarAnalysis")->Fill(hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()-1), hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1));//(firstDeltaE[index_first]->at(0)).GetRear() );
+                    Get2DHistogram("eVsTheta","TistarAnalysis")->Fill(recoilThetaRec, recoilEnergyRec);
+                    Get2DHistogram("eVsZ","TistarAnalysis")->Fill(vertex.Z(), recoilEnergyRec);
+                
+                    if(recoilThetaRec > 45. && recoilThetaRec < 55.) 
+                        Get2DHistogram("dE1VsE_theta_45_55","TistarAnalysis")->Fill(recoilEnergyRec, hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()-1));//(firstDeltaE[index_first]->at(0)).GetRear() );
+                    if(recoilThetaRec > 115. && recoilThetaRec < 125.) 
+                        Get2DHistogram("dE1VsE_theta_115_125","TistarAnalysis")->Fill(recoilEnergyRec, hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()-1));//(firstDeltaE[index_first]->at(0)).GetRear() );
+
+                    Get2DHistogram("eRecErrVsESim","TistarAnalysis")->Fill(fTISTARGenRecoilEnergy, recoilEnergyRec - fTISTARGenRecoilEnergy);
+                    Get2DHistogram("thetaErrorVsZ","TistarAnalysis")->Fill(vertex.Z(), recoilThetaRec - recoilThetaSim);
+                    //if(hit->GetPadEnergy()>1.00) thetaErrorVsTheta->Fill(recoilThetaSim , recoilThetaRec - recoilThetaSim);
+                    Get2DHistogram("thetaErrorVsTheta","TistarAnalysis")->Fill(recoilThetaSim , recoilThetaRec - recoilThetaSim); // why twice?
+                    Get2DHistogram("thetaErrorVsTheta","TistarAnalysis")->Fill(recoilThetaSim , recoilThetaRec - recoilThetaSim);
+                    if(recoilEnergyRecErest > 0.)  Get2DHistogram("thetaErrorVsThetaEpadCut","TistarAnalysis")->Fill(recoilThetaSim , recoilThetaRec - recoilThetaSim);
+                    if(fTISTARGenReactionBeamEnergyCM > 0.0) Get2DHistogram("zReactionEnergy","TistarAnalysis")->Fill(vertex.Z(), beamEnergyRec);
+                    //if(reactionEnergyBeamCM == -1.0) std::cout<<"leila!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! "<<reactionEnergyBeamCM<<std::endl;
+                    Get1DHistogram("excEnProton","TistarAnalysis")->Fill(excEnergy);
+                    //if(recoilEnergyRecErest>1.00) excEnProtonVsTheta->Fill(recoilThetaRec, excEnergy); ???????????????????????????
+                    Get2DHistogram("excEnProtonVsTheta","TistarAnalysis")->Fill(recoilThetaRec, excEnergy);
+                    Get2DHistogram("excEnProtonVsPhi","TistarAnalysis")->Fill(recoilPhiRec, excEnergy);
+                    Get2DHistogram("excEnProtonVsThetaCm","TistarAnalysis")->Fill(recoilThetaCmRec, excEnergy);
+                    Get2DHistogram("excEnProtonVsZ","TistarAnalysis")->Fill(vertex.Z(), excEnergy);
+                    if(fTISTARGenReaction == 0) {
+                        Get2DHistogram("excEnProtonVsThetaGS","TistarAnalysis")->Fill(recoilThetaRec, excEnergy);
+                        Get2DHistogram("excEnProtonVsZGS","TistarAnalysis")->Fill(vertex.Z(), excEnergy);
                     }
-                    //recoilEnergyRecEloss = recoilFoilEnergy->Eval(range + foilThicknessMgCm2/(sinTheta*cosPhi));// original 
-                    recoilEnergyRecEloss = recoilFoilEnergy->Eval(range + foilThicknessMgCm2/(sinTheta));// changed by Leila
-
-                    if(fSettings->VerbosityLevel()>1) {
-                        std::cout<<"9. energy loss from the foil "<<recoilEnergyRecEloss<<std::endl;
-                        std::cout<<"\n recoilEnergyRec: "<<recoilEnergyRec<<", range: "<<range<<" + foilThicknessMgCm2/(sinTheta*cosPhi) "
-                                 <<foilThicknessMgCm2/(sinTheta)<<" => recoilEnergyRecEloss: "<<recoilEnergyRecEloss<<std::endl;
+                    Get2DHistogram("thetaVsZ","TistarAnalysis")->Fill(vertex.Z(), recoilThetaRec);
+                    if(index_first == index_second) {
+                        Get2DHistogram("eVsZSame","TistarAnalysis")->Fill(vertex.Z(), recoilEnergyRec);
+                        Get2DHistogram("thetaVsZSame","TistarAnalysis")->Fill(vertex.Z(), recoilThetaRec);
+                    } else {
+                        Get2DHistogram("eVsZCross","TistarAnalysis")->Fill(vertex.Z(), recoilEnergyRec);
+                        Get2DHistogram("thetaVsZCross","TistarAnalysis")->Fill(vertex.Z(), recoilThetaRec);
                     }
-            
-                    //*** energy loss through the target ***
-                    // for now assume that the "box" inside the foil is filled with target gas. Not box any more. It is a cylinder --> phi is ommitted!
-                    if(fSettings->VerbosityLevel()>1) {
-                        std::cout<<"\n\n *** energy loss through the target *** "<<std::endl;
-                        std::cout<<" at "<<recoilEnergyRecEloss<<" through "<<targetWidthMgCm2/(sinTheta*cosPhi)<<" mm gas \n";
-                    }
-                    range = recoilTargetRange->Eval(recoilEnergyRecEloss);
+                    Get2DHistogram("phiVsZ","TistarAnalysis")->Fill(vertex.Z(), recoilPhiRec);
+                    Get2DHistogram("phiErrorVsPhi","TistarAnalysis")->Fill(recoilPhiRec, recoilPhiRec - recoilPhiSim);
+                    if(fTISTARFirstDeltaE[index_first]->at(0).GetID() == 0) {
 
-                    if(fSettings->VerbosityLevel()>1) {
-                        std::cout<<"10. range from the target "<<range<<std::endl;
                     }
-                    //recoilEnergyRecEloss = recoilTargetEnergy->Eval(range + targetWidthMgCm2/(sinTheta*cosPhi));// original
-                    recoilEnergyRecEloss = recoilTargetEnergy->Eval(range + targetWidthMgCm2/(sinTheta));// changed by Leila
-
-                    if(fSettings->VerbosityLevel()>1) {
-                        std::cout<<"11. energy loss from the target "<<recoilEnergyRecEloss<<std::endl;
-                        std::cout<<" => "<<recoilEnergyRecEloss<<std::endl;
+                    Get2DHistogram("betaCmVsZ","TistarAnalysis")->Fill(vertex.Z(), transferP->GetBetacm());
+                    Get2DHistogram("eCmVsZ","TistarAnalysis")->Fill(vertex.Z(), transferP->GetCmEnergy()/1000.);
+                    if(silicon_mult_second == 1) Get2DHistogram("stripPattern","TistarAnalysis")->Fill(index_second*fSettings->GetTISTARnStripsY(0) + fTISTARSecondDeltaE[index_second]->at(0).GetStripNr()[0], fTISTARSecondDeltaE[index_second]->at(0).GetID()*fSettings->GetTISTARnStripsZ(0) + fTISTARSecondDeltaE[index_second]->at(0).GetRingNr()[0]);
+                    Get2DHistogram("recBeamEnergyErrVsZ","TistarAnalysis")->Fill(vertex.Z(), beamEnergyRec - fTISTARGenReactionBeamEnergy);
+                    Get2DHistogram("thetaCmVsThetaLab","TistarAnalysis")->Fill(recoilThetaRec, recoilThetaCmRec);
+                    Get2DHistogram("zErrorVsthetaError","TistarAnalysis")->Fill(recoilThetaRec - recoilThetaSim, vertex.Z() - fTISTARGenReactionZ);
+                    Get2DHistogram("elossVsTheta","TistarAnalysis")->Fill(recoilThetaRec, recoilEnergyRecEloss - recoilEnergyRec);
+                    Get2DHistogram("elossVsPhi","TistarAnalysis")->Fill(recoilPhiRec, recoilEnergyRecEloss - recoilEnergyRec);
+
+                    Get2DHistogram("dE2VsdE2Pad","TistarAnalysis")->Fill(hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel())+hit->GetPadEnergy(),hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()));
+                    Get2DHistogram("EPadVsThetaLab","TistarAnalysis")->Fill(recoilThetaRec,hit->GetPadEnergy());
+                    Get2DHistogram("EPadVsZ","TistarAnalysis")->Fill(vertex.Z(),hit->GetPadEnergy());
+                    if(recoilEnergyRecErest == 0.) {Get2DHistogram("dE2VsThetaLabEpadCut","TistarAnalysis")->Fill(recoilThetaRec,hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1));}
+                    if(recoilThetaRec>0.0 && recoilThetaRec<180.0) {Get2DHistogram("dE2VsEPadThetaCut","TistarAnalysis")->Fill(hit->GetPadEnergy(),hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1));}
+                    Get2DHistogram("dE1VsThetaLab","TistarAnalysis")->Fill(recoilThetaRec,hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()-1));
+                    Get2DHistogram("dE2VsThetaLab","TistarAnalysis")->Fill(recoilThetaRec,hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1));
+                    Get2DHistogram("dE12VsThetaLab","TistarAnalysis")->Fill(recoilThetaRec,hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()-1)+hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1));
+                    Get2DHistogram("dE1EpadVsThetaLab","TistarAnalysis")->Fill(recoilThetaRec,hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()-1)+hit->GetPadEnergy());
+                    Get2DHistogram("dE2EpadVsThetaLab","TistarAnalysis")->Fill(recoilThetaRec,hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1)+hit->GetPadEnergy());
+
+                    // ************************* Q-value using the reconstructed energy loss **************************8
+
+                    // now we reconstruct the q-value using the reconstructed energy loss
+                    // position has already been set above
+                    part.SetRecEnergy(recoilEnergyRecEloss);
+                    part.SetType(2); //proton; this is for one-neutron transfer, only; this sets the mass of the particle
+                    part.SetReconstructed(); // set TLorentzVector using mass, rec. energy, and position 
+                    transferP->Final(recoilThetaRec/180.*TMath::Pi(), 2, true);
+                    transferP->SetAngles(recoilThetaRec/180.*TMath::Pi(), 2, true);
+                    excEnergy = transferP->GetExcEnergy(part.GetReconstructed(), fSettings->VerbosityLevel()-1);
+                    if(fSettings->SkimExcitationEnergyLow() <= excEnergy && excEnergy <= fSettings->SkimExcitationEnergyHigh()) {
+                        skimEvent = true;
                     }
 
-
-                } // end gas target
-                if(fSettings->VerbosityLevel()>1) {
-                    std::cout<<"\n theta "<<recoilThetaRec<<", phi "<<recoilPhiRec<<" (sinTheta "<<sinTheta<<", tmpPhi "<<tmpPhi<<", cosPhi "<<cosPhi<<"): "
-                             <<foilThicknessMgCm2/(sinTheta)<<" mg/cm^2, "<<recoilEnergyRec<<" => "<<recoilEnergyRecEloss<<", diff "<<recoilEnergyRecEloss-recoilEnergyRec<<std::endl;
-                }
-
-                // position has already been set above
-                part.SetRecEnergy(recoilEnergyRec);
-                part.SetType(2); //proton; this is for one-neutron transfer, only; this sets the mass of the particle
-                part.SetReconstructed(); // set TLorentzVector using mass, rec. energy, and position 
-
-                //////////////////////////
-                // Q-value reconstruction
-                //////////////////////////
-
-                transferP->SetEBeam(beamEnergyRec);
-                transferP->Final(recoilThetaRec/180.*TMath::Pi(), 2, true);
-                transferP->SetAngles(recoilThetaRec/180.*TMath::Pi(), 2, true);
-                double excEnergy = transferP->GetExcEnergy(part.GetReconstructed(), fSettings->VerbosityLevel()-1);
-
-                double recoilThetaCmRec = transferP->GetThetacm(3)/TMath::Pi()*180.;
-                if(fSettings->VerbosityLevel()>1) {
-                    std::cout<<"\n beamEnergyRec "<<beamEnergyRec<<" => eex = "<<excEnergy<<" (middle spline at "<<recoilThetaRec<<" = "<<middle->Eval(recoilThetaRec)<<", recoilEnergyRec = "<<recoilEnergyRec<<")"<<std::endl;
-                    std::cout<<"recoilThetaCmRec = "<<recoilThetaCmRec<<", "<<transferP->GetThetacm(3)<<", "<<transferP->GetThetacm(2)<<", "<<transferP->GetThetacm(1)<<", "<<transferP->GetThetacm(0)<<std::endl;
-
-                    if(excEnergy>5000) std::cout<<"!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!1********************************1 excEnergy: "<<excEnergy<<" 1. layer E "<< hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()>1)<<" 2. layer E "<< hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()>1)<<" Epad: "<<recoilEnergyRecErest<<" Epad from hit: "<<hit->GetPadEnergy()<<std::endl;
-                }
-
-                ///////////////////////
-                // Fill some histograms
-                ///////////////////////
-
-                Get1DHistogram("reaction","TistarAnalysis")->Fill(fTISTARGenReaction);
-                Get2DHistogram("hitpattern","TistarAnalysis")->Fill(index_first, index_second);
-                Get2DHistogram("originXY","TistarAnalysis")->Fill(vertex.X(), vertex.Y());
-                Get2DHistogram("originXYErr","TistarAnalysis")->Fill(vertex.X() - fTISTARGenReactionX, vertex.Y() - fTISTARGenReactionY);
-                Get2DHistogram("errorOrigin","TistarAnalysis")->Fill(vertex.Z(),  vertex.Z() - fTISTARGenReactionZ );
-                Get2DHistogram("errorThetaPhi","TistarAnalysis")->Fill(recoilThetaRec - recoilThetaSim, recoilPhiRec - recoilPhiSim);
-                Get2DHistogram("dE12VsPad","TistarAnalysis")->Fill(recoilEnergyRecErest, recoilEnergyRecdE );
-                Get2DHistogram("dE12VsE","TistarAnalysis")->Fill(recoilEnergyRec, recoilEnergyRecdE );
-                Get2DHistogram("dE1VsE","TistarAnalysis")->Fill(recoilEnergyRec, hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()-1));//(firstDeltaE[index_first]->at(0)).GetRear() );
-                Get2DHistogram("dE2VsE","TistarAnalysis")->Fill(recoilEnergyRec, hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1));//(secondDeltaE[index_second]->at(0)).GetRear() );
-                Get2DHistogram("dE1VsdE2","TistarAnalysis")->Fill(hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()-1), hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1));//(firstDeltaE[index_first]->at(0)).GetRear() );
-                Get2DHistogram("eVsTheta","TistarAnalysis")->Fill(recoilThetaRec, recoilEnergyRec);
-                Get2DHistogram("eVsZ","TistarAnalysis")->Fill(vertex.Z(), recoilEnergyRec);
-                
-                if(recoilThetaRec > 45. && recoilThetaRec < 55.) 
-                    Get2DHistogram("dE1VsE_theta_45_55","TistarAnalysis")->Fill(recoilEnergyRec, hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()-1));//(firstDeltaE[index_first]->at(0)).GetRear() );
-                if(recoilThetaRec > 115. && recoilThetaRec < 125.) 
-                    Get2DHistogram("dE1VsE_theta_115_125","TistarAnalysis")->Fill(recoilEnergyRec, hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()-1));//(firstDeltaE[index_first]->at(0)).GetRear() );
-
-                Get2DHistogram("eRecErrVsESim","TistarAnalysis")->Fill(fTISTARGenRecoilEnergy, recoilEnergyRec - fTISTARGenRecoilEnergy);
-                Get2DHistogram("thetaErrorVsZ","TistarAnalysis")->Fill(vertex.Z(), recoilThetaRec - recoilThetaSim);
-                //if(hit->GetPadEnergy()>1.00) thetaErrorVsTheta->Fill(recoilThetaSim , recoilThetaRec - recoilThetaSim);
-                Get2DHistogram("thetaErrorVsTheta","TistarAnalysis")->Fill(recoilThetaSim , recoilThetaRec - recoilThetaSim); // why twice?
-                Get2DHistogram("thetaErrorVsTheta","TistarAnalysis")->Fill(recoilThetaSim , recoilThetaRec - recoilThetaSim);
-                if(recoilEnergyRecErest > 0.)  Get2DHistogram("thetaErrorVsThetaEpadCut","TistarAnalysis")->Fill(recoilThetaSim , recoilThetaRec - recoilThetaSim);
-                if(fTISTARGenReactionBeamEnergyCM > 0.0) Get2DHistogram("zReactionEnergy","TistarAnalysis")->Fill(vertex.Z(), beamEnergyRec);
-                //if(reactionEnergyBeamCM == -1.0) std::cout<<"leila!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!! "<<reactionEnergyBeamCM<<std::endl;
-                Get1DHistogram("excEnProton","TistarAnalysis")->Fill(excEnergy);
-                //if(recoilEnergyRecErest>1.00) excEnProtonVsTheta->Fill(recoilThetaRec, excEnergy); ???????????????????????????
-                Get2DHistogram("excEnProtonVsTheta","TistarAnalysis")->Fill(recoilThetaRec, excEnergy);
-                Get2DHistogram("excEnProtonVsPhi","TistarAnalysis")->Fill(recoilPhiRec, excEnergy);
-                Get2DHistogram("excEnProtonVsThetaCm","TistarAnalysis")->Fill(recoilThetaCmRec, excEnergy);
-                Get2DHistogram("excEnProtonVsZ","TistarAnalysis")->Fill(vertex.Z(), excEnergy);
-                if(fTISTARGenReaction == 0) {
-                    Get2DHistogram("excEnProtonVsThetaGS","TistarAnalysis")->Fill(recoilThetaRec, excEnergy);
-                    Get2DHistogram("excEnProtonVsZGS","TistarAnalysis")->Fill(vertex.Z(), excEnergy);
-                }
-                Get2DHistogram("thetaVsZ","TistarAnalysis")->Fill(vertex.Z(), recoilThetaRec);
-                if(index_first == index_second) {
-                    Get2DHistogram("eVsZSame","TistarAnalysis")->Fill(vertex.Z(), recoilEnergyRec);
-                    Get2DHistogram("thetaVsZSame","TistarAnalysis")->Fill(vertex.Z(), recoilThetaRec);
-                } else {
-                    Get2DHistogram("eVsZCross","TistarAnalysis")->Fill(vertex.Z(), recoilEnergyRec);
-                    Get2DHistogram("thetaVsZCross","TistarAnalysis")->Fill(vertex.Z(), recoilThetaRec);
-                }
-                Get2DHistogram("phiVsZ","TistarAnalysis")->Fill(vertex.Z(), recoilPhiRec);
-                Get2DHistogram("phiErrorVsPhi","TistarAnalysis")->Fill(recoilPhiRec, recoilPhiRec - recoilPhiSim);
-                if(fTISTARFirstDeltaE[index_first]->at(0).GetID() == 0) {
-
-                }
-                Get2DHistogram("betaCmVsZ","TistarAnalysis")->Fill(vertex.Z(), transferP->GetBetacm());
-                Get2DHistogram("eCmVsZ","TistarAnalysis")->Fill(vertex.Z(), transferP->GetCmEnergy()/1000.);
-                if(silicon_mult_second == 1) Get2DHistogram("stripPattern","TistarAnalysis")->Fill(index_second*fSettings->GetTISTARnStripsY(0) + fTISTARSecondDeltaE[index_second]->at(0).GetStripNr()[0], fTISTARSecondDeltaE[index_second]->at(0).GetID()*fSettings->GetTISTARnStripsZ(0) + fTISTARSecondDeltaE[index_second]->at(0).GetRingNr()[0]);
-                Get2DHistogram("recBeamEnergyErrVsZ","TistarAnalysis")->Fill(vertex.Z(), beamEnergyRec - fTISTARGenReactionBeamEnergy);
-                Get2DHistogram("thetaCmVsThetaLab","TistarAnalysis")->Fill(recoilThetaRec, recoilThetaCmRec);
-                Get2DHistogram("zErrorVsthetaError","TistarAnalysis")->Fill(recoilThetaRec - recoilThetaSim, vertex.Z() - fTISTARGenReactionZ);
-                Get2DHistogram("elossVsTheta","TistarAnalysis")->Fill(recoilThetaRec, recoilEnergyRecEloss - recoilEnergyRec);
-                Get2DHistogram("elossVsPhi","TistarAnalysis")->Fill(recoilPhiRec, recoilEnergyRecEloss - recoilEnergyRec);
-
-                Get2DHistogram("dE2VsdE2Pad","TistarAnalysis")->Fill(hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel())+hit->GetPadEnergy(),hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()));
-                Get2DHistogram("EPadVsThetaLab","TistarAnalysis")->Fill(recoilThetaRec,hit->GetPadEnergy());
-                Get2DHistogram("EPadVsZ","TistarAnalysis")->Fill(vertex.Z(),hit->GetPadEnergy());
-                if(recoilEnergyRecErest == 0.) {Get2DHistogram("dE2VsThetaLabEpadCut","TistarAnalysis")->Fill(recoilThetaRec,hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1));}
-                if(recoilThetaRec>0.0 && recoilThetaRec<180.0) {Get2DHistogram("dE2VsEPadThetaCut","TistarAnalysis")->Fill(hit->GetPadEnergy(),hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1));}
-                Get2DHistogram("dE1VsThetaLab","TistarAnalysis")->Fill(recoilThetaRec,hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()-1));
-                Get2DHistogram("dE2VsThetaLab","TistarAnalysis")->Fill(recoilThetaRec,hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1));
-                Get2DHistogram("dE12VsThetaLab","TistarAnalysis")->Fill(recoilThetaRec,hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()-1)+hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1));
-                Get2DHistogram("dE1EpadVsThetaLab","TistarAnalysis")->Fill(recoilThetaRec,hit->GetFirstDeltaEEnergy(fSettings->VerbosityLevel()-1)+hit->GetPadEnergy());
-                Get2DHistogram("dE2EpadVsThetaLab","TistarAnalysis")->Fill(recoilThetaRec,hit->GetSecondDeltaEEnergy(fSettings->VerbosityLevel()-1)+hit->GetPadEnergy());
-
-                // ************************* Q-value using the reconstructed energy loss **************************8
-
-                // now we reconstruct the q-value using the reconstructed energy loss
-                // position has already been set above
-                part.SetRecEnergy(recoilEnergyRecEloss);
-                part.SetType(2); //proton; this is for one-neutron transfer, only; this sets the mass of the particle
-                part.SetReconstructed(); // set TLorentzVector using mass, rec. energy, and position 
-                transferP->Final(recoilThetaRec/180.*TMath::Pi(), 2, true);
-                transferP->SetAngles(recoilThetaRec/180.*TMath::Pi(), 2, true);
-                excEnergy = transferP->GetExcEnergy(part.GetReconstructed(), fSettings->VerbosityLevel()-1);
-
-                recoilThetaCmRec = transferP->GetThetacm(3)/TMath::Pi()*180.;
+                    recoilThetaCmRec = transferP->GetThetacm(3)/TMath::Pi()*180.;
 
 
         
-                Get2DHistogram("hEbeamRecVsSim","TistarAnalysis")->Fill(beamEnergyRec,beamEnergy);
-
-                Get2DHistogram("excEnElossVsTheta","TistarAnalysis")->Fill(recoilThetaRec, excEnergy);
-                if(recoilEnergyRecErest > 0. ) {Get2DHistogram("excEnElossVsThetaEpadCut","TistarAnalysis")->Fill(recoilThetaRec, excEnergy);}
-                Get1DHistogram("excEnProtonCorr","TistarAnalysis")->Fill(excEnergy);
-                if(recoilEnergyRecErest > 0. ) {Get1DHistogram("excEnProtonCorrEpadCut","TistarAnalysis")->Fill(excEnergy);}
-                Get2DHistogram("excEnProtonCorrVsX","TistarAnalysis")->Fill(vertex.X(),excEnergy);
-                Get2DHistogram("excEnProtonCorrVsY","TistarAnalysis")->Fill(vertex.Y(),excEnergy);
-                Get2DHistogram("excEnProtonCorrVsZ","TistarAnalysis")->Fill(vertex.Z(),excEnergy);
-                Get2DHistogram("excEnProtonCorrVsT","TistarAnalysis")->Fill(sqrt(vertex.X()*vertex.X()+vertex.Y()*vertex.Y()),excEnergy);
-                Get2DHistogram("excEnProtonCorrVsR","TistarAnalysis")->Fill(sqrt(vertex.X()*vertex.X()+vertex.Y()*vertex.Y()+vertex.Z()*vertex.Z()),excEnergy);
-                if(dE1MeasMinRec<20.0 && dE2MeasMinRec<40.0) Get1DHistogram("excEnProtonCorrdE1Sigma1","TistarAnalysis")->Fill(excEnergy);
-                if(dE1MeasMinRec<40.0 && dE2MeasMinRec<80.0) Get1DHistogram("excEnProtonCorrdE1Sigma2","TistarAnalysis")->Fill(excEnergy);
-
-                //if(0 <= fTISTARGenReaction && fTISTARGenReaction < nofLevels) Get2DHistogram(Form("excEnElossVsThetaLevel_%d",fTISTARGenReaction),"TistarAnalysis")->Fill(recoilThetaRec, excEnergy);
-                //if(0 <= reactionSim && reactionSim < nofLevels-1) excEnProtonVsTheta->Fill(recoilThetaRec, excEnergy);//leila 
-
-                // gamma stuff 
-                size_t gammaSize = fTISTARGenGammaEnergy->size();
-                // perfect doppler correction
-                double gamma = (ejectile->GetMass()+fTISTARGenEjectileEnergy/1000.)/ejectile->GetMass();
-                double beta = TMath::Sqrt(1.-TMath::Power(1./gamma, 2.));
-                double eGammaDoppCorr, eGammaDoppCorrSim, resolvedEnergy;
-                for(size_t i=0; i<gammaSize; i++) {
-                    Get1DHistogram("gammaSpec","TistarAnalysis")->Fill(fTISTARGenGammaEnergy->at(i));
-                    Get2DHistogram("excEnProtonVsGamma","TistarAnalysis")->Fill(fTISTARGenGammaEnergy->at(i),excEnergy);
+                    Get2DHistogram("hEbeamRecVsSim","TistarAnalysis")->Fill(beamEnergyRec,beamEnergy);
+
+                    Get2DHistogram("excEnElossVsTheta","TistarAnalysis")->Fill(recoilThetaRec, excEnergy);
+                    if(recoilEnergyRecErest > 0. ) {Get2DHistogram("excEnElossVsThetaEpadCut","TistarAnalysis")->Fill(recoilThetaRec, excEnergy);}
+                    Get1DHistogram("excEnProtonCorr","TistarAnalysis")->Fill(excEnergy);
+                    if(recoilEnergyRecErest > 0. ) {Get1DHistogram("excEnProtonCorrEpadCut","TistarAnalysis")->Fill(excEnergy);}
+                    Get2DHistogram("excEnProtonCorrVsX","TistarAnalysis")->Fill(vertex.X(),excEnergy);
+                    Get2DHistogram("excEnProtonCorrVsY","TistarAnalysis")->Fill(vertex.Y(),excEnergy);
+                    Get2DHistogram("excEnProtonCorrVsZ","TistarAnalysis")->Fill(vertex.Z(),excEnergy);
+                    Get2DHistogram("excEnProtonCorrVsT","TistarAnalysis")->Fill(sqrt(vertex.X()*vertex.X()+vertex.Y()*vertex.Y()),excEnergy);
+                    Get2DHistogram("excEnProtonCorrVsR","TistarAnalysis")->Fill(sqrt(vertex.X()*vertex.X()+vertex.Y()*vertex.Y()+vertex.Z()*vertex.Z()),excEnergy);
+                    if(dE1MeasMinRec<20.0 && dE2MeasMinRec<40.0) Get1DHistogram("excEnProtonCorrdE1Sigma1","TistarAnalysis")->Fill(excEnergy);
+                    if(dE1MeasMinRec<40.0 && dE2MeasMinRec<80.0) Get1DHistogram("excEnProtonCorrdE1Sigma2","TistarAnalysis")->Fill(excEnergy);
+
+                    //if(0 <= fTISTARGenReaction && fTISTARGenReaction < nofLevels) Get2DHistogram(Form("excEnElossVsThetaLevel_%d",fTISTARGenReaction),"TistarAnalysis")->Fill(recoilThetaRec, excEnergy);
+                    //if(0 <= reactionSim && reactionSim < nofLevels-1) excEnProtonVsTheta->Fill(recoilThetaRec, excEnergy);//leila 
+
+                    // gamma stuff 
+                    size_t gammaSize = fTISTARGenGammaEnergy->size();
+                    // perfect doppler correction
+                    double gamma = (ejectile->GetMass()+fTISTARGenEjectileEnergy/1000.)/ejectile->GetMass();
+                    double beta = TMath::Sqrt(1.-TMath::Power(1./gamma, 2.));
+                    double eGammaDoppCorr, eGammaDoppCorrSim, resolvedEnergy;
+                    for(size_t i=0; i<gammaSize; i++) {
+                        Get1DHistogram("gammaSpec","TistarAnalysis")->Fill(fTISTARGenGammaEnergy->at(i));
+                        Get2DHistogram("excEnProtonVsGamma","TistarAnalysis")->Fill(fTISTARGenGammaEnergy->at(i),excEnergy);
                     
-                    eGammaDoppCorrSim = (1.-beta*TMath::Cos(fTISTARGenGammaTheta->at(i)))/TMath::Sqrt(1.-beta*beta)*fTISTARGenGammaEnergy->at(i); 
-                    Get1DHistogram("gammaSpecDoppCorr","TistarAnalysis")->Fill(eGammaDoppCorrSim);
-                    Get2DHistogram("excEnProtonVsGammaDoppCorr","TistarAnalysis")->Fill(eGammaDoppCorrSim, excEnergy);
+                        eGammaDoppCorrSim = (1.-beta*TMath::Cos(fTISTARGenGammaTheta->at(i)))/TMath::Sqrt(1.-beta*beta)*fTISTARGenGammaEnergy->at(i); 
+                        Get1DHistogram("gammaSpecDoppCorr","TistarAnalysis")->Fill(eGammaDoppCorrSim);
+                        Get2DHistogram("excEnProtonVsGammaDoppCorr","TistarAnalysis")->Fill(eGammaDoppCorrSim, excEnergy);
 
-                    resolvedEnergy = rndm.Gaus(eGammaDoppCorrSim,eGammaDoppCorrSim*0.01/(2.*TMath::Sqrt(2.*TMath::Log(2.))));
-                    Get1DHistogram("gammaSpecDoppCorrRes","TistarAnalysis")->Fill(resolvedEnergy);
-                    Get2DHistogram("excEnProtonVsGammaDoppCorrRes","TistarAnalysis")->Fill(resolvedEnergy, excEnergy);
+                        resolvedEnergy = rndm.Gaus(eGammaDoppCorrSim,eGammaDoppCorrSim*0.01/(2.*TMath::Sqrt(2.*TMath::Log(2.))));
+                        Get1DHistogram("gammaSpecDoppCorrRes","TistarAnalysis")->Fill(resolvedEnergy);
+                        Get2DHistogram("excEnProtonVsGammaDoppCorrRes","TistarAnalysis")->Fill(resolvedEnergy, excEnergy);
                     
-                    if(fSettings->VerbosityLevel()>1) {
-                        std::cout<<"beta = "<<beta<<", gamma = "<<gamma<<std::endl;
-                        std::cout<<"simulated energy: "<<fTISTARGenGammaEnergy->at(i)<<" keV, perfect doppler-corrected energy: "<<eGammaDoppCorrSim<<" keV"<<std::endl;
+                        if(fSettings->VerbosityLevel()>1) {
+                            std::cout<<"beta = "<<beta<<", gamma = "<<gamma<<std::endl;
+                            std::cout<<"simulated energy: "<<fTISTARGenGammaEnergy->at(i)<<" keV, perfect doppler-corrected energy: "<<eGammaDoppCorrSim<<" keV"<<std::endl;
+                        }
                     }
-                }
                 
-                // tigress doppler correction
-                AddbackGriffin();
-                gamma = (ejectile->GetMass()+beamEnergyRec)/ejectile->GetMass();
-                beta = TMath::Sqrt(1.-TMath::Power(1./gamma, 2.));
-                for(int i=0; i<fGriffinCrystal->size(); i++) { 
-                    Get1DHistogram("tigressCryGammaSpec","TistarAnalysis")->Fill(fGriffinCrystal->at(i).Energy());
-                    Get2DHistogram("tigressCryExcEnProtonVsGamma","TistarAnalysis")->Fill(fGriffinCrystal->at(i).Energy(),excEnergy);
-
-                    double rho_t = 0.;
-                    double z_t = vertex.Z();
-                    double rho_d = TMath::Sin(TMath::Pi()/180.*GriffinDetCoords[fGriffinCrystal->at(i).DetectorId()][0])*fSettings->GriffinAddbackVectorCrystalFaceDistancemm();
-                    double z_d = TMath::Cos(TMath::Pi()/180.*GriffinDetCoords[fGriffinCrystal->at(i).DetectorId()][0])*fSettings->GriffinAddbackVectorCrystalFaceDistancemm();
-                    double angle = TMath::ATan((rho_d-rho_t)/(z_d-z_t));
-                    while(angle<0.) angle += 2.*TMath::Pi();
-                    if(angle>TMath::Pi()) angle -= TMath::Pi();
-                    eGammaDoppCorr = (1.-beta*TMath::Cos(angle))/TMath::Sqrt(1.-beta*beta)*fGriffinCrystal->at(i).Energy(); 
-                    Get1DHistogram("tigressCryGammaSpecDoppCorr","TistarAnalysis")->Fill(eGammaDoppCorr);
-                    Get2DHistogram("tigressCryExcEnProtonVsGammaDoppCorr","TistarAnalysis")->Fill(eGammaDoppCorr, excEnergy);
-                }
-                for(int i=0; i<fGriffinDetector->size(); i++) { 
-                    Get1DHistogram("tigressDetGammaSpec","TistarAnalysis")->Fill(fGriffinDetector->at(i).Energy());
-                    Get2DHistogram("tigressDetExcEnProtonVsGamma","TistarAnalysis")->Fill(fGriffinDetector->at(i).Energy(),excEnergy);
-
-                    double rho_t = 0.;
-                    double z_t = vertex.Z();
-                    double rho_d = TMath::Sin(TMath::Pi()/180.*GriffinDetCoords[fGriffinDetector->at(i).DetectorId()][0])*fSettings->GriffinAddbackVectorCrystalFaceDistancemm();
-                    double z_d = TMath::Cos(TMath::Pi()/180.*GriffinDetCoords[fGriffinDetector->at(i).DetectorId()][0])*fSettings->GriffinAddbackVectorCrystalFaceDistancemm();
-                    double angle = TMath::ATan((rho_d-rho_t)/(z_d-z_t));
-                    while(angle<0.) angle += 2.*TMath::Pi();
-                    if(angle>TMath::Pi()) angle -= TMath::Pi();
-                    eGammaDoppCorr = (1.-beta*TMath::Cos(angle))/TMath::Sqrt(1.-beta*beta)*fGriffinDetector->at(i).Energy(); 
-                    if(fSettings->VerbosityLevel()>1) {
-                        std::cout<<"beta = "<<beta<<", gamma = "<<gamma<<std::endl;
-                        std::cout<<"target rho: "<<rho_t<<", z: "<<z_t<<";    det rho: "<<rho_d<<", z: "<<z_d<<std::endl;
-                        std::cout<<"detector angle: "<<TMath::Pi()/180.*GriffinDetCoords[fGriffinDetector->at(i).DetectorId()][0]<<", calculated angle: "<<angle<<", simulated gamma angles are: ";
-                        for(int i=0; i<fTISTARGenGammaEnergy->size(); i++) std::cout<<fTISTARGenGammaTheta->at(i)<<" \t";
-                        std::cout<<std::endl;
-                        std::cout<<"detected energy: "<<fGriffinDetector->at(i).Energy()<<" keV, calculated energy: "<<eGammaDoppCorr<<" keV, simulated energies: ";
-                        for(int i=0; i<fTISTARGenGammaEnergy->size(); i++) std::cout<<fTISTARGenGammaEnergy->at(i)<<" \t";
-                        std::cout<<std::endl;
+                    // tigress doppler correction
+                    AddbackGriffin();
+                    gamma = (ejectile->GetMass()+beamEnergyRec)/ejectile->GetMass();
+                    beta = TMath::Sqrt(1.-TMath::Power(1./gamma, 2.));
+                    for(int i=0; i<fGriffinCrystal->size(); i++) { 
+                        Get1DHistogram("tigressCryGammaSpec","TistarAnalysis")->Fill(fGriffinCrystal->at(i).Energy());
+                        Get2DHistogram("tigressCryExcEnProtonVsGamma","TistarAnalysis")->Fill(fGriffinCrystal->at(i).Energy(),excEnergy);
+
+                        double rho_t = 0.;
+                        double z_t = vertex.Z();
+                        double rho_d = TMath::Sin(TMath::Pi()/180.*GriffinDetCoords[fGriffinCrystal->at(i).DetectorId()][0])*fSettings->GriffinAddbackVectorCrystalFaceDistancemm();
+                        double z_d = TMath::Cos(TMath::Pi()/180.*GriffinDetCoords[fGriffinCrystal->at(i).DetectorId()][0])*fSettings->GriffinAddbackVectorCrystalFaceDistancemm();
+                        double angle = TMath::ATan((rho_d-rho_t)/(z_d-z_t));
+                        while(angle<0.) angle += 2.*TMath::Pi();
+                        if(angle>TMath::Pi()) angle -= TMath::Pi();
+                        eGammaDoppCorr = (1.-beta*TMath::Cos(angle))/TMath::Sqrt(1.-beta*beta)*fGriffinCrystal->at(i).Energy(); 
+                        Get1DHistogram("tigressCryGammaSpecDoppCorr","TistarAnalysis")->Fill(eGammaDoppCorr);
+                        Get2DHistogram("tigressCryExcEnProtonVsGammaDoppCorr","TistarAnalysis")->Fill(eGammaDoppCorr, excEnergy);
                     }
+                    for(int i=0; i<fGriffinDetector->size(); i++) { 
+                        Get1DHistogram("tigressDetGammaSpec","TistarAnalysis")->Fill(fGriffinDetector->at(i).Energy());
+                        Get2DHistogram("tigressDetExcEnProtonVsGamma","TistarAnalysis")->Fill(fGriffinDetector->at(i).Energy(),excEnergy);
+
+                        double rho_t = 0.;
+                        double z_t = vertex.Z();
+                        double rho_d = TMath::Sin(TMath::Pi()/180.*GriffinDetCoords[fGriffinDetector->at(i).DetectorId()][0])*fSettings->GriffinAddbackVectorCrystalFaceDistancemm();
+                        double z_d = TMath::Cos(TMath::Pi()/180.*GriffinDetCoords[fGriffinDetector->at(i).DetectorId()][0])*fSettings->GriffinAddbackVectorCrystalFaceDistancemm();
+                        double angle = TMath::ATan((rho_d-rho_t)/(z_d-z_t));
+                        while(angle<0.) angle += 2.*TMath::Pi();
+                        if(angle>TMath::Pi()) angle -= TMath::Pi();
+                        eGammaDoppCorr = (1.-beta*TMath::Cos(angle))/TMath::Sqrt(1.-beta*beta)*fGriffinDetector->at(i).Energy(); 
+                        if(fSettings->VerbosityLevel()>1) {
+                            std::cout<<"beta = "<<beta<<", gamma = "<<gamma<<std::endl;
+                            std::cout<<"target rho: "<<rho_t<<", z: "<<z_t<<";    det rho: "<<rho_d<<", z: "<<z_d<<std::endl;
+                            std::cout<<"detector angle: "<<TMath::Pi()/180.*GriffinDetCoords[fGriffinDetector->at(i).DetectorId()][0]<<", calculated angle: "<<angle<<", simulated gamma angles are: ";
+                            for(int i=0; i<fTISTARGenGammaEnergy->size(); i++) std::cout<<fTISTARGenGammaTheta->at(i)<<" \t";
+                            std::cout<<std::endl;
+                            std::cout<<"detected energy: "<<fGriffinDetector->at(i).Energy()<<" keV, calculated energy: "<<eGammaDoppCorr<<" keV, simulated energies: ";
+                            for(int i=0; i<fTISTARGenGammaEnergy->size(); i++) std::cout<<fTISTARGenGammaEnergy->at(i)<<" \t";
+                            std::cout<<std::endl;
+                        }
                     
-                    Get1DHistogram("tigressDetGammaSpecDoppCorr","TistarAnalysis")->Fill(eGammaDoppCorr);
-                    Get2DHistogram("tigressDetExcEnProtonVsGammaDoppCorr","TistarAnalysis")->Fill(eGammaDoppCorr, excEnergy);
+                        Get1DHistogram("tigressDetGammaSpecDoppCorr","TistarAnalysis")->Fill(eGammaDoppCorr);
+                        Get2DHistogram("tigressDetExcEnProtonVsGammaDoppCorr","TistarAnalysis")->Fill(eGammaDoppCorr, excEnergy);
+                    }
                 }
                 // CLEAR GRIFFIN //
                 fGriffinDetector->clear();
@@ -1531,57 +2134,17 @@ bool Converter::Run() {
             // If they have the same crystal and detector IDs, then we sum the energies together.
             // Normally the Geant4 simulation would sum energy deposits on the same volume, but if we ran the code in "step mode",
             // or if we merged two ntuples together, this would not be true. This method checks and will do what "hit mode" in Geant4 normally does for us!
-            // This could slow things down, if that's the case we can put a flag in the settings such that these checks are not done everytime.
-            CheckGriffinCrystalAddback();
-            CheckLaBrDetectorAddback();
-            CheckEightPiDetectorAddback();
-            CheckAncillaryBgoCrystalAddback();
-            CheckSceptarDetectorAddback();
-            CheckDescantDetectorAddback();
-            CheckPacesDetectorAddback();
-
-
-            for(int j = 0; j < 16; j++) {
-                GriffinNeighbours_counted[j] = 0;
-            }
-
-            // number of descant hits
-            descantBlueHits = fDescantBlueDetector->size();
-            descantGreenHits = fDescantGreenDetector->size();
-            descantRedHits = fDescantRedDetector->size();
-            descantWhiteHits = fDescantWhiteDetector->size();
-            descantYellowHits = fDescantYellowDetector->size();
-            descantArrayHits = descantBlueHits + descantGreenHits + descantRedHits + descantWhiteHits + descantYellowHits;
-
-            // number of Testcan hits
-            testcanHits = fTestcanDetector->size();
-
-            //---------------------------------------------------------------------
-            // Unsuppressed GRIFFIN
-            //---------------------------------------------------------------------
-            AddbackGriffin();
-            if(fSettings->WriteGriffinAddbackVector())
-                AddbackGriffinNeighbourVector();
+            // Only systems that had hits in this event are checked, the merge rule of each system is set when it is registered.
+            if(!fOverlayEvents.empty()) {
+                OverlayEvents(eventNumber);
+            }
+            MergeActiveSystems();
 
             //statistics histograms
             hist1D = Get1DHistogram("GriffinCrystalMultiplicityUnsup","Statistics");
             hist1D->Fill(fGriffinCrystal->size());
             hist1D = Get1DHistogram("GriffinBgoMultiplicityUnsup","Statistics");
             hist1D->Fill(fGriffinBgo->size());
-            hist1D = Get1DHistogram("GriffinDetectorMultiplicityUnsup","Statistics");
-            hist1D->Fill(fGriffinDetector->size());
-            hist1D = Get1DHistogram("GriffinCrystalHitPattern","Statistics");
-            for(size_t firstDet = 0; firstDet < fGriffinCrystal->size(); ++firstDet) {
-                hist1D->Fill((4*fGriffinCrystal->at(firstDet).DetectorId())+fGriffinCrystal->at(firstDet).CrystalId());
-            }
-            hist1D = Get1DHistogram("GriffinDetectorHitPattern","Statistics");
-            for(size_t firstDet = 0; firstDet < fGriffinDetector->size(); ++firstDet) {
-                hist1D->Fill((fGriffinDetector->at(firstDet).DetectorId()));
-            }
-            hist1D = Get1DHistogram("SceptarDetectorHitPattern","Statistics");
-            for(size_t firstDet = 0; firstDet < fSceptarDetector->size(); ++firstDet) {
-                hist1D->Fill((fSceptarDetector->at(firstDet).DetectorId()));
-            }
             hist1D = Get1DHistogram("DescantArrayMultiplicity","Statistics");
             hist1D->Fill(fDescantBlueDetector->size()+fDescantGreenDetector->size()+fDescantRedDetector->size()+fDescantWhiteDetector->size()+fDescantYellowDetector->size());
             hist1D = Get1DHistogram("DescantBlueMultiplicity","Statistics");
@@ -1594,26 +2157,6 @@ bool Converter::Run() {
             hist1D->Fill(fDescantWhiteDetector->size());
             hist1D = Get1DHistogram("DescantYellowMultiplicity","Statistics");
             hist1D->Fill(fDescantYellowDetector->size());
-            hist1D = Get1DHistogram("DescantBlueHitPattern","Statistics");
-            for(size_t firstDet = 0; firstDet < fDescantBlueDetector->size(); ++firstDet) {
-                hist1D->Fill((fDescantBlueDetector->at(firstDet).DetectorId()));
-            }
-            hist1D = Get1DHistogram("DescantGreenHitPattern","Statistics");
-            for(size_t firstDet = 0; firstDet < fDescantGreenDetector->size(); ++firstDet) {
-                hist1D->Fill((fDescantGreenDetector->at(firstDet).DetectorId()));
-            }
-            hist1D = Get1DHistogram("DescantRedHitPattern","Statistics");
-            for(size_t firstDet = 0; firstDet < fDescantRedDetector->size(); ++firstDet) {
-                hist1D->Fill((fDescantRedDetector->at(firstDet).DetectorId()));
-            }
-            hist1D = Get1DHistogram("DescantWhiteHitPattern","Statistics");
-            for(size_t firstDet = 0; firstDet < fDescantWhiteDetector->size(); ++firstDet) {
-                hist1D->Fill((fDescantWhiteDetector->at(firstDet).DetectorId()));
-            }
-            hist1D = Get1DHistogram("DescantYellowHitPattern","Statistics");
-            for(size_t firstDet = 0; firstDet < fDescantYellowDetector->size(); ++firstDet) {
-                hist1D->Fill((fDescantYellowDetector->at(firstDet).DetectorId()));
-            }
             hist1D = Get1DHistogram("TestcanMultiplicity","Statistics");
             hist1D->Fill(fTestcanDetector->size());
             for(size_t firstDet = 0; firstDet < fTestcanDetector->size(); ++firstDet) {
@@ -1625,874 +2168,1082 @@ bool Converter::Run() {
             for(size_t firstDet = 0; firstDet < fTISTARArray->size(); ++firstDet) {
                 hist1D->Fill((fTISTARArray->at(firstDet).DetectorId()));
             }            
-    
 
-            // GRIFFIN Crystal
-            FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_unsup_edep_cry", "Griffin1D");
-            FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_unsup_edep_cry_nr", "0RES_Griffin1D");
+            // GRIFFIN is processed before the tree is filled, the tree holds the suppressed GRIFFIN hits
+            FillActiveSystemHistograms(true);
+            if(fGriffinCrystal->empty()) {
+                // the GRIFFIN multiplicities after the addback and the suppression are filled by FillGriffinHistograms
+                Get1DHistogram("GriffinDetectorMultiplicityUnsup","Statistics")->Fill(0);
+                Get1DHistogram("GriffinCrystalMultiplicitySup","Statistics")->Fill(0);
+                Get1DHistogram("GriffinDetectorMultiplicitySup","Statistics")->Fill(0);
+            }
 
-            FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_unsup_edep_cry_matrix", "Griffin2D");
-            FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_unsup_edep_cry_matrix_nr", "0RES_Griffin2D");
+            if(fSettings->WriteTree())
+                FillTree(eventNumber); // Tree contains suppressed data
 
-            // GRIFFIN Detector / Clover
-            FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_unsup_edep", "Griffin1D");
-            FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_unsup_edep_nr", "0RES_Griffin1D");
+            //multiplicity histogram
+            hist1D = Get1DHistogram("GriffinBgoMultiplicitySup","Statistics");
+            hist1D->Fill(fGriffinBgo->size());
 
-            if(fSceptarHit) {
-                FillHist2DGriffinSceptarHitPattern(hist2D, fGriffinDetector, fSceptarDetector, "griffin_crystal_sceptar_hit_pattern","Griffin2D");
+            // LaBr, EightPi, SCEPTAR, DESCANT, Testcan, Paces, and TI-STAR
+            FillActiveSystemHistograms(false);
 
-                FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_unsup_sceptar_coin_edep", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_unsup_sceptar_coin_edep_nr", "0RES_Griffin1D");
-                FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_unsup_sceptar_coin_edep_cry", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_unsup_sceptar_coin_edep_cry_nr", "0RES_Griffin1D");
+            ClearActiveSystems();
 
-                if(fSettings->Write2DSGGHist()) {
-                    FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_unsup_sceptar_coin_edep_matrix","Griffin2D");
-                    FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_unsup_sceptar_coin_edep_matrix_nr","0RES_Griffin2D");
-                    FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_unsup_sceptar_coin_edep_cry_matrix","Griffin2D");
-                    FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_unsup_sceptar_coin_edep_cry_matrix_nr","0RES_Griffin2D");
-                }
+            fGriffinDetector->clear();
+            fGriffinNeighbour->clear();
+            fGriffinNeighbourVector->clear();
+            fGriffinArray->clear();
 
-            } else {
-                FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_unsup_sceptar_anticoin_edep", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_unsup_sceptar_anticoin_edep_nr", "0RES_Griffin1D");
-                FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_unsup_sceptar_anticoin_edep_cry", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_unsup_sceptar_anticoin_edep_cry_nr", "0RES_Griffin1D");
-                if(fSettings->Write2DSGGHist()) {
-                    FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_unsup_sceptar_anticoin_edep_matrix","Griffin2D");
-                    FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_unsup_sceptar_anticoin_edep_matrix_nr","0RES_Griffin2D");
-                    FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_unsup_sceptar_anticoin_edep_cry_matrix","Griffin2D");
-                    FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_unsup_sceptar_anticoin_edep_cry_matrix_nr","0RES_Griffin2D");
-                }
-            }
+            fLaBrArray->clear();
 
-            FillHist2DGriffinHitPattern(hist2D, fGriffinDetector, "griffin_crystal_hit_pattern","Griffin2D");
+            fAncillaryBgoDetector->clear();
+            fAncillaryBgoArray->clear();
 
-            FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_unsup_edep_matrix","Griffin2D");
-            FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_unsup_edep_matrix_nr","0RES_Griffin2D");
+            fEightPiArray->clear();
 
+            fSceptarArray->clear();
 
-            // 3D gamma-gamma corr - Crystal Method
-            for(size_t firstDet = 0; firstDet < fGriffinCrystal->size(); ++firstDet) {
-                if(fSettings->WriteNDHist()) {
-                    // add-back 0 deg hits
-                    if(fGriffinCrystal->size()==1) {
-                        Double_t fillval[3] = {fGriffinCrystal->at(0).Energy(), fGriffinCrystal->at(0).Energy(),0.0};
-                        histND = GetNDHistogram("griffin_crystal_unsup_gamma_gamma_corr_edep_cry_sparse","GriffinND");
-                        histND->Fill(fillval); //1.0/64);
-                    }
-                    for(size_t secondDet = firstDet+1; secondDet < fGriffinCrystal->size(); ++secondDet) {
-                        cry1energy  = fGriffinCrystal->at(firstDet).Energy();
-                        cry1        = fGriffinCrystal->at(firstDet).CrystalId();
-                        cry2energy  = fGriffinCrystal->at(secondDet).Energy();
-                        cry2        = fGriffinCrystal->at(secondDet).CrystalId();
-                        angle = GriffinCryMap[(int)((4*fGriffinCrystal->at(firstDet).DetectorId())+fGriffinCrystal->at(firstDet).CrystalId())][(int)((4*fGriffinCrystal->at(secondDet).DetectorId())+fGriffinCrystal->at(secondDet).CrystalId())];
-                        for(int i = 0; i < 52; i++) {
-                            if(GriffinCryMapCombos[i][0] == angle) {
-                                norm = (double)GriffinCryMapCombos[i][1];
-                                index = i;
-                                break;
-                            }
-                        }
-                        if(cry1energy == 0 || cry2energy == 0 || norm == 0) {
-                            std::cout << "error, didn't find something" << std::endl;
-                            std::cout << "cry1energy = " << cry1energy << std::endl;
-                            std::cout << "cry2energy = " << cry2energy << std::endl;
-                            std::cout << "norm = " << norm << std::endl;
-                            std::cout << "angle = " << angle << std::endl;
-                        }
-                        Double_t fillval2[3] = {fGriffinCrystal->at(firstDet).Energy(), fGriffinCrystal->at(secondDet).Energy(),(double)index};
-                        Double_t fillval3[3] = {fGriffinCrystal->at(secondDet).Energy(), fGriffinCrystal->at(firstDet).Energy(),(double)index};
-                        histND = GetNDHistogram("griffin_crystal_unsup_gamma_gamma_corr_edep_cry_sparse","GriffinND");
-                        histND->Fill(fillval2); //1.0/64);
-                        histND->Fill(fillval3); //1.0/64);
-                        cry1 = 0;
-                        cry2 = 0;
-                        cry1energy = 0;
-                        cry2energy = 0;
-                        angle = 0;
-                        norm = 0;
-                    }
-                }
-            }
+            fDescantArray->clear();
 
+            fPacesArray->clear();
 
-            // 3D gamma-gamma corr - Detector Method
-            for(size_t firstDet = 0; firstDet < fGriffinDetector->size(); ++firstDet) {
-                if(fSettings->WriteNDHist()) {
-                    // add-back 0 deg hits
-                    if(fGriffinDetector->size()==1) {
-                        Double_t fillvalab[3] = {fGriffinDetector->at(0).Energy(), fGriffinDetector->at(0).Energy(),0.0};
-                        histND = GetNDHistogram("griffin_crystal_unsup_gamma_gamma_corr_edep_det_sparse","GriffinND");
-                        histND->Fill(fillvalab); //1.0/64);
-                    }
-                    for(size_t secondDet = firstDet+1; secondDet < fGriffinDetector->size(); ++secondDet) {
-                        det1        = fGriffinDetector->at(firstDet).DetectorId();
-                        det2        = fGriffinDetector->at(secondDet).DetectorId();
-                        det1energy  = fGriffinDetector->at(firstDet).Energy();
-                        det2energy  = fGriffinDetector->at(secondDet).Energy();
-                        angle = GriffinDetMap[(int)((fGriffinDetector->at(firstDet).DetectorId()))][(int)((fGriffinDetector->at(secondDet).DetectorId()))];
-                        for(int i = 0; i < 7; i++) {
-                            if(GriffinDetMapCombos[i][0] == angle) {
-                                norm = (double)GriffinDetMapCombos[i][1];
-                                index = i;
-                                break;
-                            }
-                        }
-                        if(det1energy == 0 || det2energy == 0 || norm == 0) {
-                            std::cout << "error, didn't find something" << std::endl;
-                            std::cout << "det1energy = " << det1energy << std::endl;
-                            std::cout << "det2energy = " << det2energy << std::endl;
-                            std::cout << "det1 = " << det1 << std::endl;
-                            std::cout << "det2 = " << det2 << std::endl;
-                            std::cout << "norm = " << norm << std::endl;
-                            std::cout << "angle = " << angle << std::endl;
-                        }
-                        Double_t fillval2ab[3] = {fGriffinDetector->at(firstDet).Energy(), fGriffinDetector->at(secondDet).Energy(),(double)index};
-                        Double_t fillval3ab[3] = {fGriffinDetector->at(secondDet).Energy(), fGriffinDetector->at(firstDet).Energy(),(double)index};
-                        histND = GetNDHistogram("griffin_crystal_unsup_gamma_gamma_corr_edep_det_sparse","GriffinND");
-                        histND->Fill(fillval2ab); //1.0/64);
-                        histND->Fill(fillval3ab); //1.0/64);
-                        det1 = 0;
-                        det2 = 0;
-                        det1energy = 0;
-                        det2energy = 0;
-                        angle = 0;
-                        norm = 0;
-                    }
+            fBelowThreshold.clear();
+            fOutsideTimeWindow.clear();
+
+            if(fSkimFile != nullptr) {
+                if(skimEvent) {
+                    WriteSkimEvent();
                 }
+                fSkimHits.clear();
             }
 
+         
+            
+            // re-set this at the end, as we need the previous hit event number to get
+            // the correct entry in the generator tree
+            eventNumber = fEventNumber;
+        }
 
+        // the event numbers increase through the input, so once the last event to sort has been processed
+        // (above, when the first entry of the next event was read) nothing else has to be read
+        if(fSettings->SortNumberOfEvents() > 0 && fEventNumber > fSettings->SortNumberOfEvents()) {
+            break;
+        }
 
-            // 3D gamma-gamma corr - Add-back Method
-            for(size_t firstDet = 0; firstDet < fGriffinDetector->size(); ++firstDet) {
-                if(fSettings->WriteNDHist()) {
-                    cry1 = 0;
-                    cry2 = 0;
-                    cry1energy = 0;
-                    cry2energy = 0;
-                    angle = 0;
-                    norm = 0;
-                    // add-back 0 deg hits - if there's only one detector, then all the interactions are added back to a zero-degree summed hit
-                    if(fGriffinDetector->size()==1) {
-                       Double_t fillvalabn[3] = {fGriffinDetector->at(0).Energy(), fGriffinDetector->at(0).Energy(),0.0};
-                       histND = GetNDHistogram("griffin_crystal_unsup_gamma_gamma_corr_edep_cry_addback_sparse","GriffinND");
-                       histND->Fill(fillvalabn); //1.0/64);
-                    } // done 0 deg hits
-                    else { // we have interactions in multiple detectors!
-                        // iterate over summed detector energies
-                        for(size_t secondDet = firstDet+1; secondDet < fGriffinDetector->size(); ++secondDet) {
-                            for(size_t thiscry = 0; thiscry < fGriffinCrystal->size(); ++thiscry) { // iterate over all interactions
-                                 // if this interaction occurred in the first detector...
-                                if(fGriffinCrystal->at(thiscry).DetectorId() == fGriffinDetector->at(firstDet).DetectorId() ) {
-                                    //...then compare with cry1energy...
-                                    if(fGriffinCrystal->at(thiscry).Energy() > cry1energy){
-                                       //...and if the new energy is larger, set the crystal 1 ID and the energy.
-                                        cry1energy  = fGriffinCrystal->at(thiscry).Energy();
-                                        cry1        = fGriffinCrystal->at(thiscry).CrystalId();
-                                    }
-                                }
-                                 // if this interaction occurred in the second detector...
-                                if(fGriffinCrystal->at(thiscry).DetectorId() == fGriffinDetector->at(secondDet).DetectorId() ) {
-                                    //...then compare with cry2energy...
-                                    if(fGriffinCrystal->at(thiscry).Energy() > cry2energy){
-                                       //...and if the new energy is larger, set the crystal 2 ID and the energy.
-                                        cry2energy  = fGriffinCrystal->at(thiscry).Energy();
-                                        cry2        = fGriffinCrystal->at(thiscry).CrystalId();
-                                    }
-                                }
-                            }
-                            angle = GriffinCryMap[(int)((4*fGriffinDetector->at(firstDet).DetectorId())+cry1)][(int)((4*fGriffinDetector->at(secondDet).DetectorId())+cry2)];
-                            for(int i = 0; i < 52; i++) {
-                                if(GriffinCryMapCombos[i][0] == angle) {
-                                    norm = (double)GriffinCryMapCombos[i][1];
-                                    index = i;
-                                    break;
-                                }
-                            }
-                            if(cry1energy == 0 || cry2energy == 0 || norm == 0) {
-										 std::cout << "error, didn't find something" << std::endl;
-										 std::cout << "cry1energy = " << cry1energy << std::endl;
-										 std::cout << "cry2energy = " << cry2energy << std::endl;
-										 std::cout << "norm = " << norm << std::endl;
-										 std::cout << "angle = " << angle << std::endl;
-                            }
-                            Double_t fillval2abn[3] = {fGriffinDetector->at(firstDet).Energy(), fGriffinDetector->at(secondDet).Energy(),(double)index};
-                            Double_t fillval3abn[3] = {fGriffinDetector->at(secondDet).Energy(), fGriffinDetector->at(firstDet).Energy(),(double)index};
-                            histND = GetNDHistogram("griffin_crystal_unsup_gamma_gamma_corr_edep_cry_addback_sparse","GriffinND");
-                            histND->Fill(fillval2abn); //1.0/64);
-                            histND->Fill(fillval3abn); //1.0/64);
-                            cry1 = 0;
-                            cry2 = 0;
-                            cry1energy = 0;
-                            cry2energy = 0;
-                            angle = 0;
-                            norm = 0;
-                        }
-                    }
-                }
-            }
-
-            // Neighbours
-            FillHistDetector1DGamma(hist1D, fGriffinNeighbour, "griffin_crystal_unsup_edep_neigh", "Griffin1D");
-            FillHistDetector1DGammaNR(hist1D, fGriffinNeighbour, "griffin_crystal_unsup_edep_neigh_nr", "0RES_Griffin1D");
+        // keep the raw hit as read from the input for the skim
+        if(fSkimFile != nullptr) {
+            RawHit hit;
+            hit.fEventNumber = fEventNumber;
+            hit.fTrackID = fTrackID;
+            hit.fParentID = fParentID;
+            hit.fStepNumber = fStepNumber;
+            hit.fParticleType = fParticleType;
+            hit.fProcessType = fProcessType;
+            hit.fSystemID = fSystemID;
+            hit.fDetNumber = fDetNumber;
+            hit.fCryNumber = fCryNumber;
+            hit.fDepEnergy = fDepEnergy;
+            hit.fPosx = fPosx;
+            hit.fPosy = fPosy;
+            hit.fPosz = fPosz;
+            hit.fTime = fTime;
+            hit.fTargetZ = fTargetZ;
+            hit.fTargetA = fTargetA;
+            fSkimHits.push_back(hit);
+        }
 
-            if(fSceptarHit) {
-                FillHistDetector1DGamma(hist1D, fGriffinNeighbour, "griffin_crystal_unsup_sceptar_coin_edep_neigh", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinNeighbour, "griffin_crystal_unsup_sceptar_coin_edep_neigh_nr", "0RES_Griffin1D");
-            } else {
-                FillHistDetector1DGamma(hist1D, fGriffinNeighbour, "griffin_crystal_unsup_sceptar_anticoin_edep_neigh", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinNeighbour, "griffin_crystal_unsup_sceptar_anticoin_edep_neigh_nr", "0RES_Griffin1D");
-            }
+        if(fSettings->VerbosityLevel() > 1) {
+            std::cout<<"Entry: "<<i<<", Event: "<<fEventNumber<<", Track: "<<fTrackID<<", Det: "<<fDetNumber<<", Cry: "
+                     <<fCryNumber<<", Edep: "<<fDepEnergy<<"keV, ParticleID: "<<fParticleType<<", (x,y,z) = ("
+                     <<fPosx<<", "<<fPosy<<", "<<fPosz<<" )"<<std::endl;
+        }
 
-            // Neighbours Vectors
-            FillHistDetector1DGamma(hist1D, fGriffinNeighbourVector, "griffin_crystal_unsup_edep_neighvec", "Griffin1D");
-            FillHistDetector1DGammaNR(hist1D, fGriffinNeighbourVector, "griffin_crystal_unsup_edep_neighvec_nr", "0RES_Griffin1D");
+        // if fSystemID is NOT GRIFFIN, then set fCryNumber to zero
+        // This is a quick fix to solve resolution and threshold values from Settings.cc
+        // Modified to include TI-STAR, which does use the systemID
+        if(fSystemID >= 2000 && fSystemID != 9500) {
+            fCryNumber = 0;
+        }
 
-            if(fSceptarHit) {
-                FillHistDetector1DGamma(hist1D, fGriffinNeighbourVector, "griffin_crystal_unsup_sceptar_coin_edep_neighvec", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinNeighbourVector, "griffin_crystal_unsup_sceptar_coin_edep_neighvec_nr", "0RES_Griffin1D");
-            } else {
-                FillHistDetector1DGamma(hist1D, fGriffinNeighbourVector, "griffin_crystal_unsup_sceptar_anticoin_edep_neighvec", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinNeighbourVector, "griffin_crystal_unsup_sceptar_anticoin_edep_neighvec_nr", "0RES_Griffin1D");
-            }
+        // if fSystemID is TISTAR, decrement the detector and crystal number 
+        // this is to solve the numbering problem of the layers/strips, which both
+        // start at 1, vs. the vector index which starts at 0
+        if(fSystemID == 9500) {
+            fDetNumber -= 1;
+            fCryNumber -= 1;
+        }
 
-            FillHistDetector1DGamma(hist1D, fGriffinArray, "griffin_crystal_unsup_edep_sum", "Griffin1D");
-            FillHistDetector1DGammaNR(hist1D, fGriffinArray, "griffin_crystal_unsup_edep_sum_nr", "0RES_Griffin1D");
+        // adding up ti-star hits (checking to see if we have more than 1 in a given strip/ring)
+        FillTistarVectors();
 
-            // descant coin hits
-            if(descantArrayHits == 0) {
-                FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_unsup_descanthit0_coin_edep_cry", "Griffin1D");
-                FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_unsup_descanthit0_coin_edep", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_unsup_descanthit0_coin_edep_cry_nr", "0RES_Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_unsup_descanthit0_coin_edep_nr", "0RES_Griffin1D");
+        // keep the raw hit, so it can be piled up on later events
+        if(!fOverlayEvents.empty()) {
+            SimulatedHit hit;
+            hit.fSystemID = fSystemID;
+            hit.fDetNumber = fDetNumber;
+            hit.fCryNumber = fCryNumber;
+            hit.fDepEnergy = fDepEnergy;
+            hit.fPosition.SetXYZ(fPosx,fPosy,fPosz);
+            hit.fTime = fTime;
+            fOverlayCurrent.push_back(hit);
+        }
+        AddSimulatedHit(fEventNumber, fSystemID, fDetNumber, fCryNumber, fDepEnergy, TVector3(fPosx,fPosy,fPosz), fTime);
 
-                FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_unsup_descanthit0_edep_cry_matrix", "Griffin2D");
-                FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_unsup_descanthit0_edep_matrix", "Griffin2D");
-                FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_unsup_descanthit0_edep_cry_matrix_nr", "0RES_Griffin2D");
-                FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_unsup_descanthit0_edep_matrix_nr", "0RES_Griffin2D");
+        if(i%1000 == 0 && fSettings->VerbosityLevel() > 0) {
+            std::cout<<std::setw(3)<<100*i/nEntries<<"% done\r"<<std::flush;
+        }
+    }
 
-            }
-            else if(descantArrayHits == 1) {
-                FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_unsup_descanthit1_coin_edep_cry", "Griffin1D");
-                FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_unsup_descanthit1_coin_edep", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_unsup_descanthit1_coin_edep_cry_nr", "0RES_Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_unsup_descanthit1_coin_edep_nr", "0RES_Griffin1D");
+    if(fSettings->VerbosityLevel() > 0) {
+        std::cout<<"100% done"<<std::endl;
 
-                FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_unsup_descanthit1_edep_cry_matrix", "Griffin2D");
-                FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_unsup_descanthit1_edep_matrix", "Griffin2D");
-                FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_unsup_descanthit1_edep_cry_matrix_nr", "0RES_Griffin2D");
-                FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_unsup_descanthit1_edep_matrix_nr", "0RES_Griffin2D");
-            }
-            else if(descantArrayHits == 2) {
-                FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_unsup_descanthit2_coin_edep_cry", "Griffin1D");
-                FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_unsup_descanthit2_coin_edep", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_unsup_descanthit2_coin_edep_cry_nr", "0RES_Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_unsup_descanthit2_coin_edep_nr", "0RES_Griffin1D");
+        if(fSettings->VerbosityLevel() > 1) {
+            PrintStatistics();
+        }
+    }
 
-                FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_unsup_descanthit2_edep_cry_matrix", "Griffin2D");
-                FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_unsup_descanthit2_edep_matrix", "Griffin2D");
-                FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_unsup_descanthit2_edep_cry_matrix_nr", "0RES_Griffin2D");
-                FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_unsup_descanthit2_edep_matrix_nr", "0RES_Griffin2D");
-            }
-            else {
-                FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_unsup_descanthitn_coin_edep_cry", "Griffin1D");
-                FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_unsup_descanthitn_coin_edep", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_unsup_descanthitn_coin_edep_cry_nr", "0RES_Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_unsup_descanthitn_coin_edep_nr", "0RES_Griffin1D");
+    return true;
+}
 
-                FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_unsup_descanthitn_edep_cry_matrix", "Griffin2D");
-                FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_unsup_descanthitn_edep_matrix", "Griffin2D");
-                FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_unsup_descanthitn_edep_cry_matrix_nr", "0RES_Griffin2D");
-                FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_unsup_descanthitn_edep_matrix_nr", "0RES_Griffin2D");
-            }
+bool Converter::AboveThreshold(double energy, int systemID, int detNumber, int cryNumber) {
+    if(systemID == 5000) {
+        // apply hard threshold of 50 keV on Sceptar
+        // SCEPTAR in reality saturates at an efficiency of about 80%. In simulation we get an efficiency of 90%
+        // 0.9 * 1.11111111 = 100%, 0.8*1.1111111 = 0.888888888
+        if(energy > 50.0 && (fRandom.Uniform(0.,1.) < 0.88888888 )) {
+            return true;
+        }
+        else {
+            return false;
+        }
+    }
+    else if(energy > fSettings->Threshold(systemID,detNumber,cryNumber)+10*fSettings->ThresholdWidth(systemID,detNumber,cryNumber)) {
+        return true;
+    }
 
+    if(fRandom.Uniform(0.,1.) < 0.5*(TMath::Erf((energy-fSettings->Threshold(systemID,detNumber,cryNumber))/fSettings->ThresholdWidth(systemID,detNumber,cryNumber))+1)) {
+        return true;
+    }
 
-            // CLEAR GRIFFIN //
-            fGriffinDetector->clear();
-            fGriffinNeighbour->clear();
-            fGriffinNeighbourVector->clear();
-            fGriffinArray->clear();
+    return false;
+}
 
-            //---------------------------------------------------------------------
-            // Suppressed GRIFFIN
-            //---------------------------------------------------------------------
-            SupressGriffin();
-            AddbackGriffin();
-            if(fSettings->WriteGriffinAddbackVector())
-                AddbackGriffinNeighbourVector();
+bool Converter::InsideTimeWindow(int systemID, int detNumber, int cryNumber, double time) {
+    if(fSettings->TimeWindow(systemID,detNumber,cryNumber) == 0) {
+        return true;
+    }
+    if(time < fSettings->TimeWindow(systemID,detNumber,cryNumber)) {
+        return true;
+    }
+    return false;
+}
 
-            if(fSettings->WriteTree())
-                fTree.Fill(); // Tree contains suppressed data
+void Converter::AddSimulatedHit(Int_t eventNumber, Int_t systemID, Int_t detNumber, Int_t cryNumber, Double_t depEnergy, const TVector3& position, Double_t time) {
+    //create energy-resolution smeared energy
+    double smearedEnergy = fRandom.Gaus(depEnergy,fSettings->Resolution(systemID,detNumber,cryNumber,depEnergy));
 
-            //-------------------- crystal histograms
-            //multiplicity histogram
-            hist1D = Get1DHistogram("GriffinCrystalMultiplicitySup","Statistics");
-            hist1D->Fill(fGriffinCrystal->size());
-            hist1D = Get1DHistogram("GriffinBgoMultiplicitySup","Statistics");
-            hist1D->Fill(fGriffinBgo->size());
-            hist1D = Get1DHistogram("GriffinDetectorMultiplicitySup","Statistics");
-            hist1D->Fill(fGriffinDetector->size());
-
-            // GRIFFIN Crystal
-            FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_sup_edep_cry", "Griffin1D");
-            FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_sup_edep_cry_nr", "0RES_Griffin1D");
-
-            FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_sup_edep_cry_matrix", "Griffin2D");
-            FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_sup_edep_cry_matrix_nr", "0RES_Griffin2D");
-
-            if(fGriffinBgo->size() == 0 && fGriffinBgoBack->size() == 0) {
-                FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_arraysup_edep_cry", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_arraysup_edep_cry_nr", "0RES_Griffin1D");
-
-                FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_arraysup_edep_cry_matrix","Griffin2D");
-                FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_arraysup_edep_cry_matrix_nr","0RES_Griffin2D");
-            }
-
-            // GRIFFIN Detector / Clover
-            FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_sup_edep", "Griffin1D");
-            FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_sup_edep_nr", "0RES_Griffin1D");
-
-            if(fSceptarHit) {
-                FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_sup_sceptar_coin_edep", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_sup_sceptar_coin_edep_nr", "0RES_Griffin1D");
-                FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_sup_sceptar_coin_edep_cry", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_sup_sceptar_coin_edep_cry_nr", "0RES_Griffin1D");
-                if(fSettings->Write2DSGGHist()) {
-                    FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_sup_sceptar_coin_edep_matrix","Griffin2D");
-                    FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_sup_sceptar_coin_edep_matrix_nr","0RES_Griffin2D");
-                    FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_sup_sceptar_coin_edep_cry_matrix","Griffin2D");
-                    FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_sup_sceptar_coin_edep_cry_matrix_nr","0RES_Griffin2D");
-                }
-            } else {
-                FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_sup_sceptar_anticoin_edep", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_sup_sceptar_anticoin_edep_nr", "0RES_Griffin1D");
-                FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_sup_sceptar_anticoin_edep_cry", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_sup_sceptar_anticoin_edep_cry_nr", "0RES_Griffin1D");
-                if(fSettings->Write2DSGGHist()) {
-                    FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_sup_sceptar_anticoin_edep_matrix","Griffin2D");
-                    FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_sup_sceptar_anticoin_edep_matrix_nr","0RES_Griffin2D");
-                    FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_sup_sceptar_anticoin_edep_cry_matrix","Griffin2D");
-                    FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_sup_sceptar_anticoin_edep_cry_matrix_nr","0RES_Griffin2D");
+    //if the hit is above the threshold, we add it to the vector
+    if(!AboveThreshold(smearedEnergy, systemID, detNumber, cryNumber)) {
+        ++fBelowThreshold[systemID];
+        return;
+    }
+    if(!InsideTimeWindow(systemID, detNumber, cryNumber, time)) {
+        ++fOutsideTimeWindow[systemID];
+        return;
+    }
+    if(systemID < 0 || systemID >= static_cast<int>(fSystemIndex.size()) || fSystemIndex[systemID] < 0) {
+        std::cerr<<"Unknown detector system ID "<<systemID<<std::endl;
+        return;
+    }
+    Detector hit(eventNumber, detNumber, cryNumber, depEnergy, smearedEnergy, position, time);
+    AddHit(fSystemIndex[systemID], hit);
+}
 
-                }
+void Converter::OverlayEvents(Int_t eventNumber) {
+    // Other events arrive as a poisson process with the overlay rate. Every one of them within +- the overlay window
+    // is replaced by a random event from the ring buffer of recent events, shifted by its arrival time.
+    if(fOverlayFilled > 0) {
+        double meanInterval = 1./fSettings->OverlayRate();
+        double window = fSettings->OverlayWindow();
+        for(double shift = -window + fRandom.Exp(meanInterval); shift < window; shift += fRandom.Exp(meanInterval)) {
+            std::vector<SimulatedHit>& event = fOverlayEvents[fRandom.Integer(fOverlayFilled)];
+            for(auto hit = event.begin(); hit != event.end(); ++hit) {
+                AddSimulatedHit(eventNumber, hit->fSystemID, hit->fDetNumber, hit->fCryNumber, hit->fDepEnergy, hit->fPosition, hit->fTime + shift);
             }
+        }
+    }
 
-            FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_sup_edep_matrix","Griffin2D");
-            FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_sup_edep_matrix_nr","0RES_Griffin2D");
-
+    // only the hits of this event itself become one of the recent events, not the ones piled up on it
+    fOverlayEvents[fOverlayNext].swap(fOverlayCurrent);
+    fOverlayCurrent.clear();
+    fOverlayNext = (fOverlayNext+1)%fOverlayEvents.size();
+    if(fOverlayFilled < fOverlayEvents.size()) {
+        ++fOverlayFilled;
+    }
+}
 
-            // Neighbours
-            FillHistDetector1DGamma(hist1D, fGriffinNeighbour, "griffin_crystal_sup_edep_neigh", "Griffin1D");
-            FillHistDetector1DGammaNR(hist1D, fGriffinNeighbour, "griffin_crystal_sup_edep_neigh_nr", "0RES_Griffin1D");
+bool Converter::DescantNeutronDiscrimination() { // Assuming perfect gamma-neutron discrimination
+    if(fParticleType == 5) { // neutron
+        return true;
+    }
+    return false;
+}
 
-            if(fSceptarHit) {
-                FillHistDetector1DGamma(hist1D, fGriffinNeighbour, "griffin_crystal_sup_sceptar_coin_edep_neigh", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinNeighbour, "griffin_crystal_sup_sceptar_coin_edep_neigh_nr", "0RES_Griffin1D");
-            } else {
-                FillHistDetector1DGamma(hist1D, fGriffinNeighbour, "griffin_crystal_sup_sceptar_anticoin_edep_neigh", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinNeighbour, "griffin_crystal_sup_sceptar_anticoin_edep_neigh_nr", "0RES_Griffin1D");
-            }
 
-            // Neighbours Vectors
-            FillHistDetector1DGamma(hist1D, fGriffinNeighbourVector, "griffin_crystal_sup_edep_neighvec", "Griffin1D");
-            FillHistDetector1DGammaNR(hist1D, fGriffinNeighbourVector, "griffin_crystal_sup_edep_neighvec_nr", "0RES_Griffin1D");
 
-            if(fSceptarHit) {
-                FillHistDetector1DGamma(hist1D, fGriffinNeighbourVector, "griffin_crystal_sup_sceptar_coin_edep_neighvec", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinNeighbourVector, "griffin_crystal_sup_sceptar_coin_edep_neighvec_nr", "0RES_Griffin1D");
-            } else {
-                FillHistDetector1DGamma(hist1D, fGriffinNeighbourVector, "griffin_crystal_sup_sceptar_anticoin_edep_neighvec", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinNeighbourVector, "griffin_crystal_sup_sceptar_anticoin_edep_neighvec_nr", "0RES_Griffin1D");
-            }
+void Converter::MergeHits(std::vector<Detector>* hits, bool byCrystal) {
+    // Sums the energies of all hits in the same detector (and crystal if byCrystal is set) into the first of those hits,
+    // which keeps its time and position, and removes the others. The order of the remaining hits is unchanged.
+    // Sorting the (key, index) pairs groups the hits in O(n log n) instead of comparing every pair of hits.
+    if(hits->size() < 2) {
+        return;
+    }
+    fMergeKeys.clear();
+    for(size_t i = 0; i < hits->size(); ++i) {
+        fMergeKeys.push_back(std::make_pair(std::make_pair((*hits)[i].DetectorId(), byCrystal ? (*hits)[i].CrystalId() : 0), i));
+    }
+    std::sort(fMergeKeys.begin(), fMergeKeys.end());
+    fMergeRemove.assign(hits->size(), false);
+    bool merged = false;
+    size_t first = 0;
+    for(size_t i = 1; i < fMergeKeys.size(); ++i) {
+        if(fMergeKeys[i].first != fMergeKeys[first].first) {
+            first = i;
+            continue;
+        }
+        // same key as the first (earliest) hit of this group, the indices within a group are in ascending order
+        Detector& hit = (*hits)[fMergeKeys[i].second];
+        (*hits)[fMergeKeys[first].second].AddEnergy(hit.SimulationEnergy(),hit.Energy());
+        fMergeRemove[fMergeKeys[i].second] = true;
+        merged = true;
+    }
+    if(!merged) {
+        return;
+    }
+    size_t good = 0;
+    for(size_t i = 0; i < hits->size(); ++i) {
+        if(fMergeRemove[i]) {
+            continue;
+        }
+        if(good != i) {
+            (*hits)[good] = (*hits)[i];
+        }
+        ++good;
+    }
+    hits->erase(hits->begin()+good, hits->end());
+}
 
-            // GRIFFIN Detector / Clover
-            if(fGriffinBgo->size() == 0 && fGriffinBgoBack->size() == 0) {
-                FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_arraysup_edep", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_arraysup_edep_nr", "0RES_Griffin1D");
+int Converter::RegisterSystem(const std::string& name, std::vector<Detector>* hits, EMergeRule merge, void (Converter::*fillHistograms)(), bool* fired, bool beforeTree) {
+    DetectorSystem system;
+    system.fName = name;
+    system.fHits = hits;
+    system.fMerge = merge;
+    system.fFired = fired;
+    system.fFillHistograms = fillHistograms;
+    system.fBeforeTree = beforeTree;
+    system.fActive = false;
+    fSystems.push_back(system);
+    return fSystems.size()-1;
+}
 
-                FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_arraysup_edep_matrix","Griffin2D");
-                FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_arraysup_edep_matrix_nr","0RES_Griffin2D");
-            }
+void Converter::MapSystem(int systemId, int index) {
+    if(systemId < 0 || systemId >= static_cast<int>(fSystemIndex.size())) {
+        std::cerr<<"Can't map system ID "<<systemId<<" to "<<fSystems[index].fName<<", system IDs have to be between 0 and "<<fSystemIndex.size()-1<<std::endl;
+        return;
+    }
+    fSystemIndex[systemId] = index;
+}
 
-            FillHistDetector1DGamma(hist1D, fGriffinArray, "griffin_crystal_sup_edep_sum", "Griffin1D");
-            FillHistDetector1DGammaNR(hist1D, fGriffinArray, "griffin_crystal_sup_edep_sum_nr", "0RES_Griffin1D");
+void Converter::AddHit(int index, Detector& hit) {
+    DetectorSystem& system = fSystems[index];
+    if(!system.fActive) {
+        system.fActive = true;
+        fActiveSystems.push_back(index);
+        if(system.fFired != nullptr) {
+            *(system.fFired) = true;
+        }
+    }
+    system.fHits->push_back(hit);
+    if(hit.DetectorId() >= 0 && hit.DetectorId() < static_cast<int>(system.fLayers.size())) {
+        system.fLayers[hit.DetectorId()]->push_back(hit);
+    }
+}
 
-            if(fGriffinBgo->size() == 0 && fGriffinBgoBack->size() == 0 ) {
-                FillHistDetector1DGamma(hist1D, fGriffinArray, "griffin_crystal_arraysup_edep_sum", "Griffin1D");
-                FillHistDetector1DGammaNR(hist1D, fGriffinArray, "griffin_crystal_arraysup_edep_sum_nr", "0RES_Griffin1D");
-            }
+void Converter::MergeActiveSystems() {
+    for(auto index = fActiveSystems.begin(); index != fActiveSystems.end(); ++index) {
+        DetectorSystem& system = fSystems[*index];
+        if(system.fMerge != kNoMerge) {
+            MergeHits(system.fHits, system.fMerge == kMergeByCrystal);
+        }
+    }
+}
 
+void Converter::FillActiveSystemHistograms(bool beforeTree) {
+    for(auto index = fActiveSystems.begin(); index != fActiveSystems.end(); ++index) {
+        DetectorSystem& system = fSystems[*index];
+        if(system.fFillHistograms == nullptr || system.fBeforeTree != beforeTree) {
+            continue;
+        }
+        // systems sharing a hook (the DESCANT colours) only get it called once
+        bool called = false;
+        for(auto previous = fActiveSystems.begin(); previous != index && !called; ++previous) {
+            called = (fSystems[*previous].fFillHistograms == system.fFillHistograms);
+        }
+        if(!called) {
+            (this->*(system.fFillHistograms))();
+        }
+    }
+}
 
-            // CLEAR GRIFFIN //
-            fGriffinDetector->clear();
-            fGriffinNeighbour->clear();
-            fGriffinNeighbourVector->clear();
-            fGriffinArray->clear();
+void Converter::ClearActiveSystems() {
+    for(auto index = fActiveSystems.begin(); index != fActiveSystems.end(); ++index) {
+        DetectorSystem& system = fSystems[*index];
+        system.fHits->clear();
+        for(auto layer = system.fLayers.begin(); layer != system.fLayers.end(); ++layer) {
+            (*layer)->clear();
+        }
+        if(system.fFired != nullptr) {
+            *(system.fFired) = false;
+        }
+        system.fActive = false;
+    }
+    fActiveSystems.clear();
+}
 
-            // SUPPRESSED GRIFFIN with Ancillary Detectors too
-            // now suppress and AddbackGriffin again
-            SupressGriffin();
-            SupressGriffinByNeighbouringAncillaryBgos();
-            AddbackGriffin();
+void Converter::FillGriffinHistograms() {
+    TH1F* hist1D = nullptr;
+    TH2F* hist2D = nullptr;
+    THnSparseF* histND = nullptr;
+    // for 3d gamma-gamma correlations
+    int cry1 = 0;
+    int cry2 = 0;
+    int det1 = 0;
+    int det2 = 0;
+    int index = 0;
+    double cry1energy = 0;
+    double cry2energy = 0;
+    double det1energy = 0;
+    double det2energy = 0;
+    double angle = 0;
+    double norm = 0;
 
+    for(int j = 0; j < 16; j++) {
+        GriffinNeighbours_counted[j] = 0;
+    }
 
-            FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_ancillaryneighsup_edep_cry", "Griffin1D");
-            FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_ancillaryneighsup_edep_cry_nr", "0RES_Griffin1D");
+    // number of descant hits
+    int descantArrayHits = fDescantBlueDetector->size() + fDescantGreenDetector->size() + fDescantRedDetector->size() + fDescantWhiteDetector->size() + fDescantYellowDetector->size();
+
+    // find out once which suppression conditions veto each GRIFFIN detector,
+    // all suppressed variants below are derived from this
+    ClassifyGriffin();
+
+    //---------------------------------------------------------------------
+    // Unsuppressed GRIFFIN
+    //---------------------------------------------------------------------
+    AddbackGriffin();
+    if(fSettings->WriteGriffinAddbackVector())
+        AddbackGriffinNeighbourVector();
+
+    //statistics histograms
+    hist1D = Get1DHistogram("GriffinDetectorMultiplicityUnsup","Statistics");
+    hist1D->Fill(fGriffinDetector->size());
+    hist1D = Get1DHistogram("GriffinCrystalHitPattern","Statistics");
+    for(size_t firstDet = 0; firstDet < fGriffinCrystal->size(); ++firstDet) {
+        hist1D->Fill((4*fGriffinCrystal->at(firstDet).DetectorId())+fGriffinCrystal->at(firstDet).CrystalId());
+    }
+    hist1D = Get1DHistogram("GriffinDetectorHitPattern","Statistics");
+    for(size_t firstDet = 0; firstDet < fGriffinDetector->size(); ++firstDet) {
+        hist1D->Fill((fGriffinDetector->at(firstDet).DetectorId()));
+    }
 
-            FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_ancillaryneighsup_edep", "Griffin1D");
-            FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_ancillaryneighsup_edep_nr", "0RES_Griffin1D");
+    // GRIFFIN Crystal
+    FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_unsup_edep_cry", "Griffin1D");
+    FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_unsup_edep_cry_nr", "0RES_Griffin1D");
 
-            // CLEAR GRIFFIN //
-            fGriffinDetector->clear();
-            fGriffinNeighbour->clear();
-            fGriffinNeighbourVector->clear();
-            fGriffinArray->clear();
+    FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_unsup_edep_cry_matrix", "Griffin2D");
+    FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_unsup_edep_cry_matrix_nr", "0RES_Griffin2D");
 
-            // SUPPRESSED GRIFFIN with SCEPTAR too
-            // now suppress and AddbackGriffin again
-            SupressGriffin();
-            SupressGriffinBySceptar();
-            AddbackGriffin();
+    // GRIFFIN Detector / Clover
+    FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_unsup_edep", "Griffin1D");
+    FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_unsup_edep_nr", "0RES_Griffin1D");
 
-            FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_sceptarsup_edep_cry", "Griffin1D");
-            FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_sceptarsup_edep_cry_nr", "0RES_Griffin1D");
+    if(fSceptarHit) {
+        FillHist2DGriffinSceptarHitPattern(hist2D, fGriffinDetector, fSceptarDetector, "griffin_crystal_sceptar_hit_pattern","Griffin2D");
 
-            FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_sceptarsup_edep", "Griffin1D");
-            FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_sceptarsup_edep_nr", "0RES_Griffin1D");
+        FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_unsup_sceptar_coin_edep", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_unsup_sceptar_coin_edep_nr", "0RES_Griffin1D");
+        FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_unsup_sceptar_coin_edep_cry", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_unsup_sceptar_coin_edep_cry_nr", "0RES_Griffin1D");
 
-            // LaBr3
-            // Unsuppressed
-            FillHistDetector1DGamma(hist1D, fLaBrDetector, "labr_crystal_unsup_edep", "LaBr1D");
-            FillHistDetector1DGammaNR(hist1D, fLaBrDetector, "labr_crystal_unsup_edep_nr", "0RES_LaBr1D");
+        if(fSettings->Write2DSGGHist()) {
+            FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_unsup_sceptar_coin_edep_matrix","Griffin2D");
+            FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_unsup_sceptar_coin_edep_matrix_nr","0RES_Griffin2D");
+            FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_unsup_sceptar_coin_edep_cry_matrix","Griffin2D");
+            FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_unsup_sceptar_coin_edep_cry_matrix_nr","0RES_Griffin2D");
+        }
 
-            AddbackLaBr();
+    } else {
+        FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_unsup_sceptar_anticoin_edep", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_unsup_sceptar_anticoin_edep_nr", "0RES_Griffin1D");
+        FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_unsup_sceptar_anticoin_edep_cry", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_unsup_sceptar_anticoin_edep_cry_nr", "0RES_Griffin1D");
+        if(fSettings->Write2DSGGHist()) {
+            FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_unsup_sceptar_anticoin_edep_matrix","Griffin2D");
+            FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_unsup_sceptar_anticoin_edep_matrix_nr","0RES_Griffin2D");
+            FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_unsup_sceptar_anticoin_edep_cry_matrix","Griffin2D");
+            FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_unsup_sceptar_anticoin_edep_cry_matrix_nr","0RES_Griffin2D");
+        }
+    }
 
-            FillHistDetector1DGamma(hist1D, fLaBrArray, "labr_crystal_unsup_edep_sum", "LaBr1D");
-            FillHistDetector1DGammaNR(hist1D, fLaBrArray, "labr_crystal_unsup_edep_sum_nr", "0RES_LaBr1D");
+    FillHist2DGriffinHitPattern(hist2D, fGriffinDetector, "griffin_crystal_hit_pattern","Griffin2D");
 
-            AddbackAncillaryBgo();
-            SupressLaBr();
+    FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_unsup_edep_matrix","Griffin2D");
+    FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_unsup_edep_matrix_nr","0RES_Griffin2D");
 
-            FillHistDetector1DGamma(hist1D, fLaBrDetector, "labr_crystal_sup_edep", "LaBr1D");
-            FillHistDetector1DGammaNR(hist1D, fLaBrDetector, "labr_crystal_sup_edep_nr", "0RES_LaBr1D");
 
-            if(fAncillaryBgoCrystal->size() == 0) {
-                FillHistDetector1DGamma(hist1D, fLaBrArray, "labr_crystal_sup_edep_sum", "LaBr1D");
-                FillHistDetector1DGammaNR(hist1D, fLaBrArray, "labr_crystal_sup_edep_sum_nr", "0RES_LaBr1D");
+    // 3D gamma-gamma corr - Crystal Method
+    for(size_t firstDet = 0; firstDet < fGriffinCrystal->size(); ++firstDet) {
+        if(fSettings->WriteNDHist()) {
+            // add-back 0 deg hits
+            if(fGriffinCrystal->size()==1) {
+                Double_t fillval[3] = {fGriffinCrystal->at(0).Energy(), fGriffinCrystal->at(0).Energy(),0.0};
+                histND = GetNDHistogram("griffin_crystal_unsup_gamma_gamma_corr_edep_cry_sparse","GriffinND",GriffinCryMapNofCombos);
+                histND->Fill(fillval); //1.0/64);
             }
+            for(size_t secondDet = firstDet+1; secondDet < fGriffinCrystal->size(); ++secondDet) {
+                cry1energy  = fGriffinCrystal->at(firstDet).Energy();
+                cry1        = fGriffinCrystal->at(firstDet).CrystalId();
+                cry2energy  = fGriffinCrystal->at(secondDet).Energy();
+                cry2        = fGriffinCrystal->at(secondDet).CrystalId();
+                angle = GriffinCryMap[(int)((4*fGriffinCrystal->at(firstDet).DetectorId())+fGriffinCrystal->at(firstDet).CrystalId())][(int)((4*fGriffinCrystal->at(secondDet).DetectorId())+fGriffinCrystal->at(secondDet).CrystalId())];
+                index = GriffinCryMapIndex[(int)((4*fGriffinCrystal->at(firstDet).DetectorId())+fGriffinCrystal->at(firstDet).CrystalId())][(int)((4*fGriffinCrystal->at(secondDet).DetectorId())+fGriffinCrystal->at(secondDet).CrystalId())];
+                norm = GriffinCryMapCombos[index][1];
+                if(cry1energy == 0 || cry2energy == 0 || norm == 0) {
+                    std::cout << "error, didn't find something" << std::endl;
+                    std::cout << "cry1energy = " << cry1energy << std::endl;
+                    std::cout << "cry2energy = " << cry2energy << std::endl;
+                    std::cout << "norm = " << norm << std::endl;
+                    std::cout << "angle = " << angle << std::endl;
+                }
+                Double_t fillval2[3] = {fGriffinCrystal->at(firstDet).Energy(), fGriffinCrystal->at(secondDet).Energy(),(double)index};
+                Double_t fillval3[3] = {fGriffinCrystal->at(secondDet).Energy(), fGriffinCrystal->at(firstDet).Energy(),(double)index};
+                histND = GetNDHistogram("griffin_crystal_unsup_gamma_gamma_corr_edep_cry_sparse","GriffinND",GriffinCryMapNofCombos);
+                histND->Fill(fillval2); //1.0/64);
+                histND->Fill(fillval3); //1.0/64);
+                cry1 = 0;
+                cry2 = 0;
+                cry1energy = 0;
+                cry2energy = 0;
+                angle = 0;
+                norm = 0;
+            }
+        }
+    }
 
-            SupressLaBrByNeighbouringGriffinShields();
-
-            FillHistDetector1DGamma(hist1D, fLaBrDetector, "labr_crystal_griffinneighsup_edep", "LaBr1D");
-            FillHistDetector1DGammaNR(hist1D, fLaBrDetector, "labr_crystal_griffinneighsup_edep_nr", "0RES_LaBr1D");
 
-            if(fAncillaryBgoCrystal->size() == 0) {
-                FillHistDetector1DGamma(hist1D, fLaBrArray, "labr_crystal_griffinneighsup_edep_sum", "LaBr1D");
-                FillHistDetector1DGammaNR(hist1D, fLaBrArray, "labr_crystal_griffinneighsup_edep_sum_nr", "0RES_LaBr1D");
+    // 3D gamma-gamma corr - Detector Method
+    for(size_t firstDet = 0; firstDet < fGriffinDetector->size(); ++firstDet) {
+        if(fSettings->WriteNDHist()) {
+            // add-back 0 deg hits
+            if(fGriffinDetector->size()==1) {
+                Double_t fillvalab[3] = {fGriffinDetector->at(0).Energy(), fGriffinDetector->at(0).Energy(),0.0};
+                histND = GetNDHistogram("griffin_crystal_unsup_gamma_gamma_corr_edep_det_sparse","GriffinND",GriffinDetMapNofCombos);
+                histND->Fill(fillvalab); //1.0/64);
+            }
+            for(size_t secondDet = firstDet+1; secondDet < fGriffinDetector->size(); ++secondDet) {
+                det1        = fGriffinDetector->at(firstDet).DetectorId();
+                det2        = fGriffinDetector->at(secondDet).DetectorId();
+                det1energy  = fGriffinDetector->at(firstDet).Energy();
+                det2energy  = fGriffinDetector->at(secondDet).Energy();
+                angle = GriffinDetMap[(int)((fGriffinDetector->at(firstDet).DetectorId()))][(int)((fGriffinDetector->at(secondDet).DetectorId()))];
+                index = GriffinDetMapIndex[(int)((fGriffinDetector->at(firstDet).DetectorId()))][(int)((fGriffinDetector->at(secondDet).DetectorId()))];
+                norm = GriffinDetMapCombos[index][1];
+                if(det1energy == 0 || det2energy == 0 || norm == 0) {
+                    std::cout << "error, didn't find something" << std::endl;
+                    std::cout << "det1energy = " << det1energy << std::endl;
+                    std::cout << "det2energy = " << det2energy << std::endl;
+                    std::cout << "det1 = " << det1 << std::endl;
+                    std::cout << "det2 = " << det2 << std::endl;
+                    std::cout << "norm = " << norm << std::endl;
+                    std::cout << "angle = " << angle << std::endl;
+                }
+                Double_t fillval2ab[3] = {fGriffinDetector->at(firstDet).Energy(), fGriffinDetector->at(secondDet).Energy(),(double)index};
+                Double_t fillval3ab[3] = {fGriffinDetector->at(secondDet).Energy(), fGriffinDetector->at(firstDet).Energy(),(double)index};
+                histND = GetNDHistogram("griffin_crystal_unsup_gamma_gamma_corr_edep_det_sparse","GriffinND",GriffinDetMapNofCombos);
+                histND->Fill(fillval2ab); //1.0/64);
+                histND->Fill(fillval3ab); //1.0/64);
+                det1 = 0;
+                det2 = 0;
+                det1energy = 0;
+                det2energy = 0;
+                angle = 0;
+                norm = 0;
             }
+        }
+    }
+
+
 
-            if(fGriffinBgo->size() == 0 ) {
-                FillHistDetector1DGamma(hist1D, fLaBrDetector, "labr_crystal_griffinanysup_edep", "LaBr1D");
-                FillHistDetector1DGammaNR(hist1D, fLaBrDetector, "labr_crystal_anygriffinsup_edep_nr", "0RES_LaBr1D");
-                if(fAncillaryBgoCrystal->size() == 0 ) {
-                    FillHistDetector1DGamma(hist1D, fLaBrArray, "labr_crystal_griffinanysup_edep_sum", "LaBr1D");
-                    FillHistDetector1DGammaNR(hist1D, fLaBrArray, "labr_crystal_anygriffinsup_edep_sum_nr", "0RES_LaBr1D");
+    // 3D gamma-gamma corr - Add-back Method
+    for(size_t firstDet = 0; firstDet < fGriffinDetector->size(); ++firstDet) {
+        if(fSettings->WriteNDHist()) {
+            cry1 = 0;
+            cry2 = 0;
+            cry1energy = 0;
+            cry2energy = 0;
+            angle = 0;
+            norm = 0;
+            // add-back 0 deg hits - if there's only one detector, then all the interactions are added back to a zero-degree summed hit
+            if(fGriffinDetector->size()==1) {
+               Double_t fillvalabn[3] = {fGriffinDetector->at(0).Energy(), fGriffinDetector->at(0).Energy(),0.0};
+               histND = GetNDHistogram("griffin_crystal_unsup_gamma_gamma_corr_edep_cry_addback_sparse","GriffinND",GriffinCryMapNofCombos);
+               histND->Fill(fillvalabn); //1.0/64);
+            } // done 0 deg hits
+            else { // we have interactions in multiple detectors!
+                // iterate over summed detector energies
+                for(size_t secondDet = firstDet+1; secondDet < fGriffinDetector->size(); ++secondDet) {
+                    for(size_t thiscry = 0; thiscry < fGriffinCrystal->size(); ++thiscry) { // iterate over all interactions
+                         // if this interaction occurred in the first detector...
+                        if(fGriffinCrystal->at(thiscry).DetectorId() == fGriffinDetector->at(firstDet).DetectorId() ) {
+                            //...then compare with cry1energy...
+                            if(fGriffinCrystal->at(thiscry).Energy() > cry1energy){
+                               //...and if the new energy is larger, set the crystal 1 ID and the energy.
+                                cry1energy  = fGriffinCrystal->at(thiscry).Energy();
+                                cry1        = fGriffinCrystal->at(thiscry).CrystalId();
+                            }
+                        }
+                         // if this interaction occurred in the second detector...
+                        if(fGriffinCrystal->at(thiscry).DetectorId() == fGriffinDetector->at(secondDet).DetectorId() ) {
+                            //...then compare with cry2energy...
+                            if(fGriffinCrystal->at(thiscry).Energy() > cry2energy){
+                               //...and if the new energy is larger, set the crystal 2 ID and the energy.
+                                cry2energy  = fGriffinCrystal->at(thiscry).Energy();
+                                cry2        = fGriffinCrystal->at(thiscry).CrystalId();
+                            }
+                        }
+                    }
+                    angle = GriffinCryMap[(int)((4*fGriffinDetector->at(firstDet).DetectorId())+cry1)][(int)((4*fGriffinDetector->at(secondDet).DetectorId())+cry2)];
+                    index = GriffinCryMapIndex[(int)((4*fGriffinDetector->at(firstDet).DetectorId())+cry1)][(int)((4*fGriffinDetector->at(secondDet).DetectorId())+cry2)];
+                    norm = GriffinCryMapCombos[index][1];
+                    if(cry1energy == 0 || cry2energy == 0 || norm == 0) {
+										 std::cout << "error, didn't find something" << std::endl;
+										 std::cout << "cry1energy = " << cry1energy << std::endl;
+										 std::cout << "cry2energy = " << cry2energy << std::endl;
+										 std::cout << "norm = " << norm << std::endl;
+										 std::cout << "angle = " << angle << std::endl;
+                    }
+                    Double_t fillval2abn[3] = {fGriffinDetector->at(firstDet).Energy(), fGriffinDetector->at(secondDet).Energy(),(double)index};
+                    Double_t fillval3abn[3] = {fGriffinDetector->at(secondDet).Energy(), fGriffinDetector->at(firstDet).Energy(),(double)index};
+                    histND = GetNDHistogram("griffin_crystal_unsup_gamma_gamma_corr_edep_cry_addback_sparse","GriffinND",GriffinCryMapNofCombos);
+                    histND->Fill(fillval2abn); //1.0/64);
+                    histND->Fill(fillval3abn); //1.0/64);
+                    cry1 = 0;
+                    cry2 = 0;
+                    cry1energy = 0;
+                    cry2energy = 0;
+                    angle = 0;
+                    norm = 0;
                 }
             }
+        }
+    }
 
+    // Neighbours
+    FillHistDetector1DGamma(hist1D, fGriffinNeighbour, "griffin_crystal_unsup_edep_neigh", "Griffin1D");
+    FillHistDetector1DGammaNR(hist1D, fGriffinNeighbour, "griffin_crystal_unsup_edep_neigh_nr", "0RES_Griffin1D");
 
-            // EightPi3
-            // Unsuppressed
-            FillHistDetector1DGamma(hist1D, fEightPiDetector, "EightPi_crystal_unsup_edep", "EightPi1D");
-            FillHistDetector1DGammaNR(hist1D, fEightPiDetector, "EightPi_crystal_unsup_edep_nr", "0RES_EightPi1D");
+    if(fSceptarHit) {
+        FillHistDetector1DGamma(hist1D, fGriffinNeighbour, "griffin_crystal_unsup_sceptar_coin_edep_neigh", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinNeighbour, "griffin_crystal_unsup_sceptar_coin_edep_neigh_nr", "0RES_Griffin1D");
+    } else {
+        FillHistDetector1DGamma(hist1D, fGriffinNeighbour, "griffin_crystal_unsup_sceptar_anticoin_edep_neigh", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinNeighbour, "griffin_crystal_unsup_sceptar_anticoin_edep_neigh_nr", "0RES_Griffin1D");
+    }
 
-            AddbackEightPi();
+    // Neighbours Vectors
+    FillHistDetector1DGamma(hist1D, fGriffinNeighbourVector, "griffin_crystal_unsup_edep_neighvec", "Griffin1D");
+    FillHistDetector1DGammaNR(hist1D, fGriffinNeighbourVector, "griffin_crystal_unsup_edep_neighvec_nr", "0RES_Griffin1D");
 
-            FillHistDetector1DGamma(hist1D, fEightPiArray, "EightPi_crystal_unsup_edep_sum", "EightPi1D");
-            FillHistDetector1DGammaNR(hist1D, fEightPiArray, "EightPi_crystal_unsup_edep_sum_nr", "0RES_EightPi1D");
+    if(fSceptarHit) {
+        FillHistDetector1DGamma(hist1D, fGriffinNeighbourVector, "griffin_crystal_unsup_sceptar_coin_edep_neighvec", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinNeighbourVector, "griffin_crystal_unsup_sceptar_coin_edep_neighvec_nr", "0RES_Griffin1D");
+    } else {
+        FillHistDetector1DGamma(hist1D, fGriffinNeighbourVector, "griffin_crystal_unsup_sceptar_anticoin_edep_neighvec", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinNeighbourVector, "griffin_crystal_unsup_sceptar_anticoin_edep_neighvec_nr", "0RES_Griffin1D");
+    }
 
-            SupressEightPi();
+    FillHistDetector1DGamma(hist1D, fGriffinArray, "griffin_crystal_unsup_edep_sum", "Griffin1D");
+    FillHistDetector1DGammaNR(hist1D, fGriffinArray, "griffin_crystal_unsup_edep_sum_nr", "0RES_Griffin1D");
 
-            FillHistDetector1DGamma(hist1D, fEightPiDetector, "EightPi_crystal_sup_edep", "EightPi1D");
-            FillHistDetector1DGammaNR(hist1D, fEightPiDetector, "EightPi_crystal_sup_edep_nr", "0RES_EightPi1D");
+    // descant coin hits
+    if(descantArrayHits == 0) {
+        FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_unsup_descanthit0_coin_edep_cry", "Griffin1D");
+        FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_unsup_descanthit0_coin_edep", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_unsup_descanthit0_coin_edep_cry_nr", "0RES_Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_unsup_descanthit0_coin_edep_nr", "0RES_Griffin1D");
 
+        FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_unsup_descanthit0_edep_cry_matrix", "Griffin2D");
+        FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_unsup_descanthit0_edep_matrix", "Griffin2D");
+        FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_unsup_descanthit0_edep_cry_matrix_nr", "0RES_Griffin2D");
+        FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_unsup_descanthit0_edep_matrix_nr", "0RES_Griffin2D");
 
-            // SCEPTAR
-            FillHistDetector1DGamma(hist1D, fSceptarDetector, "sceptar_crystal_unsup_edep", "Sceptar1D");
-            FillHistDetector1DGammaNR(hist1D, fSceptarDetector, "sceptar_crystal_unsup_edep_nr", "0RES_Sceptar1D");
+    }
+    else if(descantArrayHits == 1) {
+        FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_unsup_descanthit1_coin_edep_cry", "Griffin1D");
+        FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_unsup_descanthit1_coin_edep", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_unsup_descanthit1_coin_edep_cry_nr", "0RES_Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_unsup_descanthit1_coin_edep_nr", "0RES_Griffin1D");
+
+        FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_unsup_descanthit1_edep_cry_matrix", "Griffin2D");
+        FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_unsup_descanthit1_edep_matrix", "Griffin2D");
+        FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_unsup_descanthit1_edep_cry_matrix_nr", "0RES_Griffin2D");
+        FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_unsup_descanthit1_edep_matrix_nr", "0RES_Griffin2D");
+    }
+    else if(descantArrayHits == 2) {
+        FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_unsup_descanthit2_coin_edep_cry", "Griffin1D");
+        FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_unsup_descanthit2_coin_edep", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_unsup_descanthit2_coin_edep_cry_nr", "0RES_Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_unsup_descanthit2_coin_edep_nr", "0RES_Griffin1D");
+
+        FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_unsup_descanthit2_edep_cry_matrix", "Griffin2D");
+        FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_unsup_descanthit2_edep_matrix", "Griffin2D");
+        FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_unsup_descanthit2_edep_cry_matrix_nr", "0RES_Griffin2D");
+        FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_unsup_descanthit2_edep_matrix_nr", "0RES_Griffin2D");
+    }
+    else {
+        FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_unsup_descanthitn_coin_edep_cry", "Griffin1D");
+        FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_unsup_descanthitn_coin_edep", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_unsup_descanthitn_coin_edep_cry_nr", "0RES_Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_unsup_descanthitn_coin_edep_nr", "0RES_Griffin1D");
+
+        FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_unsup_descanthitn_edep_cry_matrix", "Griffin2D");
+        FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_unsup_descanthitn_edep_matrix", "Griffin2D");
+        FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_unsup_descanthitn_edep_cry_matrix_nr", "0RES_Griffin2D");
+        FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_unsup_descanthitn_edep_matrix_nr", "0RES_Griffin2D");
+    }
 
-            AddbackSceptar();
 
-            FillHistDetector1DGamma(hist1D, fSceptarArray, "sceptar_crystal_unsup_edep_sum", "Sceptar1D");
-            FillHistDetector1DGammaNR(hist1D, fSceptarArray, "sceptar_crystal_unsup_edep_sum_nr", "0RES_Sceptar1D");
+    //---------------------------------------------------------------------
+    // Suppressed GRIFFIN
+    //---------------------------------------------------------------------
+    // The clover addback only depends on the crystals of the same detector and the suppression
+    // vetoes whole detectors, so we can just drop the vetoed crystals and clovers.
+    // The array, neighbour, and vector addback have to be redone, but only if anything was vetoed.
+    if(GriffinVetoed(kGriffinBgoVeto)) {
+        SupressGriffin();
+        RemoveVetoed(fGriffinDetector, kGriffinBgoVeto);
+        fGriffinNeighbour->clear();
+        fGriffinNeighbourVector->clear();
+        fGriffinArray->clear();
+        AddbackGriffinArray();
+        AddbackGriffinNeighbour();
+        if(fSettings->WriteGriffinAddbackVector())
+            AddbackGriffinNeighbourVector();
+    }
 
+    //-------------------- crystal histograms
+    //multiplicity histogram
+    hist1D = Get1DHistogram("GriffinCrystalMultiplicitySup","Statistics");
+    hist1D->Fill(fGriffinCrystal->size());
+    hist1D = Get1DHistogram("GriffinDetectorMultiplicitySup","Statistics");
+    hist1D->Fill(fGriffinDetector->size());
 
-            // DESCANT
-            FillHistDetector1DGamma(hist1D, fDescantBlueDetector, "descant_blue_scin_unsup_edep", "Descant1D");
-            FillHistDetector1DGammaNR(hist1D, fDescantBlueDetector, "descant_blue_scin_unsup_edep_nr", "0RES_Descant1D");
-            FillHistDetector1DGamma(hist1D, fDescantGreenDetector, "descant_green_scin_unsup_edep", "Descant1D");
-            FillHistDetector1DGammaNR(hist1D, fDescantGreenDetector, "descant_green_scin_unsup_edep_nr", "0RES_Descant1D");
-            FillHistDetector1DGamma(hist1D, fDescantRedDetector, "descant_red_scin_unsup_edep", "Descant1D");
-            FillHistDetector1DGammaNR(hist1D, fDescantRedDetector, "descant_red_scin_unsup_edep_nr", "0RES_Descant1D");
-            FillHistDetector1DGamma(hist1D, fDescantWhiteDetector, "descant_white_scin_unsup_edep", "Descant1D");
-            FillHistDetector1DGammaNR(hist1D, fDescantWhiteDetector, "descant_white_scin_unsup_edep_nr", "0RES_Descant1D");
-            FillHistDetector1DGamma(hist1D, fDescantYellowDetector, "descant_yellow_scin_unsup_edep", "Descant1D");
-            FillHistDetector1DGammaNR(hist1D, fDescantYellowDetector, "descant_yellow_scin_unsup_edep_nr", "0RES_Descant1D");
+    // GRIFFIN Crystal
+    FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_sup_edep_cry", "Griffin1D");
+    FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_sup_edep_cry_nr", "0RES_Griffin1D");
 
-            AddbackDescant();
+    FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_sup_edep_cry_matrix", "Griffin2D");
+    FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_sup_edep_cry_matrix_nr", "0RES_Griffin2D");
 
-            FillHistDetector1DGamma(hist1D, fDescantArray, "descant_array_scin_unsup_edep_sum", "Descant1D");
-            FillHistDetector1DGammaNR(hist1D, fDescantArray, "descant_array_scin_unsup_edep_sum_nr", "0RES_Descant1D");
+    if(fGriffinBgo->size() == 0 && fGriffinBgoBack->size() == 0) {
+        FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_arraysup_edep_cry", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_arraysup_edep_cry_nr", "0RES_Griffin1D");
 
-            // Testcan
-            FillHistDetector1DGamma(hist1D, fTestcanDetector, "testcan_scin_unsup_edep", "Testcan1D");
-            FillHistDetector1DGammaNR(hist1D, fTestcanDetector, "testcan_scin_unsup_edep_nr", "0RES_Testcan1D");
+        FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_arraysup_edep_cry_matrix","Griffin2D");
+        FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_arraysup_edep_cry_matrix_nr","0RES_Griffin2D");
+    }
 
-            // Paces
-            FillHistDetector1DGamma(hist1D, fPacesDetector, "paces_crystal_unsup_edep", "Paces1D");
-            FillHistDetector1DGammaNR(hist1D, fPacesDetector, "paces_crystal_unsup_edep_nr", "0RES_Paces1D");
+    // GRIFFIN Detector / Clover
+    FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_sup_edep", "Griffin1D");
+    FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_sup_edep_nr", "0RES_Griffin1D");
+
+    if(fSceptarHit) {
+        FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_sup_sceptar_coin_edep", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_sup_sceptar_coin_edep_nr", "0RES_Griffin1D");
+        FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_sup_sceptar_coin_edep_cry", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_sup_sceptar_coin_edep_cry_nr", "0RES_Griffin1D");
+        if(fSettings->Write2DSGGHist()) {
+            FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_sup_sceptar_coin_edep_matrix","Griffin2D");
+            FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_sup_sceptar_coin_edep_matrix_nr","0RES_Griffin2D");
+            FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_sup_sceptar_coin_edep_cry_matrix","Griffin2D");
+            FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_sup_sceptar_coin_edep_cry_matrix_nr","0RES_Griffin2D");
+        }
+    } else {
+        FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_sup_sceptar_anticoin_edep", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_sup_sceptar_anticoin_edep_nr", "0RES_Griffin1D");
+        FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_sup_sceptar_anticoin_edep_cry", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_sup_sceptar_anticoin_edep_cry_nr", "0RES_Griffin1D");
+        if(fSettings->Write2DSGGHist()) {
+            FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_sup_sceptar_anticoin_edep_matrix","Griffin2D");
+            FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_sup_sceptar_anticoin_edep_matrix_nr","0RES_Griffin2D");
+            FillHistDetector2DGammaGamma(hist2D, fGriffinCrystal, "griffin_crystal_sup_sceptar_anticoin_edep_cry_matrix","Griffin2D");
+            FillHistDetector2DGammaGammaNR(hist2D, fGriffinCrystal, "griffin_crystal_sup_sceptar_anticoin_edep_cry_matrix_nr","0RES_Griffin2D");
 
-            AddbackPaces();
+        }
+    }
 
-            FillHistDetector1DGamma(hist1D, fPacesArray, "paces_crystal_unsup_edep_sum", "Paces1D");
-            FillHistDetector1DGammaNR(hist1D, fPacesArray, "paces_crystal_unsup_edep_sum_nr", "0RES_Paces1D");
+    FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_sup_edep_matrix","Griffin2D");
+    FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_sup_edep_matrix_nr","0RES_Griffin2D");
 
-            // TI-STAR
-            FillHistDetector1DGamma(hist1D, fTISTARArray, "TISTAR_array_unsup_edep", "TISTAR1D");
-            FillHistDetector1DGammaNR(hist1D, fTISTARArray, "TISTAR_array_unsup_edep_nr", "0RES_TISTAR1D");
-            FillHistDetector1DGamma(hist1D, fTISTARLayer1, "TISTAR_layer1_unsup_edep", "TISTAR1D");
-            FillHistDetector1DGammaNR(hist1D, fTISTARLayer1, "TISTAR_layer1_unsup_edep_nr", "0RES_TISTAR1D");
-            FillHistDetector1DGamma(hist1D, fTISTARLayer2, "TISTAR_layer2_unsup_edep", "TISTAR1D");
-            FillHistDetector1DGammaNR(hist1D, fTISTARLayer2, "TISTAR_layer2_unsup_edep_nr", "0RES_TISTAR1D");
-            FillHistDetector1DGamma(hist1D, fTISTARLayer3, "TISTAR_layer3_unsup_edep", "TISTAR1D");
-            FillHistDetector1DGammaNR(hist1D, fTISTARLayer3, "TISTAR_layer3_unsup_edep_nr", "0RES_TISTAR1D");
 
+    // Neighbours
+    FillHistDetector1DGamma(hist1D, fGriffinNeighbour, "griffin_crystal_sup_edep_neigh", "Griffin1D");
+    FillHistDetector1DGammaNR(hist1D, fGriffinNeighbour, "griffin_crystal_sup_edep_neigh_nr", "0RES_Griffin1D");
 
-            fGriffinCrystal->clear();
-            fGriffinDetector->clear();
-            fGriffinNeighbour->clear();
-            fGriffinNeighbourVector->clear();
-            fGriffinArray->clear();
-            fGriffinBgo->clear();
-            fGriffinBgoBack->clear();
+    if(fSceptarHit) {
+        FillHistDetector1DGamma(hist1D, fGriffinNeighbour, "griffin_crystal_sup_sceptar_coin_edep_neigh", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinNeighbour, "griffin_crystal_sup_sceptar_coin_edep_neigh_nr", "0RES_Griffin1D");
+    } else {
+        FillHistDetector1DGamma(hist1D, fGriffinNeighbour, "griffin_crystal_sup_sceptar_anticoin_edep_neigh", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinNeighbour, "griffin_crystal_sup_sceptar_anticoin_edep_neigh_nr", "0RES_Griffin1D");
+    }
 
-            fLaBrDetector->clear();
-            fLaBrArray->clear();
+    // Neighbours Vectors
+    FillHistDetector1DGamma(hist1D, fGriffinNeighbourVector, "griffin_crystal_sup_edep_neighvec", "Griffin1D");
+    FillHistDetector1DGammaNR(hist1D, fGriffinNeighbourVector, "griffin_crystal_sup_edep_neighvec_nr", "0RES_Griffin1D");
 
-            fAncillaryBgoCrystal->clear();
-            fAncillaryBgoDetector->clear();
-            fAncillaryBgoArray->clear();
+    if(fSceptarHit) {
+        FillHistDetector1DGamma(hist1D, fGriffinNeighbourVector, "griffin_crystal_sup_sceptar_coin_edep_neighvec", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinNeighbourVector, "griffin_crystal_sup_sceptar_coin_edep_neighvec_nr", "0RES_Griffin1D");
+    } else {
+        FillHistDetector1DGamma(hist1D, fGriffinNeighbourVector, "griffin_crystal_sup_sceptar_anticoin_edep_neighvec", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinNeighbourVector, "griffin_crystal_sup_sceptar_anticoin_edep_neighvec_nr", "0RES_Griffin1D");
+    }
 
-            fEightPiDetector->clear();
-            fEightPiBgoDetector->clear();
-            fEightPiArray->clear();
+    // GRIFFIN Detector / Clover
+    if(fGriffinBgo->size() == 0 && fGriffinBgoBack->size() == 0) {
+        FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_arraysup_edep", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_arraysup_edep_nr", "0RES_Griffin1D");
 
-            fSceptarDetector->clear();
-            fSceptarArray->clear();
+        FillHistDetector2DGammaGamma(hist2D, fGriffinDetector, "griffin_crystal_arraysup_edep_matrix","Griffin2D");
+        FillHistDetector2DGammaGammaNR(hist2D, fGriffinDetector, "griffin_crystal_arraysup_edep_matrix_nr","0RES_Griffin2D");
+    }
 
-            fDescantArray->clear();
-            fDescantBlueDetector->clear();
-            fDescantGreenDetector->clear();
-            fDescantRedDetector->clear();
-            fDescantWhiteDetector->clear();
-            fDescantYellowDetector->clear();
+    FillHistDetector1DGamma(hist1D, fGriffinArray, "griffin_crystal_sup_edep_sum", "Griffin1D");
+    FillHistDetector1DGammaNR(hist1D, fGriffinArray, "griffin_crystal_sup_edep_sum_nr", "0RES_Griffin1D");
 
-            fTestcanDetector->clear();
+    if(fGriffinBgo->size() == 0 && fGriffinBgoBack->size() == 0 ) {
+        FillHistDetector1DGamma(hist1D, fGriffinArray, "griffin_crystal_arraysup_edep_sum", "Griffin1D");
+        FillHistDetector1DGammaNR(hist1D, fGriffinArray, "griffin_crystal_arraysup_edep_sum_nr", "0RES_Griffin1D");
+    }
 
-            fPacesDetector->clear();
-            fPacesArray->clear();
 
-            fTISTARArray->clear();
-            fTISTARLayer1->clear();            
-            fTISTARLayer2->clear();            
-            fTISTARLayer3->clear();            
+    // SUPPRESSED GRIFFIN with Ancillary Detectors too
+    // the crystals and clovers are already bgo suppressed, we just skip the ones vetoed by the ancillary bgos
+    FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_ancillaryneighsup_edep_cry", "Griffin1D", kGriffinAncillaryBgoVeto);
+    FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_ancillaryneighsup_edep_cry_nr", "0RES_Griffin1D", kGriffinAncillaryBgoVeto);
 
-            belowThreshold.clear();
-            outsideTimeWindow.clear();
+    FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_ancillaryneighsup_edep", "Griffin1D", kGriffinAncillaryBgoVeto);
+    FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_ancillaryneighsup_edep_nr", "0RES_Griffin1D", kGriffinAncillaryBgoVeto);
 
-            fSceptarHit = false;
-         
-            
-            // re-set this at the end, as we need the previous hit event number to get
-            // the correct entry in the generator tree
-            eventNumber = fEventNumber;
-        }
+    // SUPPRESSED GRIFFIN with SCEPTAR too (on top of the ancillary bgo suppression)
+    FillHistDetector1DGamma(hist1D, fGriffinCrystal, "griffin_crystal_sceptarsup_edep_cry", "Griffin1D", kGriffinAncillaryBgoVeto | kGriffinSceptarVeto);
+    FillHistDetector1DGammaNR(hist1D, fGriffinCrystal, "griffin_crystal_sceptarsup_edep_cry_nr", "0RES_Griffin1D", kGriffinAncillaryBgoVeto | kGriffinSceptarVeto);
 
-        if(fSettings->VerbosityLevel() > 1) {
-            std::cout<<"Entry: "<<i<<", Event: "<<fEventNumber<<", Track: "<<fTrackID<<", Det: "<<fDetNumber<<", Cry: "
-                     <<fCryNumber<<", Edep: "<<fDepEnergy<<"keV, ParticleID: "<<fParticleType<<", (x,y,z) = ("
-                     <<fPosx<<", "<<fPosy<<", "<<fPosz<<" )"<<std::endl;
-        }
+    FillHistDetector1DGamma(hist1D, fGriffinDetector, "griffin_crystal_sceptarsup_edep", "Griffin1D", kGriffinAncillaryBgoVeto | kGriffinSceptarVeto);
+    FillHistDetector1DGammaNR(hist1D, fGriffinDetector, "griffin_crystal_sceptarsup_edep_nr", "0RES_Griffin1D", kGriffinAncillaryBgoVeto | kGriffinSceptarVeto);
+}
 
-        // if fSystemID is NOT GRIFFIN, then set fCryNumber to zero
-        // This is a quick fix to solve resolution and threshold values from Settings.cc
-        // Modified to include TI-STAR, which does use the systemID
-        if(fSystemID >= 2000 && fSystemID != 9500) {
-            fCryNumber = 0;
-        }
+void Converter::FillLaBrHistograms() {
+    TH1F* hist1D = nullptr;
+    // LaBr3
+    // Unsuppressed
+    FillHistDetector1DGamma(hist1D, fLaBrDetector, "labr_crystal_unsup_edep", "LaBr1D");
+    FillHistDetector1DGammaNR(hist1D, fLaBrDetector, "labr_crystal_unsup_edep_nr", "0RES_LaBr1D");
 
-        // if fSystemID is TISTAR, decrement the detector and crystal number 
-        // this is to solve the numbering problem of the layers/strips, which both
-        // start at 1, vs. the vector index which starts at 0
-        if(fSystemID == 9500) {
-            fDetNumber -= 1;
-            fCryNumber -= 1;
-        }
+    AddbackLaBr();
 
-        // adding up ti-star hits (checking to see if we have more than 1 in a given strip/ring)
-        FillTistarVectors();
+    FillHistDetector1DGamma(hist1D, fLaBrArray, "labr_crystal_unsup_edep_sum", "LaBr1D");
+    FillHistDetector1DGammaNR(hist1D, fLaBrArray, "labr_crystal_unsup_edep_sum_nr", "0RES_LaBr1D");
 
-        //create energy-resolution smeared energy
-        smearedEnergy = fRandom.Gaus(fDepEnergy,fSettings->Resolution(fSystemID,fDetNumber,fCryNumber,fDepEnergy));
-        //std::cout << "fDepEnergy= "<<fDepEnergy<<
-        //             ", smearedEnergy= "<<smearedEnergy<<
-        //             ", fSystemID= "<<fSystemID<<
-        //             ", fDetNumber= "<<fDetNumber<<
-        //             ", fCryNumber= "<<fCryNumber<<std::endl;
-
-        if((fSettings->SortNumberOfEvents()==0)||(fSettings->SortNumberOfEvents()>=fEventNumber) ) {
-            //if the hit is above the threshold, we add it to the vector
-            if(AboveThreshold(smearedEnergy, fSystemID)) {
-                if(InsideTimeWindow() ) {
-                    switch(fSystemID) {
-                    case 1000:
-                        fGriffinCrystal->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy, smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                        break;
-                    case 1010:
-                    case 1020:
-                    case 1030:
-                    case 1040:
-                        fGriffinBgo->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy, smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                        break;
-                    case 1050:
-                        fGriffinBgoBack->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy, smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                        break;
-                    case 2000:
-                        fLaBrDetector->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy, smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                        break;
-                    case 3000:
-                        fAncillaryBgoCrystal->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy, smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                        break;
-                    case 5000:
-                        fSceptarDetector->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy, smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                        fSceptarHit = true;
-                        break;
-                    case 6000:
-                        fEightPiDetector->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy, smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                        break;
-                    case 6010:
-                    case 6020:
-                    case 6030:
-                        fEightPiBgoDetector->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy, smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                        break;
-                    case 8010:
-                        fDescantBlueDetector->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy, smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                         break;
-                    case 8020:
-                        fDescantGreenDetector->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy, smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                        break;
-                    case 8030:
-                        fDescantRedDetector->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy, smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                        break;
-                    case 8040:
-                        //fDescantWhiteDetector->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy, smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                        //fDescantWhiteDetector->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fEDepD, deuteronSmearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                        //fDescantWhiteDetector->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fEDepC+fEDepD , carbonSmearedEnergy+deuteronSmearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                        fDescantWhiteDetector->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy , smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                        break;
-                    case 8050:
-                        fDescantYellowDetector->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy, smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                        break;
-
-                    case 8500:
-                        fTestcanDetector->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy, smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                    break;
+    AddbackAncillaryBgo();
+    SupressLaBr();
 
-                    case 9000:
-                        fPacesDetector->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy, smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                        break;
-                    
-                    case 9500:
-                        fTISTARArray->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy, smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                        switch(fDetNumber) {
-                            case 0: fTISTARLayer1->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy, smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                                    break;
-                            case 1: fTISTARLayer2->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy, smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                                    break;
-                            case 2: fTISTARLayer3->push_back(Detector(fEventNumber, fDetNumber, fCryNumber, fDepEnergy, smearedEnergy, TVector3(fPosx,fPosy,fPosz), fTime));
-                                    break;
-                        }
-                        break;
+    FillHistDetector1DGamma(hist1D, fLaBrDetector, "labr_crystal_sup_edep", "LaBr1D");
+    FillHistDetector1DGammaNR(hist1D, fLaBrDetector, "labr_crystal_sup_edep_nr", "0RES_LaBr1D");
 
-                    default:
-                        std::cerr<<"Unknown detector system ID "<<fSystemID<<std::endl;
-                        break;
-                    }
-                } else {
-                    ++outsideTimeWindow[fSystemID];
-                }
-            } else {
-                ++belowThreshold[fSystemID];
-            }
-        }
+    if(fAncillaryBgoCrystal->size() == 0) {
+        FillHistDetector1DGamma(hist1D, fLaBrArray, "labr_crystal_sup_edep_sum", "LaBr1D");
+        FillHistDetector1DGammaNR(hist1D, fLaBrArray, "labr_crystal_sup_edep_sum_nr", "0RES_LaBr1D");
+    }
 
-        if(i%1000 == 0 && fSettings->VerbosityLevel() > 0) {
-            std::cout<<std::setw(3)<<100*i/nEntries<<"% done\r"<<std::flush;
+    SupressLaBrByNeighbouringGriffinShields();
+
+    FillHistDetector1DGamma(hist1D, fLaBrDetector, "labr_crystal_griffinneighsup_edep", "LaBr1D");
+    FillHistDetector1DGammaNR(hist1D, fLaBrDetector, "labr_crystal_griffinneighsup_edep_nr", "0RES_LaBr1D");
+
+    if(fAncillaryBgoCrystal->size() == 0) {
+        FillHistDetector1DGamma(hist1D, fLaBrArray, "labr_crystal_griffinneighsup_edep_sum", "LaBr1D");
+        FillHistDetector1DGammaNR(hist1D, fLaBrArray, "labr_crystal_griffinneighsup_edep_sum_nr", "0RES_LaBr1D");
+    }
+
+    if(fGriffinBgo->size() == 0 ) {
+        FillHistDetector1DGamma(hist1D, fLaBrDetector, "labr_crystal_griffinanysup_edep", "LaBr1D");
+        FillHistDetector1DGammaNR(hist1D, fLaBrDetector, "labr_crystal_anygriffinsup_edep_nr", "0RES_LaBr1D");
+        if(fAncillaryBgoCrystal->size() == 0 ) {
+            FillHistDetector1DGamma(hist1D, fLaBrArray, "labr_crystal_griffinanysup_edep_sum", "LaBr1D");
+            FillHistDetector1DGammaNR(hist1D, fLaBrArray, "labr_crystal_anygriffinsup_edep_sum_nr", "0RES_LaBr1D");
         }
     }
+}
 
-    if(fSettings->VerbosityLevel() > 0) {
-        std::cout<<"100% done"<<std::endl;
+void Converter::FillEightPiHistograms() {
+    TH1F* hist1D = nullptr;
+    // EightPi3
+    // Unsuppressed
+    FillHistDetector1DGamma(hist1D, fEightPiDetector, "EightPi_crystal_unsup_edep", "EightPi1D");
+    FillHistDetector1DGammaNR(hist1D, fEightPiDetector, "EightPi_crystal_unsup_edep_nr", "0RES_EightPi1D");
 
-        if(fSettings->VerbosityLevel() > 1) {
-            PrintStatistics();
-        }
+    AddbackEightPi();
+
+    FillHistDetector1DGamma(hist1D, fEightPiArray, "EightPi_crystal_unsup_edep_sum", "EightPi1D");
+    FillHistDetector1DGammaNR(hist1D, fEightPiArray, "EightPi_crystal_unsup_edep_sum_nr", "0RES_EightPi1D");
+
+    SupressEightPi();
+
+    FillHistDetector1DGamma(hist1D, fEightPiDetector, "EightPi_crystal_sup_edep", "EightPi1D");
+    FillHistDetector1DGammaNR(hist1D, fEightPiDetector, "EightPi_crystal_sup_edep_nr", "0RES_EightPi1D");
+}
+
+void Converter::FillSceptarHistograms() {
+    TH1F* hist1D = Get1DHistogram("SceptarDetectorHitPattern","Statistics");
+    for(size_t firstDet = 0; firstDet < fSceptarDetector->size(); ++firstDet) {
+        hist1D->Fill((fSceptarDetector->at(firstDet).DetectorId()));
     }
 
-    return true;
+    // SCEPTAR
+    FillHistDetector1DGamma(hist1D, fSceptarDetector, "sceptar_crystal_unsup_edep", "Sceptar1D");
+    FillHistDetector1DGammaNR(hist1D, fSceptarDetector, "sceptar_crystal_unsup_edep_nr", "0RES_Sceptar1D");
+
+    AddbackSceptar();
+
+    FillHistDetector1DGamma(hist1D, fSceptarArray, "sceptar_crystal_unsup_edep_sum", "Sceptar1D");
+    FillHistDetector1DGammaNR(hist1D, fSceptarArray, "sceptar_crystal_unsup_edep_sum_nr", "0RES_Sceptar1D");
 }
 
-bool Converter::AboveThreshold(double energy, int systemID) {
-    if(systemID == 5000) {
-        // apply hard threshold of 50 keV on Sceptar
-        // SCEPTAR in reality saturates at an efficiency of about 80%. In simulation we get an efficiency of 90%
-        // 0.9 * 1.11111111 = 100%, 0.8*1.1111111 = 0.888888888
-        if(energy > 50.0 && (fRandom.Uniform(0.,1.) < 0.88888888 )) {
-            return true;
-        }
-        else {
-            return false;
-        }
+void Converter::FillDescantHistograms() {
+    TH1F* hist1D = Get1DHistogram("DescantBlueHitPattern","Statistics");
+    for(size_t firstDet = 0; firstDet < fDescantBlueDetector->size(); ++firstDet) {
+        hist1D->Fill((fDescantBlueDetector->at(firstDet).DetectorId()));
     }
-    else if(energy > fSettings->Threshold(fSystemID,fDetNumber,fCryNumber)+10*fSettings->ThresholdWidth(fSystemID,fDetNumber,fCryNumber)) {
-        return true;
+    hist1D = Get1DHistogram("DescantGreenHitPattern","Statistics");
+    for(size_t firstDet = 0; firstDet < fDescantGreenDetector->size(); ++firstDet) {
+        hist1D->Fill((fDescantGreenDetector->at(firstDet).DetectorId()));
     }
-
-    if(fRandom.Uniform(0.,1.) < 0.5*(TMath::Erf((energy-fSettings->Threshold(fSystemID,fDetNumber,fCryNumber))/fSettings->ThresholdWidth(fSystemID,fDetNumber,fCryNumber))+1)) {
-        return true;
+    hist1D = Get1DHistogram("DescantRedHitPattern","Statistics");
+    for(size_t firstDet = 0; firstDet < fDescantRedDetector->size(); ++firstDet) {
+        hist1D->Fill((fDescantRedDetector->at(firstDet).DetectorId()));
+    }
+    hist1D = Get1DHistogram("DescantWhiteHitPattern","Statistics");
+    for(size_t firstDet = 0; firstDet < fDescantWhiteDetector->size(); ++firstDet) {
+        hist1D->Fill((fDescantWhiteDetector->at(firstDet).DetectorId()));
+    }
+    hist1D = Get1DHistogram("DescantYellowHitPattern","Statistics");
+    for(size_t firstDet = 0; firstDet < fDescantYellowDetector->size(); ++firstDet) {
+        hist1D->Fill((fDescantYellowDetector->at(firstDet).DetectorId()));
     }
 
-    return false;
+    // DESCANT
+    FillHistDetector1DGamma(hist1D, fDescantBlueDetector, "descant_blue_scin_unsup_edep", "Descant1D");
+    FillHistDetector1DGammaNR(hist1D, fDescantBlueDetector, "descant_blue_scin_unsup_edep_nr", "0RES_Descant1D");
+    FillHistDetector1DGamma(hist1D, fDescantGreenDetector, "descant_green_scin_unsup_edep", "Descant1D");
+    FillHistDetector1DGammaNR(hist1D, fDescantGreenDetector, "descant_green_scin_unsup_edep_nr", "0RES_Descant1D");
+    FillHistDetector1DGamma(hist1D, fDescantRedDetector, "descant_red_scin_unsup_edep", "Descant1D");
+    FillHistDetector1DGammaNR(hist1D, fDescantRedDetector, "descant_red_scin_unsup_edep_nr", "0RES_Descant1D");
+    FillHistDetector1DGamma(hist1D, fDescantWhiteDetector, "descant_white_scin_unsup_edep", "Descant1D");
+    FillHistDetector1DGammaNR(hist1D, fDescantWhiteDetector, "descant_white_scin_unsup_edep_nr", "0RES_Descant1D");
+    FillHistDetector1DGamma(hist1D, fDescantYellowDetector, "descant_yellow_scin_unsup_edep", "Descant1D");
+    FillHistDetector1DGammaNR(hist1D, fDescantYellowDetector, "descant_yellow_scin_unsup_edep_nr", "0RES_Descant1D");
+
+    AddbackDescant();
+
+    FillHistDetector1DGamma(hist1D, fDescantArray, "descant_array_scin_unsup_edep_sum", "Descant1D");
+    FillHistDetector1DGammaNR(hist1D, fDescantArray, "descant_array_scin_unsup_edep_sum_nr", "0RES_Descant1D");
 }
 
-bool Converter::InsideTimeWindow() {
-    if(fSettings->TimeWindow(fSystemID,fDetNumber,fCryNumber) == 0) {
-        return true;
-    }
-    if(fTime < fSettings->TimeWindow(fSystemID,fDetNumber,fCryNumber)) {
-        return true;
+void Converter::FillTestcanHistograms() {
+    TH1F* hist1D = nullptr;
+    FillHistDetector1DGamma(hist1D, fTestcanDetector, "testcan_scin_unsup_edep", "Testcan1D");
+    FillHistDetector1DGammaNR(hist1D, fTestcanDetector, "testcan_scin_unsup_edep_nr", "0RES_Testcan1D");
+}
+
+void Converter::FillPacesHistograms() {
+    TH1F* hist1D = nullptr;
+    FillHistDetector1DGamma(hist1D, fPacesDetector, "paces_crystal_unsup_edep", "Paces1D");
+    FillHistDetector1DGammaNR(hist1D, fPacesDetector, "paces_crystal_unsup_edep_nr", "0RES_Paces1D");
+
+    AddbackPaces();
+
+    FillHistDetector1DGamma(hist1D, fPacesArray, "paces_crystal_unsup_edep_sum", "Paces1D");
+    FillHistDetector1DGammaNR(hist1D, fPacesArray, "paces_crystal_unsup_edep_sum_nr", "0RES_Paces1D");
+}
+
+void Converter::FillTistarHistograms() {
+    TH1F* hist1D = nullptr;
+    FillHistDetector1DGamma(hist1D, fTISTARArray, "TISTAR_array_unsup_edep", "TISTAR1D");
+    FillHistDetector1DGammaNR(hist1D, fTISTARArray, "TISTAR_array_unsup_edep_nr", "0RES_TISTAR1D");
+    FillHistDetector1DGamma(hist1D, fTISTARLayer1, "TISTAR_layer1_unsup_edep", "TISTAR1D");
+    FillHistDetector1DGammaNR(hist1D, fTISTARLayer1, "TISTAR_layer1_unsup_edep_nr", "0RES_TISTAR1D");
+    FillHistDetector1DGamma(hist1D, fTISTARLayer2, "TISTAR_layer2_unsup_edep", "TISTAR1D");
+    FillHistDetector1DGammaNR(hist1D, fTISTARLayer2, "TISTAR_layer2_unsup_edep_nr", "0RES_TISTAR1D");
+    FillHistDetector1DGamma(hist1D, fTISTARLayer3, "TISTAR_layer3_unsup_edep", "TISTAR1D");
+    FillHistDetector1DGammaNR(hist1D, fTISTARLayer3, "TISTAR_layer3_unsup_edep_nr", "0RES_TISTAR1D");
+}
+
+void Converter::ClassifyGriffin() {
+    // one pass over the fired suppressors, all of them veto whole GRIFFIN detectors
+    ULong64_t bgoFired = DetectorMask(fGriffinBgo) | DetectorMask(fGriffinBgoBack);
+    ULong64_t ancillaryBgoFired = CrystalMask(fAncillaryBgoCrystal, 3);
+    ULong64_t sceptarFired = DetectorMask(fSceptarDetector);
+    fGriffinVetoed = 0;
+    for(int det = 0; det < 16; ++det) {
+        fGriffinVeto[det] = 0;
+        if((bgoFired & (1ULL<<det)) != 0) {
+            fGriffinVeto[det] |= kGriffinBgoVeto;
+        }
+        if((GriffinAncillaryBgoMask[det] & ancillaryBgoFired) != 0) {
+            fGriffinVeto[det] |= kGriffinAncillaryBgoVeto;
+        }
+        if((GriffinSceptarMask[det] & sceptarFired) != 0) {
+            fGriffinVeto[det] |= kGriffinSceptarVeto;
+        }
+        fGriffinVetoed |= fGriffinVeto[det];
     }
-    return false;
 }
 
-bool Converter::DescantNeutronDiscrimination() { // Assuming perfect gamma-neutron discrimination
-    if(fParticleType == 5) { // neutron
-        return true;
+bool Converter::GriffinVetoed(Detector& hit, UInt_t vetoMask) {
+    if(hit.DetectorId() < 0 || hit.DetectorId() >= 16) {
+        return false;
     }
-    return false;
+    return (fGriffinVeto[hit.DetectorId()] & vetoMask) != 0;
 }
 
-
-
-void Converter::CheckGriffinCrystalAddback() {
-// This method checks that all the "crystal" hits are unique, that is, they have different crystal and detector IDs.
-// If they have the same crystal and detector IDs, then we sum the energies together.
-// Normally the Geant4 simulation would sum energy deposits on the same volume, but if we ran the code in "step mode",
-// or if we merged two ntuples together, this would not be true. This method checks and will do what "hit mode" in Geant4 normally does for us!
-    for(auto firstDet = fGriffinCrystal->begin(); firstDet != fGriffinCrystal->end(); ++firstDet) {
-        for(auto secondDet = firstDet+1; secondDet != fGriffinCrystal->end();) {
-            if((firstDet->DetectorId() == secondDet->DetectorId()) && (firstDet->CrystalId() == secondDet->CrystalId())) {
-                firstDet->AddEnergy(secondDet->SimulationEnergy(),secondDet->Energy());
-                secondDet = fGriffinCrystal->erase(secondDet);
-            }
-            else {
-                ++secondDet;
-            }
+void Converter::RemoveVetoed(std::vector<Detector>* detector, UInt_t vetoMask) {
+    // keep only hits that aren't vetoed by any of the conditions in vetoMask, compacting the vector in place
+    if(!GriffinVetoed(vetoMask)) {
+        return;
+    }
+    size_t good = 0;
+    for(size_t i = 0; i < detector->size(); ++i) {
+        if(GriffinVetoed((*detector)[i], vetoMask)) {
+            continue;
         }
+        if(good != i) {
+            (*detector)[good] = (*detector)[i];
+        }
+        ++good;
     }
+    detector->erase(detector->begin()+good, detector->end());
 }
 
+// these rely on ClassifyGriffin having been called for this event
 void Converter::SupressGriffin() {
-    //loop over all bgo's and remove all matching germaniums
-    for(auto bgo = fGriffinBgo->begin(); bgo != fGriffinBgo->end(); ++bgo) {
-        for(auto ge = fGriffinCrystal->begin(); ge != fGriffinCrystal->end();) {
-            if(bgo->DetectorId() == ge->DetectorId()) {
-                ge = fGriffinCrystal->erase(ge);
-            } else {
-                ++ge;
-            }
+    RemoveVetoed(fGriffinCrystal, kGriffinBgoVeto);
+}
+
+ULong64_t Converter::DetectorMask(std::vector<Detector>* detector) {
+    // one bit per fired detector id
+    ULong64_t mask = 0;
+    for(auto hit = detector->begin(); hit != detector->end(); ++hit) {
+        if(hit->DetectorId() >= 0 && hit->DetectorId() < 64) {
+            mask |= 1ULL<<hit->DetectorId();
         }
     }
-    // Now Back Suppressors
-    for(auto bgo = fGriffinBgoBack->begin(); bgo != fGriffinBgoBack->end(); ++bgo) {
-        for(auto ge = fGriffinCrystal->begin(); ge != fGriffinCrystal->end();) {
-            if(bgo->DetectorId() == ge->DetectorId()) {
-                ge = fGriffinCrystal->erase(ge);
-            } else {
-                ++ge;
-            }
+    return mask;
+}
+
+ULong64_t Converter::CrystalMask(std::vector<Detector>* detector, int nofCrystals) {
+    // one bit per fired crystal, bit = nofCrystals*detector + crystal
+    ULong64_t mask = 0;
+    for(auto hit = detector->begin(); hit != detector->end(); ++hit) {
+        if(hit->CrystalId() < 0 || hit->CrystalId() >= nofCrystals) {
+            continue;
+        }
+        int bit = nofCrystals*hit->DetectorId() + hit->CrystalId();
+        if(bit >= 0 && bit < 64) {
+            mask |= 1ULL<<bit;
         }
     }
+    return mask;
 }
 
-void Converter::SupressGriffinByNeighbouringAncillaryBgos() {
-    //loop over all bgo's and remove all matching germaniums
-    for(auto bgo = fAncillaryBgoCrystal->begin(); bgo != fAncillaryBgoCrystal->end(); ++bgo) {
-        for(auto ge = fGriffinCrystal->begin(); ge != fGriffinCrystal->end();) {
-            if(GriffinAncillaryBgoNeighbours_det[ge->DetectorId()][0] == bgo->DetectorId() && GriffinAncillaryBgoNeighbours_cry[ge->DetectorId()][0] == bgo->CrystalId() ) {
-                ge = fGriffinCrystal->erase(ge);
-            }
-            else if(GriffinAncillaryBgoNeighbours_det[ge->DetectorId()][1] == bgo->DetectorId() && GriffinAncillaryBgoNeighbours_cry[ge->DetectorId()][1] == bgo->CrystalId() ) {
-                ge = fGriffinCrystal->erase(ge);
-            }
-            else {
-                ++ge;
-            }
+void Converter::RemoveSupressed(std::vector<Detector>* detector, const ULong64_t* suppressorMask, int nofDetectors, ULong64_t firedMask) {
+    // keep only hits whose suppressors did not fire, compacting the vector in place
+    if(firedMask == 0) {
+        return;
+    }
+    size_t good = 0;
+    for(size_t i = 0; i < detector->size(); ++i) {
+        int det = detector->at(i).DetectorId();
+        if(det >= 0 && det < nofDetectors && (suppressorMask[det] & firedMask) != 0) {
+            continue;
+        }
+        if(good != i) {
+            (*detector)[good] = (*detector)[i];
         }
+        ++good;
     }
+    detector->erase(detector->begin()+good, detector->end());
 }
 
-void Converter::SupressGriffinBySceptar() {
-    //loop over all bgo's and remove all matching germaniums
-    for(auto bgo = fSceptarDetector->begin(); bgo != fSceptarDetector->end(); ++bgo) {
-
-        for(auto ge = fGriffinCrystal->begin(); ge != fGriffinCrystal->end();) {
-
-            if(GriffinSceptarSuppressors_det[ge->DetectorId()][0] == bgo->DetectorId() ) {
-                ge = fGriffinCrystal->erase(ge);
-            }
-            else if(GriffinSceptarSuppressors_det[ge->DetectorId()][1] == bgo->DetectorId() ) {
-                ge = fGriffinCrystal->erase(ge);
-            }
-            else if(GriffinSceptarSuppressors_det[ge->DetectorId()][2] == bgo->DetectorId() ) {
-                ge = fGriffinCrystal->erase(ge);
+void Converter::AddbackGriffin() {
+    // the slots point to the clover addback entry of each detector, they are reset again at the end
+    for(size_t i = 0; i < fGriffinDetector->size(); ++i) {
+        int det = fGriffinDetector->at(i).DetectorId();
+        if(det >= 0 && det < 16 && fGriffinDetectorSlot[det] < 0) {
+            fGriffinDetectorSlot[det] = i;
+        }
+    }
+    for(auto crystal = fGriffinCrystal->begin(); crystal != fGriffinCrystal->end(); ++crystal) {
+        int det = crystal->DetectorId();
+        if(det >= 0 && det < 16) {
+            if(fGriffinDetectorSlot[det] < 0) {
+                fGriffinDetectorSlot[det] = fGriffinDetector->size();
+                fGriffinDetector->push_back(*crystal);
+            } else {
+                (*fGriffinDetector)[fGriffinDetectorSlot[det]].AddEnergy(crystal->SimulationEnergy(),crystal->Energy());
             }
-            else if(GriffinSceptarSuppressors_det[ge->DetectorId()][3] == bgo->DetectorId() ) {
-                ge = fGriffinCrystal->erase(ge);
+        } else {
+            //detector id outside of the array, fall back to searching for a matching detector
+            std::vector<Detector>::iterator detector;
+            for(detector = fGriffinDetector->begin(); detector != fGriffinDetector->end(); ++detector) {
+                if(crystal->DetectorId() == detector->DetectorId()) {
+                    detector->AddEnergy(crystal->SimulationEnergy(),crystal->Energy());
+                    break;
+                }
             }
-            else {
-                ++ge;
+            if(detector == fGriffinDetector->end()) {
+                fGriffinDetector->push_back(*crystal);
             }
         }
     }
+    // reset only the slots we used
+    for(auto detector = fGriffinDetector->begin(); detector != fGriffinDetector->end(); ++detector) {
+        if(detector->DetectorId() >= 0 && detector->DetectorId() < 16) {
+            fGriffinDetectorSlot[detector->DetectorId()] = -1;
+        }
+    }
+
+    AddbackGriffinArray();
+
+    // Do the neighbour add-back;
+    AddbackGriffinNeighbour();
 }
 
-void Converter::AddbackGriffin() {
-    std::vector<Detector>::iterator detector;
+void Converter::AddbackGriffinArray() {
     for(auto crystal = fGriffinCrystal->begin(); crystal != fGriffinCrystal->end(); ++crystal) {
-        //try and find a matching detector to add this crystals energy to
-        for(detector = fGriffinDetector->begin(); detector != fGriffinDetector->end(); ++detector) {
-            if(crystal->DetectorId() == detector->DetectorId()) {
-                detector->AddEnergy(crystal->SimulationEnergy(),crystal->Energy());
-                break;
-            }
-        }
-        //if the above loop ended w/o finding a matching detector, we create a new one
-        if(detector == fGriffinDetector->end()) {
-            fGriffinDetector->push_back(*crystal);
-        }
         if(fGriffinArray->size() == 0) {
             fGriffinArray->push_back(*crystal);
         }
@@ -2500,127 +3251,89 @@ void Converter::AddbackGriffin() {
             fGriffinArray->at(0).AddEnergy(crystal->SimulationEnergy(),crystal->Energy());
         }
     }
-
-    // Do the neighbour add-back;
-    AddbackGriffinNeighbour();
 }
 
 void Converter::AddbackGriffinNeighbour() {
     // This is the idealized neighbour addback method, as we know the order of the Geant4 output.
     // Any scattering should be in order in the output. We could do other things here.
     // For example, we could order the energies from high to low and group them that way.
-    std::vector<Detector>::iterator neighbour;
+    // Each detector can only start one neighbour entry, so a crystal is added to the earliest
+    // entry among its own and its neighbouring detectors' slots.
+    UInt_t occupied = 0;
+    for(size_t i = 0; i < fGriffinNeighbour->size(); ++i) {
+        int det = fGriffinNeighbour->at(i).DetectorId();
+        if(det >= 0 && det < 16 && (occupied & (1U<<det)) == 0) {
+            fGriffinNeighbourSlot[det] = i;
+            occupied |= 1U<<det;
+        }
+    }
     for(auto crystal = fGriffinCrystal->begin(); crystal != fGriffinCrystal->end(); ++crystal) {
-        for(neighbour= fGriffinNeighbour->begin(); neighbour != fGriffinNeighbour->end(); ++neighbour) {
-            if(crystal->DetectorId() == neighbour->DetectorId() || GriffinNeighbours_det[neighbour->DetectorId()][0] == crystal->DetectorId() || GriffinNeighbours_det[neighbour->DetectorId()][1] == crystal->DetectorId() || GriffinNeighbours_det[neighbour->DetectorId()][2] == crystal->DetectorId() || GriffinNeighbours_det[neighbour->DetectorId()][3] == crystal->DetectorId() || GriffinNeighbours_det[crystal->DetectorId()][0] == neighbour->DetectorId() || GriffinNeighbours_det[crystal->DetectorId()][1] == neighbour->DetectorId() || GriffinNeighbours_det[crystal->DetectorId()][2] == neighbour->DetectorId() || GriffinNeighbours_det[crystal->DetectorId()][3] == neighbour->DetectorId() ) {
-                neighbour->AddEnergy(crystal->SimulationEnergy(),crystal->Energy());
-                break;
-            }
+        int det = crystal->DetectorId();
+        if(det < 0 || det >= 16) {
+            fGriffinNeighbour->push_back(*crystal);
+            continue;
         }
-        //if the above loop ended w/o finding a matching detector, we create a new one
-        if(neighbour== fGriffinNeighbour->end()) {
+        UInt_t candidates = GriffinNeighbourMask[det] & occupied;
+        if(candidates == 0) {
+            fGriffinNeighbourSlot[det] = fGriffinNeighbour->size();
+            occupied |= 1U<<det;
             fGriffinNeighbour->push_back(*crystal);
+            continue;
+        }
+        int slot = -1;
+        for(; candidates != 0; candidates &= candidates - 1) {
+            int neighbour = __builtin_ctz(candidates);
+            if(slot < 0 || fGriffinNeighbourSlot[neighbour] < slot) {
+                slot = fGriffinNeighbourSlot[neighbour];
+            }
         }
+        (*fGriffinNeighbour)[slot].AddEnergy(crystal->SimulationEnergy(),crystal->Energy());
+    }
+    // reset only the slots we used
+    for(; occupied != 0; occupied &= occupied - 1) {
+        fGriffinNeighbourSlot[__builtin_ctz(occupied)] = -1;
     }
 }
 
 void Converter::AddbackGriffinNeighbourVector() {
-    std::vector<Detector>::iterator neighbour;
-
-    double energy_ascend[64] = {0};
-    double energy_descend[64] = {0};
-    int index;
-    bool goodenergy;
-
-    for(auto crystal = fGriffinCrystal->begin(); crystal != fGriffinCrystal->end(); ++crystal) {
-        index = crystal->CrystalId() + (crystal->DetectorId() * 4);
-        energy_ascend[index] = crystal->SimulationEnergy();
+    // Starting from the highest energy, every crystal that hasn't been used yet becomes a new entry
+    // and picks up all unused crystals whose centres are within the addback vector length.
+    // The crystals are unique at this point (see MergeActiveSystems), so they fit in a 64 bit mask.
+    size_t hitIndex[64];
+    int order[64];
+    int nofCrystals = 0;
+    ULong64_t unused = 0;
+    for(size_t i = 0; i < fGriffinCrystal->size(); ++i) {
+        int index = fGriffinCrystal->at(i).CrystalId() + (fGriffinCrystal->at(i).DetectorId() * 4);
+        if(index < 0 || index >= 64 || (unused & (1ULL<<index)) != 0 || fGriffinCrystal->at(i).SimulationEnergy() == 0) {
+            continue;
+        }
+        hitIndex[index] = i;
+        unused |= 1ULL<<index;
+        order[nofCrystals++] = index;
     }
 
-    // Sort energies descending
-    int elements = sizeof(energy_ascend) / sizeof(energy_ascend[0]);
-    std::sort(energy_ascend, energy_ascend + elements);
-    for (int i = 0; i < elements; ++i)
-        energy_descend[i] = energy_ascend[elements-1-i];
-
-    for (int i = 0; i < 64; ++i) {
-        if(energy_descend[i] == 0)
-            break;
-        // Now we fill the neighbour vector array according to this list of descending energies
-        for(auto crystal1 = fGriffinCrystal->begin(); crystal1 != fGriffinCrystal->end(); ++crystal1) {
-            if(crystal1->SimulationEnergy() == energy_descend[i]) { // found crystal with energy energy_descend[i]
-                //cout << "new energy = " << crystal1->SimulationEnergy() << " cry = " << crystal1->CrystalId() << " det = " << crystal1->DetectorId() << endl;
-                fGriffinNeighbourVector->push_back(*crystal1);
-                for(auto crystal2 = fGriffinCrystal->begin(); crystal2 != fGriffinCrystal->end(); ++crystal2) { // loop over crystals again
-
-                    if(crystal1 != crystal2 ) { // make sure we don't add the same crystals together!
-                        goodenergy = false;
-                        // does energy exist in energy_descend?
-                        for (int j = i + 1; j < 64; ++j) {
-                            if(energy_descend[j] == crystal2->SimulationEnergy()) {
-                                goodenergy = true;
-                                index = j;
-                                break;
-                            }
-                            if(energy_descend[j] == 0)
-                                break;
-                        }
-
-                        if(goodenergy && AreGriffinCrystalCenterPositionsWithinVectorLength(crystal1->CrystalId(), crystal1->DetectorId(), crystal2->CrystalId(), crystal2->DetectorId())) {
-                            for(neighbour= fGriffinNeighbourVector->begin(); neighbour != fGriffinNeighbourVector->end(); ++neighbour) { // loop over existing neighbours
-                                if(crystal1->DetectorId() == neighbour->DetectorId() && crystal1->CrystalId() == neighbour->CrystalId()) {
-                                    neighbour->AddEnergy(crystal2->SimulationEnergy(),crystal2->Energy());
-                                    //cout << "neighbour energy = " << neighbour->SimulationEnergy() << " cry = " << neighbour->CrystalId() << " det = " << neighbour->DetectorId() << endl;
-
-                                    // now that we have used this crystal2 energy in the neighbour sum, remove it from the list
-                                    if(energy_descend[index] == crystal2->SimulationEnergy()) {
-                                        for (int k = index; k < 64-1; ++k) {
-                                            energy_descend[k] = energy_descend[k+1];
-                                            if(energy_descend[k+1] == 0)
-                                                break;
-                                        }
-                                    }
-                                    else {
-                                        std::cout << " Something is wrong here! index was not found correctly?" << std::endl;
-                                    }
-                                    break;
-                                }
-                            }
-                        }
-                    }
-                }
-
-                // now that we have used this crystal1 energy in the neighbour sum, remove it from the list
-                if(energy_descend[i] == crystal1->SimulationEnergy()) {
-                    for (int k = i; k < 64-1; ++k) {
-                        energy_descend[k] = energy_descend[k+1];
-                        if(energy_descend[k+1] == 0)
-                            break;
-                    }
-                }
-                else {
-                    std::cout << " Something is wrong here! index was not found correctly?" << std::endl;
-                }
-            }
+    // sort crystals by descending energy
+    for(int i = 1; i < nofCrystals; ++i) {
+        int index = order[i];
+        int j = i;
+        for(; j > 0 && fGriffinCrystal->at(hitIndex[order[j-1]]).SimulationEnergy() < fGriffinCrystal->at(hitIndex[index]).SimulationEnergy(); --j) {
+            order[j] = order[j-1];
         }
+        order[j] = index;
     }
 
-}
-
-void Converter::CheckLaBrDetectorAddback() {
-// This method checks that all the "detector" hits are unique, that is, they have different detector IDs.
-// If they have the same detector IDs, then we sum the energies together.
-// Normally the Geant4 simulation would sum energy deposits on the same volume, but if we ran the code in "step mode",
-// or if we merged two ntuples together, this would not be true. This method checks and will do what "hit mode" in Geant4 normally does for us!
-    for(auto firstDet = fLaBrDetector->begin(); firstDet != fLaBrDetector->end(); ++firstDet) {
-        for(auto secondDet = firstDet+1; secondDet != fLaBrDetector->end();) {
-            if((firstDet->DetectorId() == secondDet->DetectorId())) {
-                firstDet->AddEnergy(secondDet->SimulationEnergy(),secondDet->Energy());
-                secondDet = fLaBrDetector->erase(secondDet);
-            }
-            else {
-                ++secondDet;
-            }
+    for(int i = 0; i < nofCrystals; ++i) {
+        if((unused & (1ULL<<order[i])) == 0) {
+            continue;
+        }
+        unused &= ~(1ULL<<order[i]);
+        fGriffinNeighbourVector->push_back(fGriffinCrystal->at(hitIndex[order[i]]));
+        ULong64_t members = GriffinCrystalVectorLengthMask[order[i]] & unused;
+        unused &= ~members;
+        for(; members != 0; members &= members - 1) {
+            Detector& crystal = fGriffinCrystal->at(hitIndex[__builtin_ctzll(members)]);
+            fGriffinNeighbourVector->back().AddEnergy(crystal.SimulationEnergy(),crystal.Energy());
         }
     }
 }
@@ -2638,24 +3351,6 @@ void Converter::SupressLaBr() {
     }
 }
 
-void Converter::CheckEightPiDetectorAddback() {
-// This method checks that all the "detector" hits are unique, that is, they have different detector IDs.
-// If they have the same detector IDs, then we sum the energies together.
-// Normally the Geant4 simulation would sum energy deposits on the same volume, but if we ran the code in "step mode",
-// or if we merged two ntuples together, this would not be true. This method checks and will do what "hit mode" in Geant4 normally does for us!
-    for(auto firstDet = fEightPiDetector->begin(); firstDet != fEightPiDetector->end(); ++firstDet) {
-        for(auto secondDet = firstDet+1; secondDet != fEightPiDetector->end();) {
-            if((firstDet->DetectorId() == secondDet->DetectorId())) {
-                firstDet->AddEnergy(secondDet->SimulationEnergy(),secondDet->Energy());
-                secondDet = fEightPiDetector->erase(secondDet);
-            }
-            else {
-                ++secondDet;
-            }
-        }
-    }
-}
-
 void Converter::SupressEightPi() {
     //loop over all bgo's and remove all matching germaniums
     for(auto bgo = fEightPiBgoDetector->begin(); bgo != fEightPiBgoDetector->end(); ++bgo) {
@@ -2670,23 +3365,7 @@ void Converter::SupressEightPi() {
 }
 
 void Converter::SupressLaBrByNeighbouringGriffinShields() {
-    //loop over all bgo's and remove all matching germaniums
-    for(auto bgo = fGriffinBgo->begin(); bgo != fGriffinBgo->end(); ++bgo) {
-        for(auto ge = fLaBrDetector->begin(); ge != fLaBrDetector->end();) {
-            if(LaBrGriffinNeighbours_det[ge->DetectorId()][0] == bgo->DetectorId() && LaBrGriffinNeighbours_cry[ge->DetectorId()][0] == bgo->CrystalId() ) {
-                ge = fLaBrDetector->erase(ge);
-            }
-            else if(LaBrGriffinNeighbours_det[ge->DetectorId()][1] == bgo->DetectorId() && LaBrGriffinNeighbours_cry[ge->DetectorId()][1] == bgo->CrystalId() ) {
-                ge = fLaBrDetector->erase(ge);
-            }
-            else if(LaBrGriffinNeighbours_det[ge->DetectorId()][2] == bgo->DetectorId() && LaBrGriffinNeighbours_cry[ge->DetectorId()][2] == bgo->CrystalId() ) {
-                ge = fLaBrDetector->erase(ge);
-            }
-            else {
-                ++ge;
-            }
-        }
-    }
+    RemoveSupressed(fLaBrDetector, LaBrGriffinShieldMask, 8, CrystalMask(fGriffinBgo, 4));
 }
 
 void Converter::AddbackLaBr() {
@@ -2709,24 +3388,6 @@ void Converter::AddbackEightPi() {
     }
 }
 
-void Converter::CheckAncillaryBgoCrystalAddback() {
-// This method checks that all the "crystal" hits are unique, that is, they have different crystal and detector IDs.
-// If they have the same crystal and detector IDs, then we sum the energies together.
-// Normally the Geant4 simulation would sum energy deposits on the same volume, but if we ran the code in "step mode",
-// or if we merged two ntuples together, this would not be true. This method checks and will do what "hit mode" in Geant4 normally does for us!
-    for(auto firstDet = fAncillaryBgoCrystal->begin(); firstDet != fAncillaryBgoCrystal->end(); ++firstDet) {
-        for(auto secondDet = firstDet+1; secondDet != fAncillaryBgoCrystal->end();) {
-            if((firstDet->DetectorId() == secondDet->DetectorId()) && (firstDet->CrystalId() == secondDet->CrystalId())) {
-                firstDet->AddEnergy(secondDet->SimulationEnergy(),secondDet->Energy());
-                secondDet = fAncillaryBgoCrystal->erase(secondDet);
-            }
-            else {
-                ++secondDet;
-            }
-        }
-    }
-}
-
 void Converter::AddbackAncillaryBgo() {
     std::vector<Detector>::iterator detector;
     for(auto crystal = fAncillaryBgoCrystal->begin(); crystal != fAncillaryBgoCrystal->end(); ++crystal) {
@@ -2749,24 +3410,6 @@ void Converter::AddbackAncillaryBgo() {
     }
 }
 
-void Converter::CheckSceptarDetectorAddback() {
-// This method checks that all the "detector" hits are unique, that is, they have different detector IDs.
-// If they have the same detector IDs, then we sum the energies together.
-// Normally the Geant4 simulation would sum energy deposits on the same volume, but if we ran the code in "step mode",
-// or if we merged two ntuples together, this would not be true. This method checks and will do what "hit mode" in Geant4 normally does for us!
-    for(auto firstDet = fSceptarDetector->begin(); firstDet != fSceptarDetector->end(); ++firstDet) {
-        for(auto secondDet = firstDet+1; secondDet != fSceptarDetector->end();) {
-            if((firstDet->DetectorId() == secondDet->DetectorId())) {
-                firstDet->AddEnergy(secondDet->SimulationEnergy(),secondDet->Energy());
-                secondDet = fSceptarDetector->erase(secondDet);
-            }
-            else {
-                ++secondDet;
-            }
-        }
-    }
-}
-
 void Converter::AddbackSceptar() {
     for(auto detector = fSceptarDetector->begin(); detector != fSceptarDetector->end(); ++detector) {
         if(fSceptarArray->size() == 0) {
@@ -2777,68 +3420,6 @@ void Converter::AddbackSceptar() {
     }
 }
 
-void Converter::CheckDescantDetectorAddback() {
-// This method checks that all the "detector" hits are unique, that is, they have different detector IDs.
-// If they have the same detector IDs, then we sum the energies together.
-// Normally the Geant4 simulation would sum energy deposits on the same volume, but if we ran the code in "step mode",
-// or if we merged two ntuples together, this would not be true. This method checks and will do what "hit mode" in Geant4 normally does for us!
-    for(auto firstDet = fDescantBlueDetector->begin(); firstDet != fDescantBlueDetector->end(); ++firstDet) {
-        for(auto secondDet = firstDet+1; secondDet != fDescantBlueDetector->end();) {
-            if((firstDet->DetectorId() == secondDet->DetectorId())) {
-                firstDet->AddEnergy(secondDet->SimulationEnergy(),secondDet->Energy());
-                secondDet = fDescantBlueDetector->erase(secondDet);
-            }
-            else {
-                ++secondDet;
-            }
-        }
-    }
-    for(auto firstDet = fDescantGreenDetector->begin(); firstDet != fDescantGreenDetector->end(); ++firstDet) {
-        for(auto secondDet = firstDet+1; secondDet != fDescantGreenDetector->end();) {
-            if((firstDet->DetectorId() == secondDet->DetectorId())) {
-                firstDet->AddEnergy(secondDet->SimulationEnergy(),secondDet->Energy());
-                secondDet = fDescantGreenDetector->erase(secondDet);
-            }
-            else {
-                ++secondDet;
-            }
-        }
-    }
-    for(auto firstDet = fDescantRedDetector->begin(); firstDet != fDescantRedDetector->end(); ++firstDet) {
-        for(auto secondDet = firstDet+1; secondDet != fDescantRedDetector->end();) {
-            if((firstDet->DetectorId() == secondDet->DetectorId())) {
-                firstDet->AddEnergy(secondDet->SimulationEnergy(),secondDet->Energy());
-                secondDet = fDescantRedDetector->erase(secondDet);
-            }
-            else {
-                ++secondDet;
-            }
-        }
-    }
-    for(auto firstDet = fDescantWhiteDetector->begin(); firstDet != fDescantWhiteDetector->end(); ++firstDet) {
-        for(auto secondDet = firstDet+1; secondDet != fDescantWhiteDetector->end();) {
-            if((firstDet->DetectorId() == secondDet->DetectorId())) {
-                firstDet->AddEnergy(secondDet->SimulationEnergy(),secondDet->Energy());
-                secondDet = fDescantWhiteDetector->erase(secondDet);
-            }
-            else {
-                ++secondDet;
-            }
-        }
-    }
-    for(auto firstDet = fDescantYellowDetector->begin(); firstDet != fDescantYellowDetector->end(); ++firstDet) {
-        for(auto secondDet = firstDet+1; secondDet != fDescantYellowDetector->end();) {
-            if((firstDet->DetectorId() == secondDet->DetectorId())) {
-                firstDet->AddEnergy(secondDet->SimulationEnergy(),secondDet->Energy());
-                secondDet = fDescantYellowDetector->erase(secondDet);
-            }
-            else {
-                ++secondDet;
-            }
-        }
-    }
-}
-
 void Converter::AddbackDescant() {
     for(auto detector = fDescantBlueDetector->begin(); detector != fDescantBlueDetector->end(); ++detector) {
         if(fDescantArray->size() == 0) {
@@ -2893,24 +3474,6 @@ void Converter::AddbackDescant() {
 }
 
 
-void Converter::CheckPacesDetectorAddback() {
-// This method checks that all the "detector" hits are unique, that is, they have different detector IDs.
-// If they have the same detector IDs, then we sum the energies together.
-// Normally the Geant4 simulation would sum energy deposits on the same volume, but if we ran the code in "step mode",
-// or if we merged two ntuples together, this would not be true. This method checks and will do what "hit mode" in Geant4 normally does for us!
-    for(auto firstDet = fPacesDetector->begin(); firstDet != fPacesDetector->end(); ++firstDet) {
-        for(auto secondDet = firstDet+1; secondDet != fPacesDetector->end();) {
-            if((firstDet->DetectorId() == secondDet->DetectorId())) {
-                firstDet->AddEnergy(secondDet->SimulationEnergy(),secondDet->Energy());
-                secondDet = fPacesDetector->erase(secondDet);
-            }
-            else {
-                ++secondDet;
-            }
-        }
-    }
-}
-
 void Converter::AddbackPaces() {
     for(auto detector = fPacesDetector->begin(); detector != fPacesDetector->end(); ++detector) {
         if(fPacesArray->size() == 0) {
@@ -3003,7 +3566,7 @@ TH2F* Converter::Get2DHistogram(std::string histogramName, std::string directory
     return hist;
 }*/
 
-THnSparseF* Converter::GetNDHistogram(std::string histogramName, std::string directoryName) {
+THnSparseF* Converter::GetNDHistogram(std::string histogramName, std::string directoryName, int nofAngles) {
     //try and find this histogram
     //This method is different for THnSparse if implemented normally with the other method
     //then the histogram would not set the address of fHistograms[directoryName]->FindObject(histogramName.c_str()) and a new histogram would be created for every event
@@ -3011,8 +3574,9 @@ THnSparseF* Converter::GetNDHistogram(std::string histogramName, std::string dir
     if(fHistograms.find(directoryName) == fHistograms.end() || fHistograms[directoryName]->FindObject(histogramName.c_str()) == nullptr) {
         //if the histogram doesn't exist, we create it and add it to the histogram list
         Double_t min[3] = {fSettings->RangeLow(directoryName), fSettings->RangeLow(directoryName), 0};
-        Double_t max[3] = {fSettings->RangeHigh(directoryName), fSettings->RangeHigh(directoryName), 52};
-        Int_t Bins[3] = {fSettings->NofBins(directoryName), fSettings->NofBins(directoryName), 52};
+        // third axis is the index of the angle combination, one bin per combination of the geometry
+        Double_t max[3] = {fSettings->RangeHigh(directoryName), fSettings->RangeHigh(directoryName), static_cast<Double_t>(nofAngles)};
+        Int_t Bins[3] = {fSettings->NofBins(directoryName), fSettings->NofBins(directoryName), nofAngles};
         hist = new THnSparseF(histogramName.c_str(),histogramName.c_str(),3, Bins,min,max);
         if(fHistograms.find(directoryName) == fHistograms.end()) {
             fHistograms[directoryName] = new TList;
@@ -3025,17 +3589,26 @@ THnSparseF* Converter::GetNDHistogram(std::string histogramName, std::string dir
     return hist;
 }
 
-void Converter::FillHistDetector1DGamma(TH1F* hist1D, std::vector<Detector>* detector, std::string hist_name, std::string hist_dir) {
+void Converter::FillHistDetector1DGamma(TH1F* hist1D, std::vector<Detector>* detector, std::string hist_name, std::string hist_dir, UInt_t vetoMask) {
     for(size_t firstDet = 0; firstDet < detector->size(); ++firstDet) {
+        if(vetoMask != 0 && GriffinVetoed(detector->at(firstDet), vetoMask)) {
+            continue;
+        }
         hist1D = Get1DHistogram(hist_name,hist_dir);
         hist1D->Fill(detector->at(firstDet).Energy());
     }
 }
 
-void Converter::FillHistDetector2DGammaGamma(TH2F* hist2D, std::vector<Detector>* detector, std::string hist_name, std::string hist_dir) {
+void Converter::FillHistDetector2DGammaGamma(TH2F* hist2D, std::vector<Detector>* detector, std::string hist_name, std::string hist_dir, UInt_t vetoMask) {
     if(fSettings->Write2DHist()) {
         for(size_t firstDet = 0; firstDet < detector->size(); ++firstDet) {
+            if(vetoMask != 0 && GriffinVetoed(detector->at(firstDet), vetoMask)) {
+                continue;
+            }
             for(size_t secondDet = firstDet+1; secondDet < detector->size(); ++secondDet) {
+                if(vetoMask != 0 && GriffinVetoed(detector->at(secondDet), vetoMask)) {
+                    continue;
+                }
                 hist2D = Get2DHistogram(hist_name,hist_dir);
                 // symmetrize!
                 hist2D->Fill(detector->at(firstDet).Energy(),detector->at(secondDet).Energy());
@@ -3045,17 +3618,26 @@ void Converter::FillHistDetector2DGammaGamma(TH2F* hist2D, std::vector<Detector>
     }
 }
 
-void Converter::FillHistDetector1DGammaNR(TH1F* hist1D, std::vector<Detector>* detector, std::string hist_name, std::string hist_dir) {
+void Converter::FillHistDetector1DGammaNR(TH1F* hist1D, std::vector<Detector>* detector, std::string hist_name, std::string hist_dir, UInt_t vetoMask) {
     for(size_t firstDet = 0; firstDet < detector->size(); ++firstDet) {
+        if(vetoMask != 0 && GriffinVetoed(detector->at(firstDet), vetoMask)) {
+            continue;
+        }
         hist1D = Get1DHistogram(hist_name,hist_dir); //
         hist1D->Fill(detector->at(firstDet).SimulationEnergy());
     }
 }
 
-void Converter::FillHistDetector2DGammaGammaNR(TH2F* hist2D, std::vector<Detector>* detector, std::string hist_name, std::string hist_dir) {
+void Converter::FillHistDetector2DGammaGammaNR(TH2F* hist2D, std::vector<Detector>* detector, std::string hist_name, std::string hist_dir, UInt_t vetoMask) {
     if(fSettings->Write2DHist()) {
         for(size_t firstDet = 0; firstDet < detector->size(); ++firstDet) {
+            if(vetoMask != 0 && GriffinVetoed(detector->at(firstDet), vetoMask)) {
+                continue;
+            }
             for(size_t secondDet = firstDet+1; secondDet < detector->size(); ++secondDet) {
+                if(vetoMask != 0 && GriffinVetoed(detector->at(secondDet), vetoMask)) {
+                    continue;
+                }
                 hist2D = Get2DHistogram(hist_name,hist_dir);
                 // symmetrize!
                 hist2D->Fill(detector->at(firstDet).SimulationEnergy(),detector->at(secondDet).SimulationEnergy());
@@ -3136,24 +3718,180 @@ TVector3 Converter::GriffinCrystalCenterPosition(int cry, int det) {
     return vec;
 }
 
-bool Converter::AreGriffinCrystalCenterPositionsWithinVectorLength(int cry1, int det1, int cry2, int det2){
-    TVector3 vec1 = GriffinCrystalCenterPosition(cry1,det1);
-    TVector3 vec2 = GriffinCrystalCenterPosition(cry2,det2);
+// reads a whitespace separated list of up to size entries (e.g. "0 1", or "none"), the remaining entries are set to 9999 (no neighbour)
+static bool ReadGeometryTable(TEnv& env, const char* key, Int_t* table, int size) {
+    if(!env.Defined(key)) {
+        return false;
+    }
+    std::istringstream str(env.GetValue(key,""));
+    int i = 0;
+    int value;
+    for(; i < size && str>>value; ++i) {
+        table[i] = value;
+    }
+    for(; i < size; ++i) {
+        table[i] = 9999;
+    }
+    return true;
+}
 
-    double x1 = vec1.X();
-    double y1 = vec1.Y();
-    double z1 = vec1.Z();
-    double x2 = vec2.X();
-    double y2 = vec2.Y();
-    double z2 = vec2.Z();
+// sorts the distinct angles of a size x size map, counts how often each one occurs,
+// and stores for each entry of the map the index of its angle
+static int CompileAngleCombos(const double* map, int size, double (*combos)[2], int* index) {
+    std::vector<double> angles(map, map + size*size);
+    std::sort(angles.begin(), angles.end());
+    angles.erase(std::unique(angles.begin(), angles.end()), angles.end());
+    for(size_t i = 0; i < angles.size(); ++i) {
+        combos[i][0] = angles[i];
+        combos[i][1] = 0;
+    }
+    for(int i = 0; i < size*size; ++i) {
+        index[i] = std::lower_bound(angles.begin(), angles.end(), map[i]) - angles.begin();
+        combos[index[i]][1] += 1;
+    }
+    return angles.size();
+}
 
-    bool result = false;
+bool Converter::ReadGeometry(const std::string& fileName) {
+    // Any detector coordinate or neighbour list given in the file replaces the default GRIFFIN one, e.g.
+    // Griffin.0.Theta: 45.0, Griffin.0.Neighbours: 5, Griffin.0.AncillaryBgo.Detectors: 0 1, Griffin.0.AncillaryBgo.Crystals: 1 2,
+    // Griffin.0.Sceptar.Suppressors: 0 1, LaBr.0.GriffinShield.Detectors: 0 3 4, LaBr.0.GriffinShield.Crystals: 2 0 3
+    if(!FileExists(fileName)) {
+        std::cerr<<"Failed to find geometry file '"<<fileName<<"', using default geometry!"<<std::endl;
+        return false;
+    }
+    TEnv env;
+    env.ReadFile(fileName.c_str(),kEnvLocal);
+
+    const char* coordinateNames[5] = {"Theta", "Phi", "Yaw", "Pitch", "Roll"};
+    bool newCoordinates = false;
+    for(int det = 0; det < 16; ++det) {
+        for(int i = 0; i < 5; ++i) {
+            double value = env.GetValue(Form("Griffin.%d.%s",det,coordinateNames[i]),GriffinDetCoords[det][i]);
+            if(value != GriffinDetCoords[det][i]) {
+                GriffinDetCoords[det][i] = value;
+                newCoordinates = true;
+            }
+        }
+        ReadGeometryTable(env, Form("Griffin.%d.Neighbours",det), GriffinNeighbours_det[det], 4);
+        ReadGeometryTable(env, Form("Griffin.%d.AncillaryBgo.Detectors",det), GriffinAncillaryBgoNeighbours_det[det], 2);
+        ReadGeometryTable(env, Form("Griffin.%d.AncillaryBgo.Crystals",det), GriffinAncillaryBgoNeighbours_cry[det], 2);
+        ReadGeometryTable(env, Form("Griffin.%d.Sceptar.Suppressors",det), GriffinSceptarSuppressors_det[det], 4);
+    }
+    for(int det = 0; det < 8; ++det) {
+        ReadGeometryTable(env, Form("LaBr.%d.GriffinShield.Detectors",det), LaBrGriffinNeighbours_det[det], 3);
+        ReadGeometryTable(env, Form("LaBr.%d.GriffinShield.Crystals",det), LaBrGriffinNeighbours_cry[det], 3);
+    }
 
-    if( ((x1-x2)*(x1-x2) + (y1-y2)*(y1-y2) + (z1-z2)*(z1-z2)) <= fSettings->GriffinAddbackVectorLengthmm()*fSettings->GriffinAddbackVectorLengthmm() ) {
-        result = true;
+    if(newCoordinates) {
+        // the angle maps have to be recalculated for the new coordinates, the angles are
+        // rounded to 1/1000 of a degree so that equivalent pairs end up with the same angle
+        TVector3 detector[16];
+        TVector3 crystal[64];
+        for(int det = 0; det < 16; ++det) {
+            detector[det].SetMagThetaPhi(1., GriffinDetCoords[det][0]*TMath::DegToRad(), GriffinDetCoords[det][1]*TMath::DegToRad());
+            for(int cry = 0; cry < 4; ++cry) {
+                crystal[cry+(det*4)] = GriffinCrystalCenterPosition(cry,det);
+            }
+        }
+        for(int i = 0; i < 16; ++i) {
+            for(int j = 0; j < 16; ++j) {
+                GriffinDetMap[i][j] = TMath::Nint(detector[i].Angle(detector[j])*TMath::RadToDeg()*1000.)/1000.;
+            }
+        }
+        for(int i = 0; i < 64; ++i) {
+            for(int j = 0; j < 64; ++j) {
+                GriffinCryMap[i][j] = TMath::Nint(crystal[i].Angle(crystal[j])*TMath::RadToDeg()*1000.)/1000.;
+            }
+        }
     }
 
-    return result;
+    return true;
+}
+
+void Converter::CompileGeometry() {
+    // convert the suppressor tables into bitmasks, so that suppression is a single AND per hit
+    for(int det = 0; det < 16; ++det) {
+        GriffinAncillaryBgoMask[det] = 0;
+        GriffinSceptarMask[det] = 0;
+        for(int i = 0; i < 2; ++i) {
+            if(GriffinAncillaryBgoNeighbours_det[det][i] == 9999) {
+                continue;
+            }
+            int bit = 3*GriffinAncillaryBgoNeighbours_det[det][i] + GriffinAncillaryBgoNeighbours_cry[det][i];
+            if(bit < 0 || bit >= 64 || GriffinAncillaryBgoNeighbours_cry[det][i] < 0 || GriffinAncillaryBgoNeighbours_cry[det][i] >= 3) {
+                std::cerr<<"Ancillary BGO "<<GriffinAncillaryBgoNeighbours_det[det][i]<<"."<<GriffinAncillaryBgoNeighbours_cry[det][i]<<" of GRIFFIN detector "<<det<<" is out of range, ignoring it!"<<std::endl;
+                continue;
+            }
+            GriffinAncillaryBgoMask[det] |= 1ULL<<bit;
+        }
+        for(int i = 0; i < 4; ++i) {
+            if(GriffinSceptarSuppressors_det[det][i] == 9999) {
+                continue;
+            }
+            if(GriffinSceptarSuppressors_det[det][i] < 0 || GriffinSceptarSuppressors_det[det][i] >= 64) {
+                std::cerr<<"SCEPTAR suppressor "<<GriffinSceptarSuppressors_det[det][i]<<" of GRIFFIN detector "<<det<<" is out of range, ignoring it!"<<std::endl;
+                continue;
+            }
+            GriffinSceptarMask[det] |= 1ULL<<GriffinSceptarSuppressors_det[det][i];
+        }
+    }
+    for(int det = 0; det < 8; ++det) {
+        LaBrGriffinShieldMask[det] = 0;
+        for(int i = 0; i < 3; ++i) {
+            if(LaBrGriffinNeighbours_det[det][i] == 9999) {
+                continue;
+            }
+            if(LaBrGriffinNeighbours_det[det][i] < 0 || LaBrGriffinNeighbours_det[det][i] >= 16 || LaBrGriffinNeighbours_cry[det][i] < 0 || LaBrGriffinNeighbours_cry[det][i] >= 4) {
+                std::cerr<<"GRIFFIN shield "<<LaBrGriffinNeighbours_det[det][i]<<"."<<LaBrGriffinNeighbours_cry[det][i]<<" of LaBr detector "<<det<<" is out of range, ignoring it!"<<std::endl;
+                continue;
+            }
+            LaBrGriffinShieldMask[det] |= 1ULL<<(4*LaBrGriffinNeighbours_det[det][i] + LaBrGriffinNeighbours_cry[det][i]);
+        }
+    }
+
+    // neighbour masks for the addback, these include the detector itself
+    for(int det = 0; det < 16; ++det) {
+        GriffinNeighbourMask[det] = 1U<<det;
+        fGriffinDetectorSlot[det] = -1;
+        fGriffinNeighbourSlot[det] = -1;
+        fGriffinVeto[det] = 0;
+    }
+    fGriffinVetoed = 0;
+    for(int det = 0; det < 16; ++det) {
+        for(int i = 0; i < 4; ++i) {
+            if(GriffinNeighbours_det[det][i] == 9999) {
+                continue;
+            }
+            if(GriffinNeighbours_det[det][i] < 0 || GriffinNeighbours_det[det][i] >= 16) {
+                std::cerr<<"Neighbour "<<GriffinNeighbours_det[det][i]<<" of GRIFFIN detector "<<det<<" is out of range, ignoring it!"<<std::endl;
+                continue;
+            }
+            GriffinNeighbourMask[det] |= 1U<<GriffinNeighbours_det[det][i];
+            GriffinNeighbourMask[GriffinNeighbours_det[det][i]] |= 1U<<det;
+        }
+    }
+
+    // angle combinations for the angular correlations
+    GriffinCryMapNofCombos = CompileAngleCombos(&GriffinCryMap[0][0], 64, GriffinCryMapCombos, &GriffinCryMapIndex[0][0]);
+    GriffinDetMapNofCombos = CompileAngleCombos(&GriffinDetMap[0][0], 16, GriffinDetMapCombos, &GriffinDetMapIndex[0][0]);
+
+    // crystal positions and which crystals are within the addback vector length of each other
+    for(int i = 0; i < 4; i++) {
+        for(int j = 0; j < 16; j++) {
+            GriffinCrystalCenterVectors[i+(j*4)] = GriffinCrystalCenterPosition(i,j);
+            //std::cout << "cry = " << i << " det = " << j << " : x = " << GriffinCrystalCenterVectors[i+(j*4)].X() << " mm - y = " << GriffinCrystalCenterVectors[i+(j*4)].Y() << " mm - z = " << GriffinCrystalCenterVectors[i+(j*4)].Z() << " mm" << std::endl;
+        }
+    }
+    double maxDistance2 = fSettings->GriffinAddbackVectorLengthmm()*fSettings->GriffinAddbackVectorLengthmm();
+    for(int m = 0; m < 64; m++) {
+        GriffinCrystalVectorLengthMask[m] = 0;
+        for(int n = 0; n < 64; n++) {
+            if((GriffinCrystalCenterVectors[m] - GriffinCrystalCenterVectors[n]).Mag2() <= maxDistance2) {
+                GriffinCrystalVectorLengthMask[m] |= 1ULL<<n;
+            }
+        }
+    }
 }
 
 double Converter::transX(double x, double y, double z, double theta, double phi){
@@ -3242,349 +3980,261 @@ void Converter::FillTistarVectors() {
         TVector3 particlePos = TVector3(fPosx, fPosy, fPosz);
         TVector3 stripPos = TVector3(fSettings->GetTistarSettings()->GetLayerPositionVector()[fDetNumber][fCryNumber]);
         TVector3 stripDim = TVector3(fSettings->GetTistarSettings()->GetLayerDimensionVector()[fDetNumber][fCryNumber]);
-        ParticleMC part;
-        int stripNumber, ringNumber;
         switch(fDetNumber) {
-            size_t j;
             case 0: // first layer - pixelated w/ 4 panels
-                // strip calculations
-                stripNumber = CalculateTistarStripNumber(fDetNumber, particlePos, stripPos, stripDim);
-                for(j = 0; j < fTISTARFirstLayerStripNb[fCryNumber].size(); j++) { // checking to see if this strip is already activated
-                    if(stripNumber == fTISTARFirstLayerStripNb[fCryNumber][j]) { // we found a strip that was already activated!
-                        fTISTARFirstLayerStripEnergy[fCryNumber][j] += fDepEnergy; 
-                        break;
-                    }
-                }
-                if(j == fTISTARFirstLayerStripNb[fCryNumber].size()) { // we didn't find an activated strip, so we add one
-                    fTISTARFirstLayerStripNb[fCryNumber].push_back(stripNumber);
-                    fTISTARFirstLayerStripEnergy[fCryNumber].push_back(fDepEnergy);
-                    fTISTARFirstLayerStripA[fCryNumber].push_back(fTargetA);
-                    fTISTARFirstLayerStripZ[fCryNumber].push_back(fTargetZ);
-                    fTISTARFirstLayerStripTrackID[fCryNumber].push_back(fTrackID);
-                    fTISTARFirstLayerStripTime[fCryNumber].push_back(fTime);
-                    fTISTARFirstLayerStripStopped[fCryNumber].push_back(-1); // might need to actually calculate this using the IsStopped method from TRexBarrelDeltaESingleSensitiveDetector
-                    fTISTARFirstLayerStripPos[fCryNumber].push_back(particlePos);
-                }
-                // ring calculations
-                ringNumber = CalculateTistarRingNumber(fDetNumber, particlePos, stripPos, stripDim);
-                for(j = 0; j < fTISTARFirstLayerRingNb[fCryNumber].size(); j++) { // checking to see if this Ring is already activated
-                    if(ringNumber == fTISTARFirstLayerRingNb[fCryNumber][j]) { // we found a Ring that was already activated!
-                        fTISTARFirstLayerRingEnergy[fCryNumber][j] += fDepEnergy; 
-                        break;
-                    }
-                }
-                if(j == fTISTARFirstLayerRingNb[fCryNumber].size()) { // we didn't find an activated Ring, so we add one
-                    fTISTARFirstLayerRingNb[fCryNumber].push_back(ringNumber);
-                    fTISTARFirstLayerRingEnergy[fCryNumber].push_back(fDepEnergy);
-                    fTISTARFirstLayerRingA[fCryNumber].push_back(fTargetA);
-                    fTISTARFirstLayerRingZ[fCryNumber].push_back(fTargetZ);
-                    fTISTARFirstLayerRingTrackID[fCryNumber].push_back(fTrackID);
-                    fTISTARFirstLayerRingTime[fCryNumber].push_back(fTime);
-                    fTISTARFirstLayerRingStopped[fCryNumber].push_back(-1); // might need to actually calculate this using the IsStopped method from TRexBarrelDeltaESingleSensitiveDetector
-                }
+                AddTistarChannelHit(fTISTARFirstLayer[fCryNumber].fStrips, fTISTARFirstLayer[fCryNumber].fHitStrips, CalculateTistarStripNumber(fDetNumber, particlePos, stripPos, stripDim), particlePos);
+                AddTistarChannelHit(fTISTARFirstLayer[fCryNumber].fRings, fTISTARFirstLayer[fCryNumber].fHitRings, CalculateTistarRingNumber(fDetNumber, particlePos, stripPos, stripDim), particlePos);
                 break;
     
             case 1: // second layer - pixelated w/ 2 panels
-                // strip calculations
-                stripNumber = CalculateTistarStripNumber(fDetNumber, particlePos, stripPos, stripDim);
-                for(j = 0; j < fTISTARSecondLayerStripNb[fCryNumber].size(); j++) { // checking to see if this strip is already activated
-                    if(stripNumber == fTISTARSecondLayerStripNb[fCryNumber][j]) { // we found a strip that was already activated!
-                        fTISTARSecondLayerStripEnergy[fCryNumber][j] += fDepEnergy; 
-                        break;
-                    }
-                }
-                if(j == fTISTARSecondLayerStripNb[fCryNumber].size()) { // we didn't find an activated strip, so we add one
-                    fTISTARSecondLayerStripNb[fCryNumber].push_back(stripNumber);
-                    fTISTARSecondLayerStripEnergy[fCryNumber].push_back(fDepEnergy);
-                    fTISTARSecondLayerStripA[fCryNumber].push_back(fTargetA);
-                    fTISTARSecondLayerStripZ[fCryNumber].push_back(fTargetZ);
-                    fTISTARSecondLayerStripTrackID[fCryNumber].push_back(fTrackID);
-                    fTISTARSecondLayerStripTime[fCryNumber].push_back(fTime);
-                    fTISTARSecondLayerStripStopped[fCryNumber].push_back(-1); // might need to actually calculate this using the IsStopped method from TRexBarrelDeltaESingleSensitiveDetector
-                    fTISTARSecondLayerStripPos[fCryNumber].push_back(particlePos);
-                }
-                // ring calculations
-                ringNumber = CalculateTistarRingNumber(fDetNumber, particlePos, stripPos, stripDim);
-                for(j = 0; j < fTISTARSecondLayerRingNb[fCryNumber].size(); j++) { // checking to see if this Ring is already activated
-                    if(ringNumber == fTISTARSecondLayerRingNb[fCryNumber][j]) { // we found a Ring that was already activated!
-                        fTISTARSecondLayerRingEnergy[fCryNumber][j] += fDepEnergy; 
-                        break;
-                    }
-                }
-                if(j == fTISTARSecondLayerRingNb[fCryNumber].size()) { // we didn't find an activated Ring, so we add one
-                    fTISTARSecondLayerRingNb[fCryNumber].push_back(ringNumber);
-                    fTISTARSecondLayerRingEnergy[fCryNumber].push_back(fDepEnergy);
-                    fTISTARSecondLayerRingA[fCryNumber].push_back(fTargetA);
-                    fTISTARSecondLayerRingZ[fCryNumber].push_back(fTargetZ);
-                    fTISTARSecondLayerRingTrackID[fCryNumber].push_back(fTrackID);
-                    fTISTARSecondLayerRingTime[fCryNumber].push_back(fTime);
-                    fTISTARSecondLayerRingStopped[fCryNumber].push_back(-1); // might need to actually calculate this using the IsStopped method from TRexBarrelDeltaESingleSensitiveDetector
-                }
+                AddTistarChannelHit(fTISTARSecondLayer[fCryNumber].fStrips, fTISTARSecondLayer[fCryNumber].fHitStrips, CalculateTistarStripNumber(fDetNumber, particlePos, stripPos, stripDim), particlePos);
+                AddTistarChannelHit(fTISTARSecondLayer[fCryNumber].fRings, fTISTARSecondLayer[fCryNumber].fHitRings, CalculateTistarRingNumber(fDetNumber, particlePos, stripPos, stripDim), particlePos);
                 break;
 
             case 2: // third (pad) layer - not pixelated, 2 panels
-                // here we can directly create and add the new ParticleMC
-                ParticleMC part;
-                part.SetEdet(fDepEnergy);
-                part.SetTime(fTime);
-                part.SetA(fTargetA);
-                part.SetZ(fTargetZ);
-                part.SetTrackID(fTrackID);
-                fTISTARPad[fCryNumber]->push_back(part);
+                {
+                    // here we can directly create and add the new ParticleMC, in place to reuse the memory of earlier events
+                    fTISTARPad[fCryNumber]->resize(fTISTARPad[fCryNumber]->size() + 1);
+                    ParticleMC& part = fTISTARPad[fCryNumber]->back();
+                    part.SetEdet(fDepEnergy);
+                    part.SetTime(fTime);
+                    part.SetA(fTargetA);
+                    part.SetZ(fTargetZ);
+                    part.SetTrackID(fTrackID);
+                }
                 break;
         }    
     }
 }
 
+void Converter::AddTistarChannelHit(std::vector<TistarChannel>& channels, std::vector<int>& hitChannels, int number, const TVector3& position) {
+    // the arrays only grow until they cover all strips/rings of the panel, after that this is a plain lookup
+    size_t index = number + 1;
+    if(index >= channels.size()) {
+        channels.resize(index + 1, TistarChannel());
+    }
+    TistarChannel& channel = channels[index];
+    if(channel.fHit) { // this strip/ring was already activated
+        channel.fEnergy += fDepEnergy;
+        return;
+    }
+    channel.fHit = true;
+    channel.fEnergy = fDepEnergy;
+    channel.fA = fTargetA;
+    channel.fZ = fTargetZ;
+    channel.fTrackID = fTrackID;
+    channel.fTime = fTime;
+    channel.fPos = position;
+    channel.fStopped = -1; // might need to actually calculate this using the IsStopped method from TRexBarrelDeltaESingleSensitiveDetector
+    hitChannels.push_back(number);
+}
+
 void Converter::ClearTistarVectors() {
-    for(int i=0; i<4; i++) {
-        fTISTARFirstLayerStripNb[i].clear();
-        fTISTARFirstLayerStripEnergy[i].clear();
-        fTISTARFirstLayerStripA[i].clear();
-        fTISTARFirstLayerStripZ[i].clear();
-        fTISTARFirstLayerStripTrackID[i].clear();
-        fTISTARFirstLayerStripTime[i].clear();
-        fTISTARFirstLayerStripPos[i].clear(); 
-        fTISTARFirstLayerStripStopped[i].clear();
-        fTISTARFirstLayerRingNb[i].clear();
-        fTISTARFirstLayerRingEnergy[i].clear();
-        fTISTARFirstLayerRingA[i].clear();
-        fTISTARFirstLayerRingZ[i].clear();
-        fTISTARFirstLayerRingTrackID[i].clear();
-        fTISTARFirstLayerRingTime[i].clear();
-        fTISTARFirstLayerRingStopped[i].clear();
-    }
-    for(int i=0; i<2; i++) {
-        fTISTARSecondLayerStripNb[i].clear();
-        fTISTARSecondLayerStripEnergy[i].clear();
-        fTISTARSecondLayerStripA[i].clear();
-        fTISTARSecondLayerStripZ[i].clear();
-        fTISTARSecondLayerStripTrackID[i].clear();
-        fTISTARSecondLayerStripTime[i].clear();
-        fTISTARSecondLayerStripPos[i].clear(); 
-        fTISTARSecondLayerStripStopped[i].clear();
-        fTISTARSecondLayerRingNb[i].clear();
-        fTISTARSecondLayerRingEnergy[i].clear();
-        fTISTARSecondLayerRingA[i].clear();
-        fTISTARSecondLayerRingZ[i].clear();
-        fTISTARSecondLayerRingTrackID[i].clear();
-        fTISTARSecondLayerRingTime[i].clear();
-        fTISTARSecondLayerRingStopped[i].clear();
+    // only the strips/rings that were hit need to be reset
+    TistarPanel* panels[6] = { &fTISTARFirstLayer[0], &fTISTARFirstLayer[1], &fTISTARFirstLayer[2], &fTISTARFirstLayer[3], &fTISTARSecondLayer[0], &fTISTARSecondLayer[1] };
+    for(int i = 0; i < 6; i++) {
+        for(auto strip = panels[i]->fHitStrips.begin(); strip != panels[i]->fHitStrips.end(); ++strip) {
+            panels[i]->fStrips[*strip + 1].fHit = false;
+        }
+        panels[i]->fHitStrips.clear();
+        for(auto ring = panels[i]->fHitRings.begin(); ring != panels[i]->fHitRings.end(); ++ring) {
+            panels[i]->fRings[*ring + 1].fHit = false;
+        }
+        panels[i]->fHitRings.clear();
     }
 }
 
 void Converter::FillTistarParticleMCs() {
-    // loop over all first-layer panels
-    for(int panelNb = 0; panelNb < 4; panelNb++) {
-        ParticleMC part;
-        int nStripsAndRings = 0;
-        // loop over all strips that have been hit
-        for(size_t i = 0; i < fTISTARFirstLayerStripNb[panelNb].size(); i++) {
-            part.AddStrip(fTISTARFirstLayerStripNb[panelNb][i],         // strip number
-                          fTISTARFirstLayerStripEnergy[panelNb][i],     // energy
-                          fTISTARFirstLayerStripA[panelNb][i],          // particle A
-                          fTISTARFirstLayerStripZ[panelNb][i],          // particle Z
-                          fTISTARFirstLayerStripTrackID[panelNb][i],    // trackID
-                          fTISTARFirstLayerStripTime[panelNb][i],       // time
-                          fTISTARFirstLayerStripPos[panelNb][i].x(),    // x position
-                          fTISTARFirstLayerStripPos[panelNb][i].y(),    // y position
-                          fTISTARFirstLayerStripPos[panelNb][i].z(),    // z position
-                          fTISTARFirstLayerStripStopped[panelNb][i]);    // is stopped?
-            nStripsAndRings++;
-        }
-        // loop over all rings that have been hit
-        for(size_t i = 0; i < fTISTARFirstLayerRingNb[panelNb].size(); i++) {
-            part.AddRing(fTISTARFirstLayerRingNb[panelNb][i],           // ring number
-                          fTISTARFirstLayerRingEnergy[panelNb][i],      // energy
-                          fTISTARFirstLayerRingA[panelNb][i],           // particle A
-                          fTISTARFirstLayerRingZ[panelNb][i],           // particle Z
-                          fTISTARFirstLayerRingTrackID[panelNb][i],     // trackID
-                          fTISTARFirstLayerRingTime[panelNb][i],        // time
-                          fTISTARFirstLayerRingStopped[panelNb][i]);    // is stopped?
-            nStripsAndRings++;
-        }
-        // only fill if we have at least one strip/ring activated
-        if(nStripsAndRings > 0) {
-            fTISTARFirstDeltaE[panelNb]->push_back(part);
-        }
-    }
-    // loop over all second-layer panels
-    for(int panelNb = 0; panelNb < 2; panelNb++) {
-        ParticleMC part;
-        int nStripsAndRings = 0;
-        // loop over all strips that have been hit
-        for(size_t i = 0; i < fTISTARSecondLayerStripNb[panelNb].size(); i++) {
-            part.AddStrip(fTISTARSecondLayerStripNb[panelNb][i],         // strip number
-                          fTISTARSecondLayerStripEnergy[panelNb][i],     // energy
-                          fTISTARSecondLayerStripA[panelNb][i],          // particle A
-                          fTISTARSecondLayerStripZ[panelNb][i],          // particle Z
-                          fTISTARSecondLayerStripTrackID[panelNb][i],    // trackID
-                          fTISTARSecondLayerStripTime[panelNb][i],       // time
-                          fTISTARSecondLayerStripPos[panelNb][i].x(),    // x position
-                          fTISTARSecondLayerStripPos[panelNb][i].y(),    // y position
-                          fTISTARSecondLayerStripPos[panelNb][i].z(),    // z position
-                          fTISTARSecondLayerStripStopped[panelNb][i]);    // is stopped?
-            nStripsAndRings++;
-        }
-        // loop over all rings that have been hit
-        for(size_t i = 0; i < fTISTARSecondLayerRingNb[panelNb].size(); i++) {
-            part.AddRing(fTISTARSecondLayerRingNb[panelNb][i],           // ring number
-                          fTISTARSecondLayerRingEnergy[panelNb][i],      // energy
-                          fTISTARSecondLayerRingA[panelNb][i],           // particle A
-                          fTISTARSecondLayerRingZ[panelNb][i],           // particle Z
-                          fTISTARSecondLayerRingTrackID[panelNb][i],     // trackID
-                          fTISTARSecondLayerRingTime[panelNb][i],        // time
-                          fTISTARSecondLayerRingStopped[panelNb][i]);    // is stopped?
-            nStripsAndRings++;
-        }
-        if(nStripsAndRings > 0) {
-            fTISTARSecondDeltaE[panelNb]->push_back(part);
+    // loop over all first-layer panels and then all second-layer panels
+    for(int layerNb = 0; layerNb < 2; layerNb++) {
+        int nofPanels = (layerNb == 0) ? 4 : 2;
+        for(int panelNb = 0; panelNb < nofPanels; panelNb++) {
+            TistarPanel& panel = (layerNb == 0) ? fTISTARFirstLayer[panelNb] : fTISTARSecondLayer[panelNb];
+            // only fill if we have at least one strip/ring activated
+            if(panel.fHitStrips.empty() && panel.fHitRings.empty()) {
+                continue;
+            }
+            // the particles are built in place, the vectors keep their capacity from earlier events and a ParticleMC
+            // keeps a few strips/rings without allocating, so this normally doesn't touch the heap
+            std::vector<ParticleMC>* particles = (layerNb == 0) ? fTISTARFirstDeltaE[panelNb] : fTISTARSecondDeltaE[panelNb];
+            particles->resize(particles->size() + 1);
+            ParticleMC& part = particles->back();
+            // loop over all strips that have been hit
+            for(auto strip = panel.fHitStrips.begin(); strip != panel.fHitStrips.end(); ++strip) {
+                TistarChannel& channel = panel.fStrips[*strip + 1];
+                part.AddStrip(*strip, channel.fEnergy, channel.fA, channel.fZ, channel.fTrackID, channel.fTime,
+                              channel.fPos.x(), channel.fPos.y(), channel.fPos.z(), channel.fStopped);
+            }
+            // loop over all rings that have been hit
+            for(auto ring = panel.fHitRings.begin(); ring != panel.fHitRings.end(); ++ring) {
+                TistarChannel& channel = panel.fRings[*ring + 1];
+                part.AddRing(*ring, channel.fEnergy, channel.fA, channel.fZ, channel.fTrackID, channel.fTime, channel.fStopped);
+            }
         }
     }
 }
 
 void Converter::ClearTistarParticleMCs() {
+    // clear keeps the capacity, so the next event reuses the same memory
     for(int strip=0; strip<4; strip++) { 
-        for(auto particle : *(fTISTARFirstDeltaE[strip])) particle.ClearParticleMC();
         fTISTARFirstDeltaE[strip]->clear();
     }
     for(int strip=0; strip<2; strip++) {
-        for(auto particle : *(fTISTARSecondDeltaE[strip])) particle.ClearParticleMC();
         fTISTARSecondDeltaE[strip]->clear();
     }
     for(int strip=0; strip<2; strip++) {
-        for(auto particle : *(fTISTARPad[strip])) particle.ClearParticleMC();
         fTISTARPad[strip]->clear();
     }
 }
 
+void Converter::AddTistarHistogram(TList* list, TH1* hist) {
+    // a histogram loaded from the output (append mode) is kept, the new empty one isn't needed
+    if(list->FindObject(hist->GetName()) != nullptr) {
+        delete hist;
+        return;
+    }
+    list->Add(hist);
+}
+
+void Converter::WriteSetupObject(TObject* object, const char* name) {
+    // these only depend on the setup, an append keeps the copy written by the first run instead of adding another cycle
+    if(fAppend && fOutput->GetKey(name) != nullptr) {
+        return;
+    }
+    object->Write(name);
+}
+
 void Converter::CreateTistarHistograms(Kinematics * transferP) {
     // we'll create all the histograms from ReconstructSim here
     TistarSettings * sett = fSettings->GetTistarSettings();
     
     std::string directoryName = "TistarAnalysis";
-    fHistograms[directoryName.c_str()] = new TList;
+    // in append mode the list and the histograms were already loaded from the output, they keep being filled
+    if(fHistograms.find(directoryName) == fHistograms.end()) {
+        fHistograms[directoryName] = new TList;
+    }
+    TList* list = fHistograms[directoryName];
     
-    TH2F* originXY = new TH2F("originXY", "y vs. x of reconstructed origin", 200, -10., 10., 200, -10., 10.); fHistograms[directoryName.c_str()]->Add(originXY);
-    TH2F* originXYErr = new TH2F("originXYErr", "Error y vs. error x of reconstructed origin - simulated origin", 200, -10., 10., 200, -10., 10.); fHistograms[directoryName.c_str()]->Add(originXYErr);
-    TH2F* errorOrigin = new TH2F("errorOrigin", "Error between reconstructed and true origin vs. true origin", 200, -100., 100., 1000, -5, 5); fHistograms[directoryName.c_str()]->Add(errorOrigin);
-    TH2F* errorThetaPhi = new TH2F("errorThetaPhi", "Error between reconstructed and true phi vs. error in theta", 600, -30, 30, 720, -360., 360.); fHistograms[directoryName.c_str()]->Add(errorThetaPhi);
-    TH1F* excEnProton = new TH1F("excEnProton", "Excitaiton Energy Spectrum from reconstructed Protons", 5000, -20000, 20000); fHistograms[directoryName.c_str()]->Add(excEnProton);
-    TH1F* reaction = new TH1F("reaction", "Simulated reaction/level", 10, -0.5, 9.5); fHistograms[directoryName.c_str()]->Add(reaction);
-    TH2F* phiErrorVsPhi = new TH2F("phiErrorVsPhi","Error in reconstructed #varphi vs. simulated #varphi", 360, -180., 180., 720, -360., 360.); fHistograms[directoryName.c_str()]->Add(phiErrorVsPhi);
-
-    TH2F* dE12VsPad = new TH2F("dE12VsPad", "energy loss first+second layer vs. pad energy", 2000, 0, 50000, 1000, 0, 10000); fHistograms[directoryName.c_str()]->Add(dE12VsPad);
-    TH2F* dE12VsE = new TH2F("dE12VsE", "energy loss first+second layer vs. total energy", 2000, 0, 50000, 1000, 0, 10000); fHistograms[directoryName.c_str()]->Add(dE12VsE);
-    TH2F* dE1VsE = new TH2F("dE1VsE", "energy loss first layer vs. total energy", 5000, 0, 50000, 1000, 0, 10000); fHistograms[directoryName.c_str()]->Add(dE1VsE);
-    TH2F* dE1VsE_theta_45_55 = new TH2F("dE1VsE_theta_45_55", "energy loss first layer vs. total energy", 5000, 0, 50000, 1000, 0, 10000); fHistograms[directoryName.c_str()]->Add(dE1VsE_theta_45_55);
-    TH2F* dE1VsE_theta_115_125 = new TH2F("dE1VsE_theta_115_125", "energy loss first layer vs. total energy", 5000, 0, 50000, 1000, 0, 10000); fHistograms[directoryName.c_str()]->Add(dE1VsE_theta_115_125);
-    TH2F* dE2VsE = new TH2F("dE2VsE", "energy loss second layer vs. total energy", 5000, 0, 50000, 1000, 0, 10000); fHistograms[directoryName.c_str()]->Add(dE2VsE);
-    TH2F* dE1VsdE2 = new TH2F("dE1VsdE2", "energy loss second layer vs. energy loss first layer", 1000, 0, 10000, 1000, 0, 10000); fHistograms[directoryName.c_str()]->Add(dE1VsdE2);
-    TH2F* eVsTheta = new TH2F("eVsTheta", "recoil energy vs. theta (lab)", 360, 0, 180, 1000, 0, 25000); fHistograms[directoryName.c_str()]->Add(eVsTheta);
-    TH2F* eVsZ = new TH2F("eVsZ", "recoil energy vs. z", 1000, -100., 100., 1000, 0, 25000); fHistograms[directoryName.c_str()]->Add(eVsZ);
-
-    TH2F* eVsZSame = new TH2F("eVsZSame", "recoil energy vs. z, first and second layer both forward or both backward", 1000, -100., 100., 1000, 0, 25000); fHistograms[directoryName.c_str()]->Add(eVsZSame);
-    TH2F* eVsZCross = new TH2F("eVsZCross", "recoil energy vs. z, first and second layer over cross", 1000, -100., 100., 1000, 0, 25000); fHistograms[directoryName.c_str()]->Add(eVsZCross);
-
-
-    TH2F* hEbeamRecVsSim = new TH2F("hEbeamRecVsSim", "beam energy (MeV) in lab reconstructed (x) vs simulated (y)",200,-40,40,200,-40,40); fHistograms[directoryName.c_str()]->Add(hEbeamRecVsSim);
-
-    TH1F* excEnProtonCorr = new TH1F("excEnProtonCorr", "Excitaiton Energy after E loss correction for reconstructed protons", 5000, -5000, 5000); fHistograms[directoryName.c_str()]->Add(excEnProtonCorr);
-    TH1F* excEnProtonCorrEpadCut = new TH1F("excEnProtonCorrEpadCut", "Excitaiton Energy after E loss correction for reconstructed protons with Epad>0", 5000, -20000, 20000); fHistograms[directoryName.c_str()]->Add(excEnProtonCorrEpadCut);
-    TH2F* excEnProtonCorrVsX = new TH2F("excEnProtonCorrVsX", "Excitation Energy vs Vertex X after E loss correction for reconstructed protons", 5000,-10,10,5000, -20000, 20000); fHistograms[directoryName.c_str()]->Add(excEnProtonCorrVsX);
-    TH2F* excEnProtonCorrVsY = new TH2F("excEnProtonCorrVsY", "Excitation Energy vs Vertex Y after E loss correction for reconstructed protons", 5000,-10,10,5000, -20000, 20000); fHistograms[directoryName.c_str()]->Add(excEnProtonCorrVsY);
-    TH2F* excEnProtonCorrVsZ = new TH2F("excEnProtonCorrVsZ", "Excitation Energy vs Vertex Z after E loss correction for reconstructed protons", 5000,-100,100,5000, -20000, 20000); fHistograms[directoryName.c_str()]->Add(excEnProtonCorrVsZ);
-    TH2F* excEnProtonCorrVsT = new TH2F("excEnProtonCorrVsT", "Excitation Energy vs Vertex T after E loss correction for reconstructed protons", 5000,-10,10,5000, -20000, 20000); fHistograms[directoryName.c_str()]->Add(excEnProtonCorrVsT);
-    TH2F* excEnProtonCorrVsR = new TH2F("excEnProtonCorrVsR", "Excitation Energy vs Vertex R after E loss correction for reconstructed protons", 4400,-10,100,5000, -20000, 20000); fHistograms[directoryName.c_str()]->Add(excEnProtonCorrVsR);
-    TH1F* excEnProtonCorrdE1Sigma1 = new TH1F("excEnProtonCorrdE1Sigma1", "Excitation Energy for dE1 1#sigma range after Eloss correction for protons", 5000, -5000, 5000); fHistograms[directoryName.c_str()]->Add(excEnProtonCorrdE1Sigma1);
-    TH1F* excEnProtonCorrdE1Sigma2 = new TH1F("excEnProtonCorrdE1Sigma2", "Excitation Energy for dE1 2#sigma range after Eloss correction for protons", 5000, -5000, 5000); fHistograms[directoryName.c_str()]->Add(excEnProtonCorrdE1Sigma2);
-
-    TH1F* hdE1ElossRange = new TH1F("hdE1ElossRange", "corrected energy range in the first layer", 1000, -100., 3900.); fHistograms[directoryName.c_str()]->Add(hdE1ElossRange);
-    TH1F* hdE2ElossRange = new TH1F("hdE2ElossRange", "corrected energy range in the second layer", 2000, -1000., 9000.); fHistograms[directoryName.c_str()]->Add(hdE2ElossRange);
-    TH1F* hdE2ElossRangeWoEpad0 = new TH1F("hdE2ElossRangeWoEpad0", "corrected energy range in the second layer with Epad>0", 2000, -1000., 9000.); fHistograms[directoryName.c_str()]->Add(hdE2ElossRangeWoEpad0);
-    TH1F* hdE1Eloss = new TH1F("hdE1Eloss", "corrected energy loss in the first layer", 1000, -100., 9900.); fHistograms[directoryName.c_str()]->Add(hdE1Eloss);
-    TH1F* hdE2Eloss = new TH1F("hdE2Eloss", "corrected energy loss in the second layer", 2000, -100., 18900.); fHistograms[directoryName.c_str()]->Add(hdE2Eloss);
-    TH1F* hdE1Measured = new TH1F("hdE1Measured", "measured energy loss in the first layer", 1000, -100., 9900.); fHistograms[directoryName.c_str()]->Add(hdE1Measured);
-    TH1F* hdE2Measured = new TH1F("hdE2Measured", "measured energy loss in the second layer", 2000, -100., 18900.); fHistograms[directoryName.c_str()]->Add(hdE2Measured);
-    TH1F* hErestMeasured = new TH1F("hErestMeasured", "measured energy loss in the pad", 2000, -1000., 39000.); fHistograms[directoryName.c_str()]->Add(hErestMeasured);
-    TH2F* hdE1ElossVsMeasured = new TH2F("hdE1ElossVsMeasured", "corrected energy loss in the first layer vs measured", 1000, -100., 2400., 1000,-100.,2400.); fHistograms[directoryName.c_str()]->Add(hdE1ElossVsMeasured);
-    TH2F* hdE2ElossVsMeasuredWoEpad0 = new TH2F("hdE2ElossVsMeasuredWoEpad0", "corrected energy loss in the second layer vs measured for Epad>0", 2000, -100., 5400., 2000,-100.,5400.); fHistograms[directoryName.c_str()]->Add(hdE2ElossVsMeasuredWoEpad0);
-    TH2F* hdE2ElossVsMeasured = new TH2F("hdE2ElossVsMeasured", "corrected energy loss in the second layer vs measured", 2000, -100., 9400., 2000,-100.,9400.); fHistograms[directoryName.c_str()]->Add(hdE2ElossVsMeasured);
-    TH2F* dE2VsdE2Pad = new TH2F("dE2VsdE2Pad", "energy loss in second layer vs. dE2+pad energy", 2000, 0, 50000, 1000, 0, 10000); fHistograms[directoryName.c_str()]->Add(dE2VsdE2Pad);
-    TH2F* EPadVsThetaLab = new TH2F("EPadVsThetaLab", "pad energy vs theta lab", 720,0,180.,2000, -1000, 49000); fHistograms[directoryName.c_str()]->Add(EPadVsThetaLab);
-    TH2F* EPadVsZ = new TH2F("EPadVsZ", "pad energy vs z", 1000,-100.,100.,2000, -1000, 49000); fHistograms[directoryName.c_str()]->Add(EPadVsZ);
-    TH2F* dE2VsThetaLabEpadCut = new TH2F("dE2VsThetaLabEpadCut", "second layer energy vs theta lab for Epad=0", 720,0,180.,1000, -100, 4900); fHistograms[directoryName.c_str()]->Add(dE2VsThetaLabEpadCut);
-    TH2F* dE2VsEPadThetaCut = new TH2F("dE2VsEPadThetaCut", "energy loss in second layer vs. pad energy for Theta=40", 2000, -1000, 49000, 1000, -100, 9900); fHistograms[directoryName.c_str()]->Add(dE2VsEPadThetaCut);
-    TH2F* dE1VsThetaLab = new TH2F("dE1VsThetaLab", "first layer energy vs theta lab", 720,0,180.,2000, -100, 4900); fHistograms[directoryName.c_str()]->Add(dE1VsThetaLab);
-    TH2F* dE2VsThetaLab = new TH2F("dE2VsThetaLab", "second layer energy vs theta lab", 720,0,180.,2000, -100, 4900); fHistograms[directoryName.c_str()]->Add(dE2VsThetaLab);
-    TH2F* dE12VsThetaLab = new TH2F("dE12VsThetaLab", "first+second layer energy vs theta lab", 720,0,180.,2000, -100, 7900); fHistograms[directoryName.c_str()]->Add(dE12VsThetaLab);
-    TH2F* dE1EpadVsThetaLab = new TH2F("dE1EpadVsThetaLab", "first layer + pad energy vs theta lab", 720,0,180.,2000, -1000, 49900); fHistograms[directoryName.c_str()]->Add(dE1EpadVsThetaLab);
-    TH2F* dE2EpadVsThetaLab = new TH2F("dE2EpadVsThetaLab", "second layer + pad energy vs theta lab", 720,0,180.,2000, -1000, 49900); fHistograms[directoryName.c_str()]->Add(dE2EpadVsThetaLab);
-    TH2F* hdE1ElossVsMeasuredEpad0 = new TH2F("hdE1ElossVsMeasuredEpad0", "corrected energy loss in the first layer vs measured for Epad=0", 1000, -100., 2400., 1000,-100.,2400.); fHistograms[directoryName.c_str()]->Add(hdE1ElossVsMeasuredEpad0);
-    TH2F* hdE1ElossVsMeasuredEpadWo0 = new TH2F("hdE1ElossVsMeasuredEpadWo0", "corrected energy loss in the first layer vs measured for Epad>0", 1000, -100., 2400., 1000,-100.,2400.); fHistograms[directoryName.c_str()]->Add(hdE1ElossVsMeasuredEpadWo0);
-    TH1F* hdE1MeasMinRec = new TH1F("hdE1MeasMinRec", "(measured - reconstructed) energy loss in the first layer", 1000, -500., 500.); fHistograms[directoryName.c_str()]->Add(hdE1MeasMinRec);
-    TH1F* hdE2MeasMinRec = new TH1F("hdE2MeasMinRec", "(measured - reconstructed) energy loss in the second layer", 1000, -500., 500.); fHistograms[directoryName.c_str()]->Add(hdE2MeasMinRec);
-
-    TH2F* eRecErrVsESim = new TH2F("eRecErrVsESim", "error of reconstructed energy vs. simulated energy of recoil", 1000, 0., 25000., 1000, -5000., 5000.); fHistograms[directoryName.c_str()]->Add(eRecErrVsESim);
-    TH2F* thetaErrorVsZ = new TH2F("thetaErrorVsZ", "Error in #vartheta_{lab} reconstruction vs. simulated z-position;z [mm];#Delta#vartheta_{lab} [^{o}]", 200, -100, 100, 100, -15, 15); fHistograms[directoryName.c_str()]->Add(thetaErrorVsZ);
-    TH2F* thetaErrorVsTheta = new TH2F("thetaErrorVsTheta", "Error in #vartheta_{lab} reconstruction vs. simulated #vartheta_{lab};#vartheta_{lab} [^{o}];#Delta#vartheta_{lab} [^{o}]", 180, 0, 180, 100, -15, 15); fHistograms[directoryName.c_str()]->Add(thetaErrorVsTheta);
-    TH2F* thetaErrorVsThetaEpadCut = new TH2F("thetaErrorVsThetaEpadCut", "Error in #vartheta_{lab} reconstruction vs. simulated #vartheta_{lab};#vartheta_{lab} [^{o}];#Delta#vartheta_{lab} [^{o}] with Epad>0", 180, 0, 180, 100, -15, 15); fHistograms[directoryName.c_str()]->Add(thetaErrorVsThetaEpadCut);
-    TH2F* zReactionEnergy = new TH2F("zReactionEnergy", "z position of reaction vs. Beam energy (rec.)", 200, -100, 100, 1000, 0, 1.1*sett->GetBeamEnergy()); fHistograms[directoryName.c_str()]->Add(zReactionEnergy);
-    TH2F* excEnProtonVsTheta = new TH2F("excEnProtonVsTheta", "Excitation Energy Spectrum from reconstructed Protons;#vartheta_{lab}[^{o}];E_{exc} [keV]", 180, 0., 180., 5000, -20000, 20000); fHistograms[directoryName.c_str()]->Add(excEnProtonVsTheta);
-    TH2F* excEnProtonVsPhi = new TH2F("excEnProtonVsPhi", "Excitation Energy Spectrum from reconstructed Protons;#varphi_{lab}[^{o}];E_{exc} [keV]", 360, -180., 180., 5000, -20000, 20000); fHistograms[directoryName.c_str()]->Add(excEnProtonVsPhi);
-    TH2F* excEnProtonVsZ = new TH2F("excEnProtonVsZ", "Excitation Energy Spectrum from reconstructed Protons;z [mm];E_{exc} [keV]", 200, -100., 100., 5000, -20000, 20000); fHistograms[directoryName.c_str()]->Add(excEnProtonVsZ);
-    TH2F* excEnProtonVsThetaGS = new TH2F("excEnProtonVsThetaGS", "Excitation Energy Spectrum from reconstructed Protons, ground state only;#vartheta_{lab}[^{o}];E_{exc} [keV]", 180, 0., 180., 5000, -20000, 20000); fHistograms[directoryName.c_str()]->Add(excEnProtonVsThetaGS);
-    TH2F* excEnProtonVsZGS = new TH2F("excEnProtonVsZGS", "Excitation Energy Spectrum from reconstructed Protons, ground state only;z [mm];E_{exc} [keV]", 200, -100., 100., 5000, -20000, 20000); fHistograms[directoryName.c_str()]->Add(excEnProtonVsZGS);
-    TH2F* excEnProtonVsThetaCm = new TH2F("excEnProtonVsThetaCm", "Excitation Energy Spectrum from reconstructed Protons;#vartheta_{cm}[^{o}];E_{exc} [keV]", 180, 0., 180., 5000, -20000, 20000); fHistograms[directoryName.c_str()]->Add(excEnProtonVsThetaCm);
-    TH2F* thetaVsZ = new TH2F("thetaVsZ","#vartheta_{lab} vs. z", 200, -100., 100., 180, 0., 180.); fHistograms[directoryName.c_str()]->Add(thetaVsZ);
-    TH2F* thetaVsZSame = new TH2F("thetaVsZSame","#vartheta_{lab} vs. z, first and second layer both forward or both backward", 200, -100., 100., 180, 0., 180.); fHistograms[directoryName.c_str()]->Add(thetaVsZSame);
-
-    TH2F* thetaVsZCross = new TH2F("thetaVsZCross","#vartheta_{lab} vs. z, first and second layer over cross", 200, -100., 100., 180, 0., 180.); fHistograms[directoryName.c_str()]->Add(thetaVsZCross);
-    TH2F* phiVsZ = new TH2F("phiVsZ","#varphi_{lab} vs. z", 200, -100., 100., 360, -180., 180.); fHistograms[directoryName.c_str()]->Add(phiVsZ);
-    TH2F* hitpattern = new TH2F("hitpattern","detector # of second layer vs. detector # of first layer", 2, -0.5, 1.5, 2, -0.5, 1.5); fHistograms[directoryName.c_str()]->Add(hitpattern);
-    TH2F* eCmVsZ = new TH2F("eCmVsZ","energy of cm-system vs. z;z [mm];e-cm [GeV]", 200, -100., 100., 2000, transferP->GetCmEnergy(0.)/1000., transferP->GetCmEnergy(sett->GetBeamEnergy())/1000.); fHistograms[directoryName.c_str()]->Add(eCmVsZ);
-    TH2F* betaCmVsZ = new TH2F("betaCmVsZ","#beta of cm-system vs. z", 200, -100., 100., 2000, 0., 0.2); fHistograms[directoryName.c_str()]->Add(betaCmVsZ);
-    TH2F* stripPattern = new TH2F("stripPattern","Parallel strip # (#varphi) vs. perpendicular strip # (#vartheta)", 2*fSettings->GetTISTARnStripsY(0), 0., 2.*fSettings->GetTISTARnStripsY(0), 4*fSettings->GetTISTARnStripsZ(0), 0., 4.*fSettings->GetTISTARnStripsZ(0)); fHistograms[directoryName.c_str()]->Add(stripPattern);
-    TH2F* recBeamEnergyErrVsZ = new TH2F("recBeamEnergyErrVsZ","Error in reconstructed beam energy vs. z", 200, -100., 100., 1000, -50., 50.); fHistograms[directoryName.c_str()]->Add(recBeamEnergyErrVsZ);
-    TH2F* thetaCmVsThetaLab = new TH2F("thetaCmVsThetaLab", "#vartheta_{cm} vs. #vartheta_{lab};#vartheta_{cm} [^{o}];#vartheta_{lab} [^{o}]", 180,0.,180., 180,0.,180.); fHistograms[directoryName.c_str()]->Add(thetaCmVsThetaLab);
-    TH2F* zErrorVsThetaSim = new TH2F("zErrorVsThetaSim", "Error between reconstructed and true z-position vs. simulated #vartheta_{lab}", 180, 0., 180., 1000, -5, 5); fHistograms[directoryName.c_str()]->Add(zErrorVsThetaSim);
-    TH2F* zErrorVsThetaRec = new TH2F("zErrorVsThetaRec", "Error between reconstructed and true z-position vs. recon structed #vartheta_{lab}", 180, 0., 180., 1000, -5, 5); fHistograms[directoryName.c_str()]->Add(zErrorVsThetaRec);
-    TH2F* zErrorVsthetaError = new TH2F("zErrorVstheaError", "z Erorr vs error in theta", 200, -10., 10., 1000, -5., 5.); fHistograms[directoryName.c_str()]->Add(zErrorVsthetaError);
-    TH2F* elossVsTheta = new TH2F("elossVsTheta", "reconstructed energy loss vs. #vartheta;#vartheta_lab [^{o}];energy loss [keV]", 360, -180., 180., 10000, -100000., 100000.); fHistograms[directoryName.c_str()]->Add(elossVsTheta);
-    TH2F* elossVsPhi = new TH2F("elossVsPhi", "reconstructed energy loss vs. #varphi;#varphi_lab [^{o}];energy loss [keV]", 360, -180., 180., 1000, -10000., 10000.); fHistograms[directoryName.c_str()]->Add(elossVsPhi);
-    TH2F* excEnElossVsTheta = new TH2F("excEnElossVsTheta", "Excitation Energy Spectrum from reconstructed energy loss;#vartheta_{lab}[^{o}];E_{exc} [keV]", 360, -180., 180., 5000,-200000, 200000); fHistograms[directoryName.c_str()]->Add(excEnElossVsTheta);
-    TH2F* excEnElossVsThetaEpadCut = new TH2F("excEnElossVsThetaEpadCut", "Excitation Energy Spectrum from reconstructed energy loss;#vartheta_{lab}[^{o}];E_{exc} [keV] with Epad>0", 180, 0., 180., 5000, -20000, 20000); fHistograms[directoryName.c_str()]->Add(excEnElossVsThetaEpadCut);
+    TH2F* originXY = new TH2F("originXY", "y vs. x of reconstructed origin", 200, -10., 10., 200, -10., 10.); AddTistarHistogram(list, originXY);
+    TH2F* originXYErr = new TH2F("originXYErr", "Error y vs. error x of reconstructed origin - simulated origin", 200, -10., 10., 200, -10., 10.); AddTistarHistogram(list, originXYErr);
+    TH2F* errorOrigin = new TH2F("errorOrigin", "Error between reconstructed and true origin vs. true origin", 200, -100., 100., 1000, -5, 5); AddTistarHistogram(list, errorOrigin);
+    TH2F* errorThetaPhi = new TH2F("errorThetaPhi", "Error between reconstructed and true phi vs. error in theta", 600, -30, 30, 720, -360., 360.); AddTistarHistogram(list, errorThetaPhi);
+    TH1F* excEnProton = new TH1F("excEnProton", "Excitaiton Energy Spectrum from reconstructed Protons", 5000, -20000, 20000); AddTistarHistogram(list, excEnProton);
+    TH1F* reaction = new TH1F("reaction", "Simulated reaction/level", 10, -0.5, 9.5); AddTistarHistogram(list, reaction);
+    TH2F* phiErrorVsPhi = new TH2F("phiErrorVsPhi","Error in reconstructed #varphi vs. simulated #varphi", 360, -180., 180., 720, -360., 360.); AddTistarHistogram(list, phiErrorVsPhi);
+
+    TH2F* dE12VsPad = new TH2F("dE12VsPad", "energy loss first+second layer vs. pad energy", 2000, 0, 50000, 1000, 0, 10000); AddTistarHistogram(list, dE12VsPad);
+    TH2F* dE12VsE = new TH2F("dE12VsE", "energy loss first+second layer vs. total energy", 2000, 0, 50000, 1000, 0, 10000); AddTistarHistogram(list, dE12VsE);
+    TH2F* dE1VsE = new TH2F("dE1VsE", "energy loss first layer vs. total energy", 5000, 0, 50000, 1000, 0, 10000); AddTistarHistogram(list, dE1VsE);
+    TH2F* dE1VsE_theta_45_55 = new TH2F("dE1VsE_theta_45_55", "energy loss first layer vs. total energy", 5000, 0, 50000, 1000, 0, 10000); AddTistarHistogram(list, dE1VsE_theta_45_55);
+    TH2F* dE1VsE_theta_115_125 = new TH2F("dE1VsE_theta_115_125", "energy loss first layer vs. total energy", 5000, 0, 50000, 1000, 0, 10000); AddTistarHistogram(list, dE1VsE_theta_115_125);
+    TH2F* dE2VsE = new TH2F("dE2VsE", "energy loss second layer vs. total energy", 5000, 0, 50000, 1000, 0, 10000); AddTistarHistogram(list, dE2VsE);
+    TH2F* dE1VsdE2 = new TH2F("dE1VsdE2", "energy loss second layer vs. energy loss first layer", 1000, 0, 10000, 1000, 0, 10000); AddTistarHistogram(list, dE1VsdE2);
+    TH2F* eVsTheta = new TH2F("eVsTheta", "recoil energy vs. theta (lab)", 360, 0, 180, 1000, 0, 25000); AddTistarHistogram(list, eVsTheta);
+    TH2F* eVsZ = new TH2F("eVsZ", "recoil energy vs. z", 1000, -100., 100., 1000, 0, 25000); AddTistarHistogram(list, eVsZ);
+
+    TH2F* eVsZSame = new TH2F("eVsZSame", "recoil energy vs. z, first and second layer both forward or both backward", 1000, -100., 100., 1000, 0, 25000); AddTistarHistogram(list, eVsZSame);
+    TH2F* eVsZCross = new TH2F("eVsZCross", "recoil energy vs. z, first and second layer over cross", 1000, -100., 100., 1000, 0, 25000); AddTistarHistogram(list, eVsZCross);
+
+
+    TH2F* hEbeamRecVsSim = new TH2F("hEbeamRecVsSim", "beam energy (MeV) in lab reconstructed (x) vs simulated (y)",200,-40,40,200,-40,40); AddTistarHistogram(list, hEbeamRecVsSim);
+
+    TH1F* excEnProtonCorr = new TH1F("excEnProtonCorr", "Excitaiton Energy after E loss correction for reconstructed protons", 5000, -5000, 5000); AddTistarHistogram(list, excEnProtonCorr);
+    TH1F* excEnProtonCorrEpadCut = new TH1F("excEnProtonCorrEpadCut", "Excitaiton Energy after E loss correction for reconstructed protons with Epad>0", 5000, -20000, 20000); AddTistarHistogram(list, excEnProtonCorrEpadCut);
+    TH2F* excEnProtonCorrVsX = new TH2F("excEnProtonCorrVsX", "Excitation Energy vs Vertex X after E loss correction for reconstructed protons", 5000,-10,10,5000, -20000, 20000); AddTistarHistogram(list, excEnProtonCorrVsX);
+    TH2F* excEnProtonCorrVsY = new TH2F("excEnProtonCorrVsY", "Excitation Energy vs Vertex Y after E loss correction for reconstructed protons", 5000,-10,10,5000, -20000, 20000); AddTistarHistogram(list, excEnProtonCorrVsY);
+    TH2F* excEnProtonCorrVsZ = new TH2F("excEnProtonCorrVsZ", "Excitation Energy vs Vertex Z after E loss correction for reconstructed protons", 5000,-100,100,5000, -20000, 20000); AddTistarHistogram(list, excEnProtonCorrVsZ);
+    TH2F* excEnProtonCorrVsT = new TH2F("excEnProtonCorrVsT", "Excitation Energy vs Vertex T after E loss correction for reconstructed protons", 5000,-10,10,5000, -20000, 20000); AddTistarHistogram(list, excEnProtonCorrVsT);
+    TH2F* excEnProtonCorrVsR = new TH2F("excEnProtonCorrVsR", "Excitation Energy vs Vertex R after E loss correction for reconstructed protons", 4400,-10,100,5000, -20000, 20000); AddTistarHistogram(list, excEnProtonCorrVsR);
+    TH1F* excEnProtonCorrdE1Sigma1 = new TH1F("excEnProtonCorrdE1Sigma1", "Excitation Energy for dE1 1#sigma range after Eloss correction for protons", 5000, -5000, 5000); AddTistarHistogram(list, excEnProtonCorrdE1Sigma1);
+    TH1F* excEnProtonCorrdE1Sigma2 = new TH1F("excEnProtonCorrdE1Sigma2", "Excitation Energy for dE1 2#sigma range after Eloss correction for protons", 5000, -5000, 5000); AddTistarHistogram(list, excEnProtonCorrdE1Sigma2);
+
+    TH1F* hdE1ElossRange = new TH1F("hdE1ElossRange", "corrected energy range in the first layer", 1000, -100., 3900.); AddTistarHistogram(list, hdE1ElossRange);
+    TH1F* hdE2ElossRange = new TH1F("hdE2ElossRange", "corrected energy range in the second layer", 2000, -1000., 9000.); AddTistarHistogram(list, hdE2ElossRange);
+    TH1F* hdE2ElossRangeWoEpad0 = new TH1F("hdE2ElossRangeWoEpad0", "corrected energy range in the second layer with Epad>0", 2000, -1000., 9000.); AddTistarHistogram(list, hdE2ElossRangeWoEpad0);
+    TH1F* hdE1Eloss = new TH1F("hdE1Eloss", "corrected energy loss in the first layer", 1000, -100., 9900.); AddTistarHistogram(list, hdE1Eloss);
+    TH1F* hdE2Eloss = new TH1F("hdE2Eloss", "corrected energy loss in the second layer", 2000, -100., 18900.); AddTistarHistogram(list, hdE2Eloss);
+    TH1F* hdE1Measured = new TH1F("hdE1Measured", "measured energy loss in the first layer", 1000, -100., 9900.); AddTistarHistogram(list, hdE1Measured);
+    TH1F* hdE2Measured = new TH1F("hdE2Measured", "measured energy loss in the second layer", 2000, -100., 18900.); AddTistarHistogram(list, hdE2Measured);
+    TH1F* hErestMeasured = new TH1F("hErestMeasured", "measured energy loss in the pad", 2000, -1000., 39000.); AddTistarHistogram(list, hErestMeasured);
+    TH2F* hdE1ElossVsMeasured = new TH2F("hdE1ElossVsMeasured", "corrected energy loss in the first layer vs measured", 1000, -100., 2400., 1000,-100.,2400.); AddTistarHistogram(list, hdE1ElossVsMeasured);
+    TH2F* hdE2ElossVsMeasuredWoEpad0 = new TH2F("hdE2ElossVsMeasuredWoEpad0", "corrected energy loss in the second layer vs measured for Epad>0", 2000, -100., 5400., 2000,-100.,5400.); AddTistarHistogram(list, hdE2ElossVsMeasuredWoEpad0);
+    TH2F* hdE2ElossVsMeasured = new TH2F("hdE2ElossVsMeasured", "corrected energy loss in the second layer vs measured", 2000, -100., 9400., 2000,-100.,9400.); AddTistarHistogram(list, hdE2ElossVsMeasured);
+    TH2F* dE2VsdE2Pad = new TH2F("dE2VsdE2Pad", "energy loss in second layer vs. dE2+pad energy", 2000, 0, 50000, 1000, 0, 10000); AddTistarHistogram(list, dE2VsdE2Pad);
+    TH2F* EPadVsThetaLab = new TH2F("EPadVsThetaLab", "pad energy vs theta lab", 720,0,180.,2000, -1000, 49000); AddTistarHistogram(list, EPadVsThetaLab);
+    TH2F* EPadVsZ = new TH2F("EPadVsZ", "pad energy vs z", 1000,-100.,100.,2000, -1000, 49000); AddTistarHistogram(list, EPadVsZ);
+    TH2F* dE2VsThetaLabEpadCut = new TH2F("dE2VsThetaLabEpadCut", "second layer energy vs theta lab for Epad=0", 720,0,180.,1000, -100, 4900); AddTistarHistogram(list, dE2VsThetaLabEpadCut);
+    TH2F* dE2VsEPadThetaCut = new TH2F("dE2VsEPadThetaCut", "energy loss in second layer vs. pad energy for Theta=40", 2000, -1000, 49000, 1000, -100, 9900); AddTistarHistogram(list, dE2VsEPadThetaCut);
+    TH2F* dE1VsThetaLab = new TH2F("dE1VsThetaLab", "first layer energy vs theta lab", 720,0,180.,2000, -100, 4900); AddTistarHistogram(list, dE1VsThetaLab);
+    TH2F* dE2VsThetaLab = new TH2F("dE2VsThetaLab", "second layer energy vs theta lab", 720,0,180.,2000, -100, 4900); AddTistarHistogram(list, dE2VsThetaLab);
+    TH2F* dE12VsThetaLab = new TH2F("dE12VsThetaLab", "first+second layer energy vs theta lab", 720,0,180.,2000, -100, 7900); AddTistarHistogram(list, dE12VsThetaLab);
+    TH2F* dE1EpadVsThetaLab = new TH2F("dE1EpadVsThetaLab", "first layer + pad energy vs theta lab", 720,0,180.,2000, -1000, 49900); AddTistarHistogram(list, dE1EpadVsThetaLab);
+    TH2F* dE2EpadVsThetaLab = new TH2F("dE2EpadVsThetaLab", "second layer + pad energy vs theta lab", 720,0,180.,2000, -1000, 49900); AddTistarHistogram(list, dE2EpadVsThetaLab);
+    TH2F* hdE1ElossVsMeasuredEpad0 = new TH2F("hdE1ElossVsMeasuredEpad0", "corrected energy loss in the first layer vs measured for Epad=0", 1000, -100., 2400., 1000,-100.,2400.); AddTistarHistogram(list, hdE1ElossVsMeasuredEpad0);
+    TH2F* hdE1ElossVsMeasuredEpadWo0 = new TH2F("hdE1ElossVsMeasuredEpadWo0", "corrected energy loss in the first layer vs measured for Epad>0", 1000, -100., 2400., 1000,-100.,2400.); AddTistarHistogram(list, hdE1ElossVsMeasuredEpadWo0);
+    TH1F* hdE1MeasMinRec = new TH1F("hdE1MeasMinRec", "(measured - reconstructed) energy loss in the first layer", 1000, -500., 500.); AddTistarHistogram(list, hdE1MeasMinRec);
+    TH1F* hdE2MeasMinRec = new TH1F("hdE2MeasMinRec", "(measured - reconstructed) energy loss in the second layer", 1000, -500., 500.); AddTistarHistogram(list, hdE2MeasMinRec);
+
+    TH2F* eRecErrVsESim = new TH2F("eRecErrVsESim", "error of reconstructed energy vs. simulated energy of recoil", 1000, 0., 25000., 1000, -5000., 5000.); AddTistarHistogram(list, eRecErrVsESim);
+    TH2F* thetaErrorVsZ = new TH2F("thetaErrorVsZ", "Error in #vartheta_{lab} reconstruction vs. simulated z-position;z [mm];#Delta#vartheta_{lab} [^{o}]", 200, -100, 100, 100, -15, 15); AddTistarHistogram(list, thetaErrorVsZ);
+    TH2F* thetaErrorVsTheta = new TH2F("thetaErrorVsTheta", "Error in #vartheta_{lab} reconstruction vs. simulated #vartheta_{lab};#vartheta_{lab} [^{o}];#Delta#vartheta_{lab} [^{o}]", 180, 0, 180, 100, -15, 15); AddTistarHistogram(list, thetaErrorVsTheta);
+    TH2F* thetaErrorVsThetaEpadCut = new TH2F("thetaErrorVsThetaEpadCut", "Error in #vartheta_{lab} reconstruction vs. simulated #vartheta_{lab};#vartheta_{lab} [^{o}];#Delta#vartheta_{lab} [^{o}] with Epad>0", 180, 0, 180, 100, -15, 15); AddTistarHistogram(list, thetaErrorVsThetaEpadCut);
+    TH2F* zReactionEnergy = new TH2F("zReactionEnergy", "z position of reaction vs. Beam energy (rec.)", 200, -100, 100, 1000, 0, 1.1*sett->GetBeamEnergy()); AddTistarHistogram(list, zReactionEnergy);
+    TH2F* excEnProtonVsTheta = new TH2F("excEnProtonVsTheta", "Excitation Energy Spectrum from reconstructed Protons;#vartheta_{lab}[^{o}];E_{exc} [keV]", 180, 0., 180., 5000, -20000, 20000); AddTistarHistogram(list, excEnProtonVsTheta);
+    TH2F* excEnProtonVsPhi = new TH2F("excEnProtonVsPhi", "Excitation Energy Spectrum from reconstructed Protons;#varphi_{lab}[^{o}];E_{exc} [keV]", 360, -180., 180., 5000, -20000, 20000); AddTistarHistogram(list, excEnProtonVsPhi);
+    TH2F* excEnProtonVsZ = new TH2F("excEnProtonVsZ", "Excitation Energy Spectrum from reconstructed Protons;z [mm];E_{exc} [keV]", 200, -100., 100., 5000, -20000, 20000); AddTistarHistogram(list, excEnProtonVsZ);
+    TH2F* excEnProtonVsThetaGS = new TH2F("excEnProtonVsThetaGS", "Excitation Energy Spectrum from reconstructed Protons, ground state only;#vartheta_{lab}[^{o}];E_{exc} [keV]", 180, 0., 180., 5000, -20000, 20000); AddTistarHistogram(list, excEnProtonVsThetaGS);
+    TH2F* excEnProtonVsZGS = new TH2F("excEnProtonVsZGS", "Excitation Energy Spectrum from reconstructed Protons, ground state only;z [mm];E_{exc} [keV]", 200, -100., 100., 5000, -20000, 20000); AddTistarHistogram(list, excEnProtonVsZGS);
+    TH2F* excEnProtonVsThetaCm = new TH2F("excEnProtonVsThetaCm", "Excitation Energy Spectrum from reconstructed Protons;#vartheta_{cm}[^{o}];E_{exc} [keV]", 180, 0., 180., 5000, -20000, 20000); AddTistarHistogram(list, excEnProtonVsThetaCm);
+    TH2F* thetaVsZ = new TH2F("thetaVsZ","#vartheta_{lab} vs. z", 200, -100., 100., 180, 0., 180.); AddTistarHistogram(list, thetaVsZ);
+    TH2F* thetaVsZSame = new TH2F("thetaVsZSame","#vartheta_{lab} vs. z, first and second layer both forward or both backward", 200, -100., 100., 180, 0., 180.); AddTistarHistogram(list, thetaVsZSame);
+
+    TH2F* thetaVsZCross = new TH2F("thetaVsZCross","#vartheta_{lab} vs. z, first and second layer over cross", 200, -100., 100., 180, 0., 180.); AddTistarHistogram(list, thetaVsZCross);
+    TH2F* phiVsZ = new TH2F("phiVsZ","#varphi_{lab} vs. z", 200, -100., 100., 360, -180., 180.); AddTistarHistogram(list, phiVsZ);
+    TH2F* hitpattern = new TH2F("hitpattern","detector # of second layer vs. detector # of first layer", 2, -0.5, 1.5, 2, -0.5, 1.5); AddTistarHistogram(list, hitpattern);
+    TH2F* eCmVsZ = new TH2F("eCmVsZ","energy of cm-system vs. z;z [mm];e-cm [GeV]", 200, -100., 100., 2000, transferP->GetCmEnergy(0.)/1000., transferP->GetCmEnergy(sett->GetBeamEnergy())/1000.); AddTistarHistogram(list, eCmVsZ);
+    TH2F* betaCmVsZ = new TH2F("betaCmVsZ","#beta of cm-system vs. z", 200, -100., 100., 2000, 0., 0.2); AddTistarHistogram(list, betaCmVsZ);
+    TH2F* stripPattern = new TH2F("stripPattern","Parallel strip # (#varphi) vs. perpendicular strip # (#vartheta)", 2*fSettings->GetTISTARnStripsY(0), 0., 2.*fSettings->GetTISTARnStripsY(0), 4*fSettings->GetTISTARnStripsZ(0), 0., 4.*fSettings->GetTISTARnStripsZ(0)); AddTistarHistogram(list, stripPattern);
+    TH2F* recBeamEnergyErrVsZ = new TH2F("recBeamEnergyErrVsZ","Error in reconstructed beam energy vs. z", 200, -100., 100., 1000, -50., 50.); AddTistarHistogram(list, recBeamEnergyErrVsZ);
+    TH2F* thetaCmVsThetaLab = new TH2F("thetaCmVsThetaLab", "#vartheta_{cm} vs. #vartheta_{lab};#vartheta_{cm} [^{o}];#vartheta_{lab} [^{o}]", 180,0.,180., 180,0.,180.); AddTistarHistogram(list, thetaCmVsThetaLab);
+    TH2F* zErrorVsThetaSim = new TH2F("zErrorVsThetaSim", "Error between reconstructed and true z-position vs. simulated #vartheta_{lab}", 180, 0., 180., 1000, -5, 5); AddTistarHistogram(list, zErrorVsThetaSim);
+    TH2F* zErrorVsThetaRec = new TH2F("zErrorVsThetaRec", "Error between reconstructed and true z-position vs. recon structed #vartheta_{lab}", 180, 0., 180., 1000, -5, 5); AddTistarHistogram(list, zErrorVsThetaRec);
+    TH2F* zErrorVsthetaError = new TH2F("zErrorVstheaError", "z Erorr vs error in theta", 200, -10., 10., 1000, -5., 5.); AddTistarHistogram(list, zErrorVsthetaError);
+    TH2F* elossVsTheta = new TH2F("elossVsTheta", "reconstructed energy loss vs. #vartheta;#vartheta_lab [^{o}];energy loss [keV]", 360, -180., 180., 10000, -100000., 100000.); AddTistarHistogram(list, elossVsTheta);
+    TH2F* elossVsPhi = new TH2F("elossVsPhi", "reconstructed energy loss vs. #varphi;#varphi_lab [^{o}];energy loss [keV]", 360, -180., 180., 1000, -10000., 10000.); AddTistarHistogram(list, elossVsPhi);
+    TH2F* excEnElossVsTheta = new TH2F("excEnElossVsTheta", "Excitation Energy Spectrum from reconstructed energy loss;#vartheta_{lab}[^{o}];E_{exc} [keV]", 360, -180., 180., 5000,-200000, 200000); AddTistarHistogram(list, excEnElossVsTheta);
+    TH2F* excEnElossVsThetaEpadCut = new TH2F("excEnElossVsThetaEpadCut", "Excitation Energy Spectrum from reconstructed energy loss;#vartheta_{lab}[^{o}];E_{exc} [keV] with Epad>0", 180, 0., 180., 5000, -20000, 20000); AddTistarHistogram(list, excEnElossVsThetaEpadCut);
 
     UInt_t nofLevels = fTISTARGenChain.GetMaximum("reaction")+1;
     if(nofLevels < 1) nofLevels = 1;
     if(nofLevels > 10) nofLevels = 10;
     std::vector<TH2F*> excEnElossVsThetaLevel(nofLevels);
     for(size_t r = 0; r < nofLevels; ++r) {
-        excEnElossVsThetaLevel[r] = new TH2F(Form("excEnElossVsThetaLevel_%d",static_cast<int>(r)), Form("Excitation Energy Spectrum from reconstructed energy loss for level %d;#vartheta_{lab}[^{o}];E_{exc} [keV]",static_cast<int>(r)), 180, 0., 180., 5000, -20000, 20000); fHistograms[directoryName.c_str()]->Add(excEnElossVsThetaLevel[r]);
+        excEnElossVsThetaLevel[r] = new TH2F(Form("excEnElossVsThetaLevel_%d",static_cast<int>(r)), Form("Excitation Energy Spectrum from reconstructed energy loss for level %d;#vartheta_{lab}[^{o}];E_{exc} [keV]",static_cast<int>(r)), 180, 0., 180., 5000, -20000, 20000); AddTistarHistogram(list, excEnElossVsThetaLevel[r]);
     }
 
     // particle-gamma matrices
-    TH1F* gammaSpec = new TH1F("gammaSpec", "generated gamma-ray spectrum", 10000, 0, 10000); fHistograms[directoryName.c_str()]->Add(gammaSpec);
-    TH1F* gammaSpecDoppCorr = new TH1F("gammaSpecDoppCorr", "generated gamma-ray spectrum with doppler correction", 10000, 0, 10000); fHistograms[directoryName.c_str()]->Add(gammaSpecDoppCorr);
-    TH1F* gammaSpecDoppCorrRes = new TH1F("gammaSpecDoppCorrRes", "generated gamma-ray spectrum with doppler correction w/ 1% resolution applied", 10000, 0, 10000); fHistograms[directoryName.c_str()]->Add(gammaSpecDoppCorrRes);
+    TH1F* gammaSpec = new TH1F("gammaSpec", "generated gamma-ray spectrum", 10000, 0, 10000); AddTistarHistogram(list, gammaSpec);
+    TH1F* gammaSpecDoppCorr = new TH1F("gammaSpecDoppCorr", "generated gamma-ray spectrum with doppler correction", 10000, 0, 10000); AddTistarHistogram(list, gammaSpecDoppCorr);
+    TH1F* gammaSpecDoppCorrRes = new TH1F("gammaSpecDoppCorrRes", "generated gamma-ray spectrum with doppler correction w/ 1% resolution applied", 10000, 0, 10000); AddTistarHistogram(list, gammaSpecDoppCorrRes);
 
-    TH2F* excEnProtonVsGamma = new TH2F("excEnProtonVsGamma", "Excitation Energy Spectrum from reconstructed Protons vs gamma ray energy", 5000, 0, 10000, 5000, -10000, 10000); fHistograms[directoryName.c_str()]->Add(excEnProtonVsGamma);
-    TH2F* excEnProtonVsGammaDoppCorr = new TH2F("excEnProtonVsGammaDoppCorr", "Excitation Energy Spectrum from reconstructed Protons vs gamma ray energy w/ doppler corrections", 5000, 0, 10000, 5000, -10000, 10000); fHistograms[directoryName.c_str()]->Add(excEnProtonVsGammaDoppCorr);
-    TH2F* excEnProtonVsGammaDoppCorrRes = new TH2F("excEnProtonVsGammaDoppCorrRes", "Excitation Energy Spectrum from reconstructed Protons vs gamma ray energy w/ doppler corrections and 1% resolution applied", 5000, 0, 10000, 5000, -10000, 10000); fHistograms[directoryName.c_str()]->Add(excEnProtonVsGammaDoppCorrRes);
+    TH2F* excEnProtonVsGamma = new TH2F("excEnProtonVsGamma", "Excitation Energy Spectrum from reconstructed Protons vs gamma ray energy", 5000, 0, 10000, 5000, -10000, 10000); AddTistarHistogram(list, excEnProtonVsGamma);
+    TH2F* excEnProtonVsGammaDoppCorr = new TH2F("excEnProtonVsGammaDoppCorr", "Excitation Energy Spectrum from reconstructed Protons vs gamma ray energy w/ doppler corrections", 5000, 0, 10000, 5000, -10000, 10000); AddTistarHistogram(list, excEnProtonVsGammaDoppCorr);
+    TH2F* excEnProtonVsGammaDoppCorrRes = new TH2F("excEnProtonVsGammaDoppCorrRes", "Excitation Energy Spectrum from reconstructed Protons vs gamma ray energy w/ doppler corrections and 1% resolution applied", 5000, 0, 10000, 5000, -10000, 10000); AddTistarHistogram(list, excEnProtonVsGammaDoppCorrRes);
 
     // for tigress
     // crystal
-    TH1F* tigressCryGammaSpec = new TH1F("tigressCryGammaSpec", "tigress gamma-ray spectrum", 10000, 0, 10000); fHistograms[directoryName.c_str()]->Add(tigressCryGammaSpec);
-    TH1F* tigressCryGammaSpecDoppCorr = new TH1F("tigressCryGammaSpecDoppCorr", "tigress gamma-ray spectrum with doppler correction", 10000, 0, 10000); fHistograms[directoryName.c_str()]->Add(tigressCryGammaSpecDoppCorr);
+    TH1F* tigressCryGammaSpec = new TH1F("tigressCryGammaSpec", "tigress gamma-ray spectrum", 10000, 0, 10000); AddTistarHistogram(list, tigressCryGammaSpec);
+    TH1F* tigressCryGammaSpecDoppCorr = new TH1F("tigressCryGammaSpecDoppCorr", "tigress gamma-ray spectrum with doppler correction", 10000, 0, 10000); AddTistarHistogram(list, tigressCryGammaSpecDoppCorr);
 
-    TH2F* tigressCryExcEnProtonVsGamma = new TH2F("tigressCryExcEnProtonVsGamma", "Excitation Energy Spectrum from reconstructed Protons vs tigress gamma ray energy", 5000, 0, 10000, 5000, -10000, 10000); fHistograms[directoryName.c_str()]->Add(tigressCryExcEnProtonVsGamma);
-    TH2F* tigressCryExcEnProtonVsGammaDoppCorr = new TH2F("tigressCryExcEnProtonVsGammaDoppCorr", "Excitation Energy Spectrum from reconstructed Protons vs tigress gamma ray energy w/ doppler corrections", 5000, 0, 10000, 5000, -10000, 10000); fHistograms[directoryName.c_str()]->Add(tigressCryExcEnProtonVsGammaDoppCorr);
+    TH2F* tigressCryExcEnProtonVsGamma = new TH2F("tigressCryExcEnProtonVsGamma", "Excitation Energy Spectrum from reconstructed Protons vs tigress gamma ray energy", 5000, 0, 10000, 5000, -10000, 10000); AddTistarHistogram(list, tigressCryExcEnProtonVsGamma);
+    TH2F* tigressCryExcEnProtonVsGammaDoppCorr = new TH2F("tigressCryExcEnProtonVsGammaDoppCorr", "Excitation Energy Spectrum from reconstructed Protons vs tigress gamma ray energy w/ doppler corrections", 5000, 0, 10000, 5000, -10000, 10000); AddTistarHistogram(list, tigressCryExcEnProtonVsGammaDoppCorr);
     // detector
-    TH1F* tigressDetGammaSpec = new TH1F("tigressDetGammaSpec", "tigress gamma-ray spectrum", 10000, 0, 10000); fHistograms[directoryName.c_str()]->Add(tigressDetGammaSpec);
-    TH1F* tigressDetGammaSpecDoppCorr = new TH1F("tigressDetGammaSpecDoppCorr", "tigress gamma-ray spectrum with doppler correction", 10000, 0, 10000); fHistograms[directoryName.c_str()]->Add(tigressDetGammaSpecDoppCorr);
+    TH1F* tigressDetGammaSpec = new TH1F("tigressDetGammaSpec", "tigress gamma-ray spectrum", 10000, 0, 10000); AddTistarHistogram(list, tigressDetGammaSpec);
+    TH1F* tigressDetGammaSpecDoppCorr = new TH1F("tigressDetGammaSpecDoppCorr", "tigress gamma-ray spectrum with doppler correction", 10000, 0, 10000); AddTistarHistogram(list, tigressDetGammaSpecDoppCorr);
 
-    TH2F* tigressDetExcEnProtonVsGamma = new TH2F("tigressDetExcEnProtonVsGamma", "Excitation Energy Spectrum from reconstructed Protons vs tigress gamma ray energy", 5000, 0, 10000, 5000, -10000, 10000); fHistograms[directoryName.c_str()]->Add(tigressDetExcEnProtonVsGamma);
-    TH2F* tigressDetExcEnProtonVsGammaDoppCorr = new TH2F("tigressDetExcEnProtonVsGammaDoppCorr", "Excitation Energy Spectrum from reconstructed Protons vs tigress gamma ray energy w/ doppler corrections", 5000, 0, 10000, 5000, -10000, 10000); fHistograms[directoryName.c_str()]->Add(tigressDetExcEnProtonVsGammaDoppCorr);
+    TH2F* tigressDetExcEnProtonVsGamma = new TH2F("tigressDetExcEnProtonVsGamma", "Excitation Energy Spectrum from reconstructed Protons vs tigress gamma ray energy", 5000, 0, 10000, 5000, -10000, 10000); AddTistarHistogram(list, tigressDetExcEnProtonVsGamma);
+    TH2F* tigressDetExcEnProtonVsGammaDoppCorr = new TH2F("tigressDetExcEnProtonVsGammaDoppCorr", "Excitation Energy Spectrum from reconstructed Protons vs tigress gamma ray energy w/ doppler corrections", 5000, 0, 10000, 5000, -10000, 10000); AddTistarHistogram(list, tigressDetExcEnProtonVsGammaDoppCorr);
 }
 
 
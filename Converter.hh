@@ -8,6 +8,7 @@
 #include "TChain.h"
 #include "TFile.h"
 #include "TTree.h"
+#include "TEntryList.h"
 #include "TRandom3.h"
 #include "TH1F.h"
 #include "TH2F.h"
@@ -22,57 +23,160 @@
 #include "Particle.hh"
 #include "ParticleMC.hh"
 #include "Kinematics.hh"
+#include "EventBuilder.hh"
+#include "RNTupleOutput.hh"
 
 class Converter {
 public:
-    Converter(std::vector<std::string>&, const std::string&, Settings*);
+    Converter(std::vector<std::string>&, const std::string&, Settings*, bool append = false);
     ~Converter();
 
     bool Run();
 
 private:
-    bool AboveThreshold(double, int);
-    bool InsideTimeWindow();
+    void SetInputBranches(TChain& chain);
+    Int_t ReadEntry(Long64_t entry);
+    std::string CurrentInputFileName(); // file of the last entry read
+    bool Sampled(Long64_t eventIndex, Int_t eventNumber);
+    TEntryList* BuildEntryList();
+    void OpenSkim(const std::string& fileName);
+
+    // one strip or ring of a TI-STAR panel, A, Z, track ID, time, and position are those of the first step in it
+    struct TistarChannel {
+        bool fHit;
+        double fEnergy;
+        int fA;
+        int fZ;
+        int fTrackID;
+        double fTime;
+        TVector3 fPos;
+        int fStopped;
+    };
+    // Strips and rings are indexed directly by their number + 1 (index 0 collects the steps outside of the panel,
+    // which get number -1), the hit lists keep the numbers in the order they were first hit, and are all that
+    // needs to be reset after an event.
+    struct TistarPanel {
+        std::vector<TistarChannel> fStrips;
+        std::vector<TistarChannel> fRings;
+        std::vector<int> fHitStrips;
+        std::vector<int> fHitRings;
+    };
+
+    // flat output schema (see Settings::FlatTree)
+    struct FlatBranch {
+        std::string fName;
+        std::vector<Detector>* fHits;
+        Int_t fN;
+        std::vector<Int_t> fDetector;
+        std::vector<Int_t> fCrystal;
+        std::vector<Float_t> fEnergy;
+        std::vector<Float_t> fSimulationEnergy;
+        std::vector<Float_t> fX;
+        std::vector<Float_t> fY;
+        std::vector<Float_t> fZ;
+        std::vector<Double_t> fTime;
+        // array branches in the order of the fields above
+        std::vector<TBranch*> fBranches;
+    };
+    // append mode: input files already included in an existing output file, and its histograms
+    std::vector<std::string> ReadInputFileRecord(const std::string& fileName);
+    void LoadHistograms();
+    void SetCompression(TFile* file);
+    void WriteHistograms();
+    void AddOutputBranch(const std::string& name, std::vector<Detector>*& hits);
+    void AddTreeBranch(const std::string& name, std::vector<Detector>*& hits);
+    void SetFlatCapacity(FlatBranch& branch, size_t capacity);
+    void FillTree(Int_t eventNumber);
+    void WriteSkimEvent();
+    bool AboveThreshold(double, int, int, int);
+    bool InsideTimeWindow(int, int, int, double);
+    void AddSimulatedHit(Int_t eventNumber, Int_t systemID, Int_t detNumber, Int_t cryNumber, Double_t depEnergy, const TVector3& position, Double_t time);
+
+    // pile-up overlay (see Settings::OverlayRate)
+    struct SimulatedHit {
+        Int_t fSystemID;
+        Int_t fDetNumber;
+        Int_t fCryNumber;
+        Double_t fDepEnergy;
+        TVector3 fPosition;
+        Double_t fTime;
+    };
+    void OverlayEvents(Int_t eventNumber);
     bool DescantNeutronDiscrimination();
+    void MergeHits(std::vector<Detector>* hits, bool byCrystal);
+
+    // detector systems, one entry per system ID (or group of IDs) that produces hits
+    enum EMergeRule { kNoMerge, kMergeByDetector, kMergeByCrystal };
+    struct DetectorSystem {
+        std::string fName;
+        std::vector<Detector>* fHits;
+        // optional copies of the hits sorted by detector number (TI-STAR layers)
+        std::vector<std::vector<Detector>*> fLayers;
+        EMergeRule fMerge;
+        // optional flag set once the system has a hit in this event
+        bool* fFired;
+        // optional histogram hook, only called for systems with hits
+        void (Converter::*fFillHistograms)();
+        // the hook changes hits that are written to the tree, so it is called before the tree is filled
+        bool fBeforeTree;
+        bool fActive;
+    };
+    int RegisterSystem(const std::string& name, std::vector<Detector>* hits, EMergeRule merge, void (Converter::*fillHistograms)() = nullptr, bool* fired = nullptr, bool beforeTree = false);
+    void MapSystem(int systemId, int index);
+    void AddHit(int index, Detector& hit);
+    void MergeActiveSystems();
+    void FillActiveSystemHistograms(bool beforeTree);
+    void ClearActiveSystems();
+    void FillGriffinHistograms();
+    void FillLaBrHistograms();
+    void FillEightPiHistograms();
+    void FillSceptarHistograms();
+    void FillDescantHistograms();
+    void FillTestcanHistograms();
+    void FillPacesHistograms();
+    void FillTistarHistograms();
 
     // GRIFFIN
-    void CheckGriffinCrystalAddback();
+    // suppression conditions, one bit each in the veto mask of a GRIFFIN detector
+    enum EGriffinVeto { kGriffinBgoVeto = 1, kGriffinAncillaryBgoVeto = 2, kGriffinSceptarVeto = 4 };
+    void ClassifyGriffin();
+    bool GriffinVetoed(UInt_t vetoMask) {
+        return (fGriffinVetoed & vetoMask) != 0;
+    }
+    bool GriffinVetoed(Detector& hit, UInt_t vetoMask);
+    void RemoveVetoed(std::vector<Detector>* detector, UInt_t vetoMask);
     void SupressGriffin();
-    void SupressGriffinByNeighbouringAncillaryBgos();
-    void SupressGriffinBySceptar();
     void AddbackGriffin();
+    void AddbackGriffinArray();
     void AddbackGriffinNeighbour();
     void AddbackGriffinNeighbourVector();
     // LaBr
-    void CheckLaBrDetectorAddback();
     void SupressLaBr();
     void SupressLaBrByNeighbouringGriffinShields();
     void AddbackLaBr();
     // EightPi
-    void CheckEightPiDetectorAddback();
     void SupressEightPi();
     void AddbackEightPi();
     // Ancillary BGO
-    void CheckAncillaryBgoCrystalAddback();
     void AddbackAncillaryBgo();
     // SCEPTAR
-    void CheckSceptarDetectorAddback();
     void AddbackSceptar();
     // DESCANT
-    void CheckDescantDetectorAddback();
     void AddbackDescant();
     // Paces
-    void CheckPacesDetectorAddback();
     void AddbackPaces();
     
     // TI-STAR
     int CalculateTistarStripNumber(int layerNb, TVector3 particlePos, TVector3 stripPos, TVector3 stripDim);
     int CalculateTistarRingNumber (int layerNb, TVector3 particlePos, TVector3 stripPos, TVector3 stripDim);
     void FillTistarVectors();
+    void AddTistarChannelHit(std::vector<TistarChannel>& channels, std::vector<int>& hitChannels, int number, const TVector3& position);
     void ClearTistarVectors();
     void FillTistarParticleMCs();
     void ClearTistarParticleMCs();
     void CreateTistarHistograms(Kinematics*);
+    void AddTistarHistogram(TList* list, TH1* hist);
+    void WriteSetupObject(TObject* object, const char* name);
 
     void PrintStatistics();
 
@@ -81,19 +185,25 @@ private:
     TH2F* Get2DHistogram(std::string, std::string, int, double, double, int, double, double);
     TH2F* Get2DHistogram(std::string, std::string);
     //TH3I* Get3DHistogram(std::string, std::string);
-    THnSparseF* GetNDHistogram(std::string, std::string);
+    THnSparseF* GetNDHistogram(std::string, std::string, int nofAngles);
 
-    void FillHistDetector1DGamma(TH1F* hist1D, std::vector<Detector>* detector, std::string hist_name, std::string hist_dir);
-    void FillHistDetector2DGammaGamma(TH2F* hist2D, std::vector<Detector>* detector, std::string hist_name, std::string hist_dir);
+    void FillHistDetector1DGamma(TH1F* hist1D, std::vector<Detector>* detector, std::string hist_name, std::string hist_dir, UInt_t vetoMask = 0);
+    void FillHistDetector2DGammaGamma(TH2F* hist2D, std::vector<Detector>* detector, std::string hist_name, std::string hist_dir, UInt_t vetoMask = 0);
 
-    void FillHistDetector1DGammaNR(TH1F* hist1D, std::vector<Detector>* detector, std::string hist_name, std::string hist_dir);
-    void FillHistDetector2DGammaGammaNR(TH2F* hist2D, std::vector<Detector>* detector, std::string hist_name, std::string hist_dir);
+    void FillHistDetector1DGammaNR(TH1F* hist1D, std::vector<Detector>* detector, std::string hist_name, std::string hist_dir, UInt_t vetoMask = 0);
+    void FillHistDetector2DGammaGammaNR(TH2F* hist2D, std::vector<Detector>* detector, std::string hist_name, std::string hist_dir, UInt_t vetoMask = 0);
 
     void FillHist2DGriffinSceptarHitPattern(TH2F* hist2D, std::vector<Detector>* detector1, std::vector<Detector>* detector2, std::string hist_name, std::string hist_dir);
     void FillHist2DGriffinHitPattern(TH2F* hist2D, std::vector<Detector>* detector, std::string hist_name, std::string hist_dir);
 
+    ULong64_t DetectorMask(std::vector<Detector>* detector);
+    ULong64_t CrystalMask(std::vector<Detector>* detector, int nofCrystals);
+    void RemoveSupressed(std::vector<Detector>* detector, const ULong64_t* suppressorMask, int nofDetectors, ULong64_t firedMask);
+
+    bool ReadGeometry(const std::string& fileName);
+    void CompileGeometry();
+
     TVector3 GriffinCrystalCenterPosition(int cry, int det);
-    bool AreGriffinCrystalCenterPositionsWithinVectorLength(int cry1, int det1, int cry2, int det2);
 
     double transX(double x, double y, double z, double theta, double phi);
     double transY(double x, double y, double z, double theta, double phi);
@@ -101,6 +211,38 @@ private:
 
     Settings* fSettings;
     TChain fChain;
+    // only used if the input files are merged hit by hit (see Settings::UseEventBuilder)
+    EventBuilder* fEventBuilder;
+    // entries of the events accepted by the prescan (see Settings::Prescan and Settings::Sampling)
+    TEntryList* fEntryList;
+    // separate from fRandom, so the sampled events don't depend on anything else
+    TRandom3 fSampleRandom;
+
+    // skim of the raw hits and generator entries of selected events (see Settings::SkimFile)
+    struct RawHit {
+        Int_t fEventNumber;
+        Int_t fTrackID;
+        Int_t fParentID;
+        Int_t fStepNumber;
+        Int_t fParticleType;
+        Int_t fProcessType;
+        Int_t fSystemID;
+        Int_t fDetNumber;
+        Int_t fCryNumber;
+        Double_t fDepEnergy;
+        Double_t fPosx;
+        Double_t fPosy;
+        Double_t fPosz;
+        Double_t fTime;
+        Int_t fTargetZ;
+        Double_t fTargetA;
+    };
+    TFile* fSkimFile;
+    TTree* fSkimTree;
+    TTree* fSkimGenTree;
+    RawHit fSkimHit;
+    std::vector<RawHit> fSkimHits;
+    Int_t fSkimNofEvents;
     TFile* fOutput;
     TTree fTree;
     TRandom3 fRandom;
@@ -113,18 +255,42 @@ private:
 
     Int_t GriffinSceptarSuppressors_det[16][4];
 
+    // bitmasks of the suppressors of each detector, built from the tables above
+    // ancillary bgo bit = 3*det + cry, sceptar bit = det, griffin shield bit = 4*det + cry
+    ULong64_t GriffinAncillaryBgoMask[16];
+    ULong64_t GriffinSceptarMask[16];
+    ULong64_t LaBrGriffinShieldMask[8];
+
     Int_t GriffinNeighbours_counted[16];
     Int_t GriffinNeighbours_det[16][4];
+    // bit n set if detector n is the detector itself or one of its neighbours (either direction)
+    UInt_t GriffinNeighbourMask[16];
+
+    // per-event veto mask of each GRIFFIN detector (see EGriffinVeto), and all vetoes of this event or'ed together
+    UInt_t fGriffinVeto[16];
+    UInt_t fGriffinVetoed;
+
+    // per-event slots, index of the addback entry for each detector or -1
+    int fGriffinDetectorSlot[16];
+    int fGriffinNeighbourSlot[16];
 
     double GriffinDetCoords[16][5];
 
+    // angles between crystals/detectors, the distinct angles with their number of occurrences,
+    // and for each pair the index of its angle in that list
     double GriffinCryMap[64][64];
-    double GriffinCryMapCombos[52][2];
+    double GriffinCryMapCombos[64*64][2];
+    int GriffinCryMapNofCombos;
+    int GriffinCryMapIndex[64][64];
 
     double GriffinDetMap[16][16];
-    double GriffinDetMapCombos[7][2];
+    double GriffinDetMapCombos[16*16][2];
+    int GriffinDetMapNofCombos;
+    int GriffinDetMapIndex[16][16];
 
     TVector3 GriffinCrystalCenterVectors[64];
+    // bit n of entry m is set if the centres of crystals m and n (4*det + cry) are within GriffinAddbackVectorLengthmm
+    ULong64_t GriffinCrystalVectorLengthMask[64];
 
     //branches of input tree/chain
     Int_t fEventNumber;
@@ -199,8 +365,41 @@ private:
     std::vector<Detector>* fTISTARLayer2;
     std::vector<Detector>* fTISTARLayer3;
     
+    // registered detector systems, index into them by system ID (-1 = unknown),
+    // and the systems that had hits in the current event
+    std::vector<DetectorSystem> fSystems;
+    std::vector<int> fSystemIndex;
+    std::vector<int> fActiveSystems;
+
+    // raw hits of the current event, and a ring buffer of the raw hits of recent events (empty if there is no overlay)
+    std::vector<SimulatedHit> fOverlayCurrent;
+    std::vector<std::vector<SimulatedHit> > fOverlayEvents;
+    size_t fOverlayNext;
+    size_t fOverlayFilled;
+
+    // hits rejected in the current event, per system ID
+    std::map<int,int> fBelowThreshold;
+    std::map<int,int> fOutsideTimeWindow;
+
+    // scratch space for MergeHits, kept to avoid allocations every event
+    std::vector<std::pair<std::pair<int,int>,size_t> > fMergeKeys;
+    std::vector<bool> fMergeRemove;
+
+    // flat output branches, only used with the flat schema
+    std::vector<FlatBranch*> fFlatBranches;
+    Int_t fFlatEventNumber;
+
+    // RNTuple output, replaces the tree if Settings::OutputFormat is "RNTuple"
+    std::vector<std::pair<std::string, std::vector<Detector>*> > fOutputCollections;
+    RNTupleOutput* fNTupleOutput;
+    bool fUseRNTuple;
+
     //histograms
     std::map<std::string,TList*> fHistograms;
+    // all input files included in the output, written to it as "inputFiles"
+    std::vector<std::string> fInputFiles;
+    bool fAppend;
+    bool fNothingToAppend; // all input files were already included in the output
     
     // from the TRex-derived generator tree for TI-STAR
     TChain fTISTARGenChain; 
@@ -231,37 +430,8 @@ private:
     // then once the last hit/entry of the ntuple has been processed
     // for that given event, we will fill the ParticleMC class and do
     // the TI-STAR analysis
-    std::vector<int>        fTISTARFirstLayerStripNb[4];
-    std::vector<double>     fTISTARFirstLayerStripEnergy[4];
-    std::vector<int>        fTISTARFirstLayerStripA[4];
-    std::vector<int>        fTISTARFirstLayerStripZ[4];
-    std::vector<int>        fTISTARFirstLayerStripTrackID[4];
-    std::vector<double>     fTISTARFirstLayerStripTime[4];
-    std::vector<TVector3>   fTISTARFirstLayerStripPos[4]; // leila
-    std::vector<int>        fTISTARFirstLayerStripStopped[4];
-    std::vector<int>        fTISTARFirstLayerRingNb[4];
-    std::vector<double>     fTISTARFirstLayerRingEnergy[4];
-    std::vector<int>        fTISTARFirstLayerRingA[4];
-    std::vector<int>        fTISTARFirstLayerRingZ[4];
-    std::vector<int>        fTISTARFirstLayerRingTrackID[4];
-    std::vector<double>     fTISTARFirstLayerRingTime[4];
-    std::vector<int>        fTISTARFirstLayerRingStopped[4];
-    
-    std::vector<int>        fTISTARSecondLayerStripNb[2];
-    std::vector<double>     fTISTARSecondLayerStripEnergy[2];
-    std::vector<int>        fTISTARSecondLayerStripA[2];
-    std::vector<int>        fTISTARSecondLayerStripZ[2];
-    std::vector<int>        fTISTARSecondLayerStripTrackID[2];
-    std::vector<double>     fTISTARSecondLayerStripTime[2];
-    std::vector<TVector3>   fTISTARSecondLayerStripPos[2]; // leila
-    std::vector<int>        fTISTARSecondLayerStripStopped[2];
-    std::vector<int>        fTISTARSecondLayerRingNb[2];
-    std::vector<double>     fTISTARSecondLayerRingEnergy[2];
-    std::vector<int>        fTISTARSecondLayerRingA[2];
-    std::vector<int>        fTISTARSecondLayerRingZ[2];
-    std::vector<int>        fTISTARSecondLayerRingTrackID[2];
-    std::vector<double>     fTISTARSecondLayerRingTime[2];
-    std::vector<int>        fTISTARSecondLayerRingStopped[2];
+    TistarPanel fTISTARFirstLayer[4];
+    TistarPanel fTISTARSecondLayer[2];
 
 };
 
@@ -0,0 +1,66 @@
+#include "EnergyLossTable.hh"
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+EnergyLossTable::EnergyLossTable()
+    : fMaxEnergy(0.), fMaxPathFactor(1.), fNofEnergies(0), fNofPathFactors(0), fInvEnergyStep(0.), fInvPathFactorStep(0.), fMaxError(0.), fNofInaccurateCells(0) {
+}
+
+void EnergyLossTable::AddLayer(const TabulatedFunction* range, const TabulatedFunction* energy, double thickness) {
+    Layer layer;
+    layer.fRange = range;
+    layer.fEnergy = energy;
+    layer.fThickness = thickness;
+    fLayers.push_back(layer);
+}
+
+double EnergyLossTable::Trace(double energy, double pathFactor) const {
+    for(auto layer = fLayers.begin(); layer != fLayers.end(); ++layer) {
+        energy = layer->fEnergy->Eval(layer->fRange->Eval(energy) + layer->fThickness*pathFactor);
+    }
+    return energy;
+}
+
+void EnergyLossTable::Build(double maxEnergy, size_t nofEnergies, double maxPathFactor, size_t nofPathFactors, double maxError) {
+    if(nofEnergies < 2 || nofPathFactors < 2 || maxEnergy <= 0. || maxPathFactor <= 1.) {
+        std::cerr<<"Can't build energy loss table with "<<nofEnergies<<" energies up to "<<maxEnergy<<" keV and "<<nofPathFactors<<" path factors up to "<<maxPathFactor<<"!"<<std::endl;
+        fValues.clear();
+        return;
+    }
+    fMaxEnergy = maxEnergy;
+    fMaxPathFactor = maxPathFactor;
+    fNofEnergies = nofEnergies;
+    fNofPathFactors = nofPathFactors;
+    double energyStep = maxEnergy/(nofEnergies - 1);
+    double pathFactorStep = (maxPathFactor - 1.)/(nofPathFactors - 1);
+    fInvEnergyStep = 1./energyStep;
+    fInvPathFactorStep = 1./pathFactorStep;
+
+    fValues.resize(nofEnergies*nofPathFactors);
+    for(size_t j = 0; j < nofPathFactors; ++j) {
+        for(size_t i = 0; i < nofEnergies; ++i) {
+            fValues[j*nofEnergies + i] = Trace(i*energyStep, 1. + j*pathFactorStep);
+        }
+    }
+
+    // The bilinear interpolation is worst in the middle of the cells. Cells where it is off by more than maxError
+    // (e.g. across the stopping threshold, where the energy before the stack jumps) are left to Trace.
+    fAccurate.assign(nofEnergies*nofPathFactors, true);
+    fMaxError = 0.;
+    fNofInaccurateCells = 0;
+    for(size_t j = 0; j + 1 < nofPathFactors; ++j) {
+        for(size_t i = 0; i + 1 < nofEnergies; ++i) {
+            double energy = (i + 0.5)*energyStep;
+            double pathFactor = 1. + (j + 0.5)*pathFactorStep;
+            double error = std::fabs(Eval(energy, pathFactor) - Trace(energy, pathFactor));
+            if(error > maxError) {
+                fAccurate[j*nofEnergies + i] = false;
+                ++fNofInaccurateCells;
+            } else {
+                fMaxError = std::max(fMaxError, error);
+            }
+        }
+    }
+}
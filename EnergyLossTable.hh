@@ -0,0 +1,89 @@
+#ifndef __ENERGYLOSSTABLE_HH
+#define __ENERGYLOSSTABLE_HH
+
+#include <vector>
+#include <cstddef>
+
+#include "TabulatedFunction.hh"
+
+// Energy loss through a stack of layers the particle crosses with the same path factor (path length over thickness),
+// tabulated as energy before the stack over a uniform grid of (energy after the stack, path factor). Tracing a particle
+// back through n layers takes 2n range/energy lookups, with the table it is one bilinear interpolation.
+class EnergyLossTable {
+public:
+    EnergyLossTable();
+
+    // Layers are added in the order the particle is traced back, i.e. starting with the one it crossed last. The range
+    // and energy tables are the ones from Reconstruction::Energy2Range and Range2Energy (keV and mg/cm^2), the thickness
+    // is in mg/cm^2. The tables are not owned by the stack.
+    void AddLayer(const TabulatedFunction* range, const TabulatedFunction* energy, double thickness);
+    // tabulates the stack for energies from 0 to maxEnergy (in keV) and path factors from 1 to maxPathFactor,
+    // cells where the interpolation deviates by more than maxError (in keV) from the traced energy aren't used
+    void Build(double maxEnergy, size_t nofEnergies, double maxPathFactor, size_t nofPathFactors, double maxError);
+
+    // energy before the stack, traced back layer by layer
+    double Trace(double energy, double pathFactor) const;
+
+    // false outside the grid and in cells that aren't accurate enough, those have to be traced
+    bool Contains(double energy, double pathFactor) const {
+        if(fValues.empty() || energy < 0. || energy > fMaxEnergy || pathFactor < 1. || pathFactor > fMaxPathFactor) {
+            return false;
+        }
+        return fAccurate[Cell(energy, pathFactor)];
+    }
+
+    // energy before the stack from the table, only valid if Contains(energy, pathFactor) is true
+    double Eval(double energy, double pathFactor) const {
+        size_t cell = Cell(energy, pathFactor);
+        double u = energy*fInvEnergyStep - cell%fNofEnergies;
+        double v = (pathFactor - 1.)*fInvPathFactorStep - cell/fNofEnergies;
+        const double* low = &fValues[cell];
+        const double* high = low + fNofEnergies;
+        return (1. - v)*((1. - u)*low[0] + u*low[1]) + v*((1. - u)*high[0] + u*high[1]);
+    }
+
+    size_t GetNofLayers() const {
+        return fLayers.size();
+    }
+    // largest deviation of the table from the traced energies found in the middle of the cells that are used
+    double GetMaxError() const {
+        return fMaxError;
+    }
+    // number of cells that exceeded the error limit and are traced instead
+    size_t GetNofInaccurateCells() const {
+        return fNofInaccurateCells;
+    }
+
+private:
+    // index of the lower left grid point of the cell, the last grid point belongs to the last cell
+    size_t Cell(double energy, double pathFactor) const {
+        size_t i = static_cast<size_t>(energy*fInvEnergyStep);
+        size_t j = static_cast<size_t>((pathFactor - 1.)*fInvPathFactorStep);
+        if(i + 1 >= fNofEnergies) i = fNofEnergies - 2;
+        if(j + 1 >= fNofPathFactors) j = fNofPathFactors - 2;
+        return j*fNofEnergies + i;
+    }
+
+    struct Layer {
+        const TabulatedFunction* fRange;
+        const TabulatedFunction* fEnergy;
+        double fThickness;
+    };
+
+    std::vector<Layer> fLayers;
+
+    double fMaxEnergy;
+    double fMaxPathFactor;
+    size_t fNofEnergies;
+    size_t fNofPathFactors;
+    double fInvEnergyStep;
+    double fInvPathFactorStep;
+    // energies before the stack, index is path factor bin times number of energies plus energy bin
+    std::vector<double> fValues;
+    // same index as the lower left grid point of each cell
+    std::vector<bool> fAccurate;
+    double fMaxError;
+    size_t fNofInaccurateCells;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "EventBuilder.hh"
+
+#include <iostream>
+
+EventBuilder::EventBuilder()
+    : fCurrentStream(-1) {
+}
+
+EventBuilder::~EventBuilder() {
+    for(auto stream = fStreams.begin(); stream != fStreams.end(); ++stream) {
+        delete (*stream)->fKeys;
+        delete (*stream)->fHits;
+        delete *stream;
+    }
+}
+
+bool EventBuilder::Later::operator()(const Head& left, const Head& right) const {
+    // priority_queue puts the largest element on top, so "later" hits have to compare as smaller
+    if(left.fEventNumber != right.fEventNumber) {
+        return left.fEventNumber > right.fEventNumber;
+    }
+    if(left.fTime != right.fTime) {
+        return left.fTime > right.fTime;
+    }
+    if(left.fStream != right.fStream) {
+        return left.fStream > right.fStream;
+    }
+    return left.fEntry > right.fEntry;
+}
+
+void EventBuilder::AddStream(TChain* stream) {
+    Stream* newStream = new Stream;
+    newStream->fHits = stream;
+    newStream->fKeys = new TChain(stream->GetName());
+    newStream->fKeys->Add(stream);
+    newStream->fKeys->SetBranchStatus("*", 0);
+    newStream->fKeys->SetBranchStatus("eventNumber", 1);
+    newStream->fKeys->SetBranchStatus("time", 1);
+    newStream->fKeys->SetBranchAddress("eventNumber", &(newStream->fEventNumber));
+    newStream->fKeys->SetBranchAddress("time", &(newStream->fTime));
+    newStream->fNextEntry = 0;
+    fStreams.push_back(newStream);
+}
+
+void EventBuilder::Start() {
+    while(!fHeads.empty()) {
+        fHeads.pop();
+    }
+    for(size_t stream = 0; stream < fStreams.size(); ++stream) {
+        fStreams[stream]->fNextEntry = 0;
+        Push(stream);
+    }
+    fCurrentStream = -1;
+}
+
+void EventBuilder::Push(size_t stream) {
+    // read the keys of the next hit of this stream and put it in the heap, exhausted streams simply drop out
+    Stream* current = fStreams[stream];
+    Int_t status = current->fKeys->GetEntry(current->fNextEntry);
+    if(status <= 0) {
+        if(status == -1) {
+            std::cerr<<"Error occured, couldn't read entry "<<current->fNextEntry<<" from stream "<<stream<<", dropping the rest of this stream"<<std::endl;
+        }
+        return;
+    }
+    Head head;
+    head.fEventNumber = current->fEventNumber;
+    head.fTime = current->fTime;
+    head.fStream = stream;
+    head.fEntry = current->fNextEntry;
+    fHeads.push(head);
+    ++(current->fNextEntry);
+}
+
+Int_t EventBuilder::Next() {
+    if(fHeads.empty()) {
+        fCurrentStream = -1;
+        return 0;
+    }
+    Head head = fHeads.top();
+    fHeads.pop();
+    fCurrentStream = head.fStream;
+    // the key chain is separate, so the next hit of this stream can be queued before this one is read
+    Push(head.fStream);
+    return fStreams[head.fStream]->fHits->GetEntry(head.fEntry);
+}
+
+Long64_t EventBuilder::GetEntries() {
+    Long64_t entries = 0;
+    for(auto stream = fStreams.begin(); stream != fStreams.end(); ++stream) {
+        entries += (*stream)->fHits->GetEntries();
+    }
+    return entries;
+}
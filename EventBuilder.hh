@@ -0,0 +1,67 @@
+#ifndef __EVENTBUILDER_HH
+#define __EVENTBUILDER_HH
+
+#include <vector>
+#include <queue>
+#include <cstddef>
+
+#include "TChain.h"
+
+// Merges several input streams (e.g. a signal and a background simulation) hit by hit,
+// ordered by event number and time, so the hits of an event end up contiguous
+// without having to merge and sort the ntuples beforehand.
+// Each stream has to be ordered itself, only the next hit of each stream is kept in the heap.
+class EventBuilder {
+public:
+    EventBuilder();
+    ~EventBuilder();
+
+    // takes ownership of the chain, whose branch addresses have to be set by the caller
+    void AddStream(TChain* stream);
+    // reads the first hit of every stream, has to be called after all streams have been added
+    void Start();
+    // reads the next hit into the branch addresses of its stream, returns the status of TChain::GetEntry,
+    // or 0 once all streams are exhausted
+    Int_t Next();
+
+    Long64_t GetEntries();
+    size_t NofStreams() {
+        return fStreams.size();
+    }
+    // stream and entry of the last hit returned by Next
+    int CurrentStream() {
+        return fCurrentStream;
+    }
+    TChain* CurrentChain() {
+        return fCurrentStream >= 0 ? fStreams[fCurrentStream]->fHits : nullptr;
+    }
+
+private:
+    struct Stream {
+        TChain* fHits;
+        // second chain on the same files reading only the ordering keys
+        TChain* fKeys;
+        Int_t fEventNumber;
+        Double_t fTime;
+        Long64_t fNextEntry;
+    };
+
+    struct Head {
+        Int_t fEventNumber;
+        Double_t fTime;
+        size_t fStream;
+        Long64_t fEntry;
+    };
+
+    struct Later {
+        bool operator()(const Head& left, const Head& right) const;
+    };
+
+    void Push(size_t stream);
+
+    std::vector<Stream*> fStreams;
+    std::priority_queue<Head, std::vector<Head>, Later> fHeads;
+    int fCurrentStream;
+};
+
+#endif
@@ -30,6 +30,7 @@ public:
   void FinalCm();
   void Final(double angle, int part, bool upper = false);
   void SetEBeam (double ebeam) { fEBeam = ebeam; Initial(); };
+  double GetEBeam() { return fEBeam; }
   //void SetAngles(double angle, int part);
   void SetAngles(double angle, int part, bool upper=false);
   //get
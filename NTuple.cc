@@ -22,6 +22,8 @@ int main(int argc, char** argv) {
     interface.Add("-if","input file(s) (required)",&inputFileNames);
     std::string outputFileName = "Converted.root";
     interface.Add("-of","output file (default = 'Converted.root')",&outputFileName);
+    bool append = false;
+    interface.Add("-append","add the input files to the histograms of an existing output file, skipping files it already includes (requires WriteTree and Histograms.SeparateFiles to be false)",&append);
     int verbosityLevel = 0;
     interface.Add("-vl","verbosity level (default = 0)",&verbosityLevel);
 
@@ -46,7 +48,7 @@ int main(int argc, char** argv) {
     Settings settings(settingsFileName, verbosityLevel);
 
     //create converter and run
-    Converter converter(inputFileNames, outputFileName, &settings);
+    Converter converter(inputFileNames, outputFileName, &settings, append);
     if(!converter.Run()) {
         std::cerr<<"processing ended abnormally!"<<std::endl;
         return 1;
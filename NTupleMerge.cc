@@ -0,0 +1,314 @@
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <map>
+#include <thread>
+#include <algorithm>
+#include <cstring>
+#include <functional>
+
+#include "TROOT.h"
+#include "TFile.h"
+#include "TKey.h"
+#include "TClass.h"
+#include "TTree.h"
+#include "TChain.h"
+#include "TList.h"
+#include "TObjString.h"
+#include "TH1.h"
+#include "THnBase.h"
+
+#include "CommandLineInterface.hh"
+#include "Utilities.hh"
+
+// Merges the output files of NTuple: the histograms in the directories are added up, the output trees
+// are either concatenated or skipped, and the other objects at the top level (e.g. the splines of the TI-STAR
+// setup) are copied from the first file, like hadd does for objects that can't be added. The histograms are merged in parallel, every thread sums a part of
+// the files, and the partial sums are then added pairwise (a reduction tree), so no single thread has to
+// go through all of them.
+
+// partial sum of some of the files, directory -> histogram name -> histogram
+struct Accumulator {
+    std::map<std::string, std::map<std::string, TObject*> > fObjects;
+    std::vector<std::string> fFailed;
+    // the "inputFiles" records of the files, in the order of the files
+    std::vector<std::string> fInputFiles;
+};
+
+bool SameBinning(THnBase* left, THnBase* right) {
+    if(left->GetNdimensions() != right->GetNdimensions()) {
+        return false;
+    }
+    for(int d = 0; d < left->GetNdimensions(); ++d) {
+        if(left->GetAxis(d)->GetNbins() != right->GetAxis(d)->GetNbins() ||
+           left->GetAxis(d)->GetXmin() != right->GetAxis(d)->GetXmin() ||
+           left->GetAxis(d)->GetXmax() != right->GetAxis(d)->GetXmax()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// adds source to target, returns false if the two can't be added (different classes or binnings)
+bool Add(TObject* target, TObject* source) {
+    if(target->IsA() != source->IsA()) {
+        return false;
+    }
+    if(target->InheritsFrom(TH1::Class())) {
+        return static_cast<TH1*>(target)->Add(static_cast<TH1*>(source));
+    }
+    if(target->InheritsFrom(THnBase::Class())) {
+        if(!SameBinning(static_cast<THnBase*>(target), static_cast<THnBase*>(source))) {
+            return false;
+        }
+        static_cast<THnBase*>(target)->Add(static_cast<THnBase*>(source));
+        return true;
+    }
+    return false;
+}
+
+// adds the histogram to the accumulator, which takes ownership of it
+void Accumulate(Accumulator& accumulator, const std::string& directory, TObject* object, const std::string& origin) {
+    std::map<std::string, TObject*>& objects = accumulator.fObjects[directory];
+    auto existing = objects.find(object->GetName());
+    if(existing == objects.end()) {
+        objects[object->GetName()] = object;
+        return;
+    }
+    if(!Add(existing->second, object)) {
+        accumulator.fFailed.push_back(directory + "/" + object->GetName() + " (" + object->ClassName() + ") from " + origin);
+    }
+    delete object;
+}
+
+void ReadFiles(const std::vector<std::string>& fileNames, size_t first, size_t last, Accumulator& accumulator, int verbosityLevel) {
+    for(size_t f = first; f < last; ++f) {
+        TFile file(fileNames[f].c_str());
+        if(!file.IsOpen()) {
+            accumulator.fFailed.push_back("all histograms from " + fileNames[f] + " (failed to open file)");
+            continue;
+        }
+        if(verbosityLevel > 0) {
+            std::cout<<"reading "<<fileNames[f]<<std::endl;
+        }
+        TList* record = static_cast<TList*>(file.Get("inputFiles"));
+        if(record != nullptr) {
+            TIter nextName(record);
+            TObject* name;
+            while((name = nextName()) != nullptr) {
+                accumulator.fInputFiles.push_back(name->GetName());
+            }
+            record->Delete();
+            delete record;
+        } else {
+            std::cerr<<"No list of input files in '"<<fileNames[f]<<"', the merged list will be incomplete!"<<std::endl;
+        }
+        // keys with the same name follow each other with the highest cycle first, only that one is read,
+        // the older cycles are superseded copies (e.g. from an append) and would be counted twice
+        TIter nextDirectory(file.GetListOfKeys());
+        TKey* directoryKey;
+        std::string previousDirectory;
+        while((directoryKey = static_cast<TKey*>(nextDirectory())) != nullptr) {
+            if(previousDirectory == directoryKey->GetName()) {
+                continue;
+            }
+            previousDirectory = directoryKey->GetName();
+            // only the directories hold histograms, the trees at the top level are handled separately
+            if(strcmp(directoryKey->GetClassName(), "TDirectoryFile") != 0) {
+                continue;
+            }
+            TDirectory* directory = file.GetDirectory(directoryKey->GetName());
+            if(directory == nullptr) {
+                continue;
+            }
+            TIter nextHistogram(directory->GetListOfKeys());
+            TKey* histogramKey;
+            std::string previousHistogram;
+            while((histogramKey = static_cast<TKey*>(nextHistogram())) != nullptr) {
+                if(previousHistogram == histogramKey->GetName()) {
+                    continue;
+                }
+                previousHistogram = histogramKey->GetName();
+                TObject* object = histogramKey->ReadObj();
+                if(object == nullptr) {
+                    accumulator.fFailed.push_back(std::string(directoryKey->GetName()) + "/" + histogramKey->GetName() + " from " + fileNames[f] + " (failed to read)");
+                    continue;
+                }
+                if(object->InheritsFrom(TH1::Class())) {
+                    static_cast<TH1*>(object)->SetDirectory(nullptr);
+                }
+                Accumulate(accumulator, directoryKey->GetName(), object, fileNames[f]);
+            }
+        }
+        file.Close();
+    }
+}
+
+// adds everything from source to target, the histograms only in source are moved over
+void Reduce(Accumulator& target, Accumulator& source) {
+    for(auto directory = source.fObjects.begin(); directory != source.fObjects.end(); ++directory) {
+        for(auto object = directory->second.begin(); object != directory->second.end(); ++object) {
+            Accumulate(target, directory->first, object->second, "partial sum");
+        }
+    }
+    source.fObjects.clear();
+    target.fFailed.insert(target.fFailed.end(), source.fFailed.begin(), source.fFailed.end());
+    source.fFailed.clear();
+    target.fInputFiles.insert(target.fInputFiles.end(), source.fInputFiles.begin(), source.fInputFiles.end());
+    source.fInputFiles.clear();
+}
+
+// copies the objects at the top level of the file that aren't directories, trees, RNTuples, or the record of the
+// input files, only the highest cycle of each, returns the number of objects copied
+size_t CopyTopLevelObjects(const std::string& fileName, TFile& output) {
+    TFile file(fileName.c_str());
+    if(!file.IsOpen()) {
+        std::cerr<<"Failed to open file '"<<fileName<<"', not copying the objects at its top level!"<<std::endl;
+        return 0;
+    }
+    size_t nofObjects = 0;
+    TIter nextKey(file.GetListOfKeys());
+    TKey* key;
+    std::string previous;
+    while((key = static_cast<TKey*>(nextKey())) != nullptr) {
+        if(previous == key->GetName()) {
+            continue;
+        }
+        previous = key->GetName();
+        TClass* objectClass = TClass::GetClass(key->GetClassName());
+        if(objectClass == nullptr || objectClass->InheritsFrom(TDirectory::Class()) || objectClass->InheritsFrom(TTree::Class()) ||
+           strncmp(key->GetClassName(), "ROOT::", 6) == 0 || strcmp(key->GetName(), "inputFiles") == 0) {
+            continue;
+        }
+        TObject* object = key->ReadObj();
+        if(object == nullptr) {
+            std::cerr<<"Failed to read "<<key->GetName()<<" from '"<<fileName<<"', not copying it!"<<std::endl;
+            continue;
+        }
+        output.cd();
+        object->Write(key->GetName());
+        delete object;
+        ++nofObjects;
+    }
+    file.Close();
+    return nofObjects;
+}
+
+int main(int argc, char** argv) {
+    //parse all command line options
+    CommandLineInterface interface;
+    std::vector<std::string> inputFileNames;
+    interface.Add("-if","input file(s) (required)",&inputFileNames);
+    std::string outputFileName = "Merged.root";
+    interface.Add("-of","output file (default = 'Merged.root')",&outputFileName);
+    int nofThreads = 1;
+    interface.Add("-nt","number of threads (default = 1)",&nofThreads);
+    bool mergeTrees = false;
+    interface.Add("-mt","concatenate the output trees (default = skip them)",&mergeTrees);
+    int verbosityLevel = 0;
+    interface.Add("-vl","verbosity level (default = 0)",&verbosityLevel);
+
+    //-------------------- check flags and arguments --------------------
+    interface.CheckFlags(argc, argv);
+
+    if(inputFileNames.size() == 0) {
+        std::cerr<<"Missing input file name(s)!"<<std::endl;
+        return 1;
+    }
+    if(std::find(inputFileNames.begin(), inputFileNames.end(), outputFileName) != inputFileNames.end()) {
+        std::cerr<<"Output file '"<<outputFileName<<"' is also an input file!"<<std::endl;
+        return 1;
+    }
+
+    ROOT::EnableThreadSafety();
+    TH1::AddDirectory(kFALSE);
+
+    //-------------------- sum the histograms of each chunk of files --------------------
+    size_t nofChunks = std::min(static_cast<size_t>(std::max(nofThreads, 1)), inputFileNames.size());
+    std::vector<Accumulator> partial(nofChunks);
+    std::vector<std::thread> threads;
+    for(size_t c = 0; c < nofChunks; ++c) {
+        size_t first = c*inputFileNames.size()/nofChunks;
+        size_t last = (c+1)*inputFileNames.size()/nofChunks;
+        threads.push_back(std::thread(ReadFiles, std::cref(inputFileNames), first, last, std::ref(partial[c]), verbosityLevel));
+    }
+    for(auto thread = threads.begin(); thread != threads.end(); ++thread) {
+        thread->join();
+    }
+
+    //-------------------- add up the partial sums pairwise --------------------
+    for(size_t stride = 1; stride < nofChunks; stride *= 2) {
+        threads.clear();
+        for(size_t c = 0; c + stride < nofChunks; c += 2*stride) {
+            threads.push_back(std::thread(Reduce, std::ref(partial[c]), std::ref(partial[c + stride])));
+        }
+        for(auto thread = threads.begin(); thread != threads.end(); ++thread) {
+            thread->join();
+        }
+    }
+    Accumulator& total = partial[0];
+
+    //-------------------- write the result --------------------
+    TFile output(outputFileName.c_str(), "recreate");
+    if(!output.IsOpen()) {
+        std::cerr<<"Failed to open file '"<<outputFileName<<"', check permissions on directory and disk space!"<<std::endl;
+        return 1;
+    }
+
+    if(mergeTrees) {
+        // all files have to hold a TTree called "tree", RNTuple output can't be concatenated this way
+        // the chain only reads the highest cycle of the tree, which is complete: older cycles are
+        // autosaves of the same tree, and NTuple refuses to append to a tree
+        TChain chain("tree");
+        for(auto fileName = inputFileNames.begin(); fileName != inputFileNames.end(); ++fileName) {
+            chain.Add(fileName->c_str());
+        }
+        if(chain.GetEntries() > 0) {
+            // "fast" copies the compressed baskets, "keep" leaves the output file open for the histograms
+            chain.Merge(&output, 0, "fast keep");
+            if(verbosityLevel > 0) {
+                std::cout<<"concatenated "<<chain.GetEntries()<<" entries of the output trees"<<std::endl;
+            }
+        } else {
+            std::cerr<<"No entries found in the output trees, not writing a tree!"<<std::endl;
+        }
+    }
+
+    // record of all input files of the merged files, so NTuple -append can be used on the merged file
+    TList inputFiles;
+    inputFiles.SetOwner();
+    for(auto fileName = total.fInputFiles.begin(); fileName != total.fInputFiles.end(); ++fileName) {
+        inputFiles.Add(new TObjString(fileName->c_str()));
+    }
+    output.cd();
+    inputFiles.Write("inputFiles", TObject::kSingleKey);
+
+    size_t nofCopied = CopyTopLevelObjects(inputFileNames[0], output);
+    if(verbosityLevel > 0) {
+        std::cout<<"copied "<<nofCopied<<" objects at the top level of "<<inputFileNames[0]<<std::endl;
+    }
+
+    size_t nofHistograms = 0;
+    for(auto directory = total.fObjects.begin(); directory != total.fObjects.end(); ++directory) {
+        output.mkdir(directory->first.c_str());
+        output.cd(directory->first.c_str());
+        for(auto object = directory->second.begin(); object != directory->second.end(); ++object) {
+            object->second->Write();
+            delete object->second;
+            ++nofHistograms;
+        }
+    }
+    output.Close();
+
+    std::cout<<"merged "<<nofHistograms<<" histograms in "<<total.fObjects.size()<<" directories from "<<inputFileNames.size()<<" files into "<<outputFileName<<std::endl;
+    if(!total.fFailed.empty()) {
+        std::cerr<<total.fFailed.size()<<" histograms failed to merge and were left out of the sum:"<<std::endl;
+        for(auto failed = total.fFailed.begin(); failed != total.fFailed.end(); ++failed) {
+            std::cerr<<"    "<<*failed<<std::endl;
+        }
+        return 1;
+    }
+
+    return 0;
+}
@@ -4,12 +4,66 @@
 #include <iostream>
 #include <iomanip>
 #include <vector>
+#include <cstddef>
+#include <stdexcept>
 //#include "TObject.h"
 #include "math.h"
 
+// Array with room for N elements inside the object itself. Only when more than N elements are added all of them move
+// to the heap, so the elements are always contiguous. Most particles hit one or two strips/rings, so filling, copying,
+// and clearing a ParticleMC normally doesn't allocate anything.
+template<class T, size_t N>
+class SmallArray {
+	public:
+		SmallArray() : fSize(0) {}
+
+		void push_back(const T& value) {
+			if(fHeap.empty() && fSize < N) {
+				fLocal[fSize] = value;
+			} else {
+				if(fHeap.empty()) fHeap.assign(fLocal, fLocal + fSize);
+				fHeap.push_back(value);
+			}
+			++fSize;
+		}
+		void clear() {
+			fSize = 0;
+			fHeap.clear();
+		}
+
+		size_t size() const { return fSize; }
+		bool empty() const { return fSize == 0; }
+		T* data() { return fHeap.empty() ? fLocal : &fHeap[0]; }
+		const T* data() const { return fHeap.empty() ? fLocal : &fHeap[0]; }
+		T* begin() { return data(); }
+		T* end() { return data() + fSize; }
+		const T* begin() const { return data(); }
+		const T* end() const { return data() + fSize; }
+		T& operator[](size_t i) { return data()[i]; }
+		const T& operator[](size_t i) const { return data()[i]; }
+		T& at(size_t i) {
+			if(i >= fSize) throw std::out_of_range("SmallArray::at");
+			return data()[i];
+		}
+		const T& at(size_t i) const {
+			if(i >= fSize) throw std::out_of_range("SmallArray::at");
+			return data()[i];
+		}
+
+	private:
+		T fLocal[N];
+		std::vector<T> fHeap;
+		size_t fSize;
+};
+
 
 class ParticleMC { // : public TObject {
 	public:
+		// number of strips/rings stored without allocating
+		static const size_t kLocalStrips = 4;
+		typedef SmallArray<int, kLocalStrips> IntArray;
+		typedef SmallArray<double, kLocalStrips> DoubleArray;
+
 		ParticleMC() {
 			ClearParticleMC();
 		}
@@ -106,7 +160,7 @@ class ParticleMC { // : public TObject {
 		double GetRear() { return fRear; }
 		double GetEdet() { return fEdet; }
 		int GetMult() { return fMult; }
-		std::vector<int> & GetStripNr() { return fStripNr; }
+		IntArray & GetStripNr() { return fStripNr; }
 		bool GetNeighborStrip() {
 			if(fStripNr.size() == 2 && fabs(fStripNr[0] - fStripNr[1]) == 1) {
 				return true;
@@ -121,23 +175,23 @@ class ParticleMC { // : public TObject {
 				return false;
 			}
 		}
-		std::vector<double> GetStripEnergy() { return fStripEnergy; }// for CD 
-		std::vector<double> GetStripPos() { return fStripEnergy; }// for Barrel 
-		std::vector<int> GetStripA() { return fStripA; }
-		std::vector<int> GetStripZ() { return fStripZ; }
-		std::vector<int> GetStripTrackID() { return fStripTrackID; }
-		std::vector<double> GetStripTime() { return fStripTime; }
-		std::vector<double> GetPosGlobalX() { return fPosGlobalX; } // leila
-		std::vector<double> GetPosGlobalY() { return fPosGlobalY; } // leila
-		std::vector<double> GetPosGlobalZ() { return fPosGlobalZ; } // leila
-		std::vector<int> IsStripStopped() { return fStripStopped; }
-		std::vector<int> & GetRingNr() { return fRingNr; }
-		std::vector<double> GetRingEnergy() { return fRingEnergy; }
-		std::vector<int> GetRingA() { return fRingA; }
-		std::vector<int> GetRingZ() { return fRingZ; }
-		std::vector<int> GetRingTrackID() { return fRingTrackID; }
-		std::vector<double> GetRingTime() { return fRingTime; }
-		std::vector<int> IsRingStopped() { return fRingStopped; }
+		DoubleArray & GetStripEnergy() { return fStripEnergy; }// for CD 
+		DoubleArray & GetStripPos() { return fStripEnergy; }// for Barrel 
+		IntArray & GetStripA() { return fStripA; }
+		IntArray & GetStripZ() { return fStripZ; }
+		IntArray & GetStripTrackID() { return fStripTrackID; }
+		DoubleArray & GetStripTime() { return fStripTime; }
+		DoubleArray & GetPosGlobalX() { return fPosGlobalX; } // leila
+		DoubleArray & GetPosGlobalY() { return fPosGlobalY; } // leila
+		DoubleArray & GetPosGlobalZ() { return fPosGlobalZ; } // leila
+		IntArray & IsStripStopped() { return fStripStopped; }
+		IntArray & GetRingNr() { return fRingNr; }
+		DoubleArray & GetRingEnergy() { return fRingEnergy; }
+		IntArray & GetRingA() { return fRingA; }
+		IntArray & GetRingZ() { return fRingZ; }
+		IntArray & GetRingTrackID() { return fRingTrackID; }
+		DoubleArray & GetRingTime() { return fRingTime; }
+		IntArray & IsRingStopped() { return fRingStopped; }
 
 		long long SizeOf() {
 			long long result = 0;
@@ -186,23 +240,23 @@ class ParticleMC { // : public TObject {
 
 	protected:
 		int fID;
-		std::vector<int> fStripNr;
-		std::vector<double> fStripEnergy;
-		std::vector<int> fStripA;
-		std::vector<int> fStripZ;
-		std::vector<int> fStripTrackID;
-		std::vector<double> fStripTime;
-		std::vector<double> fPosGlobalX;
-		std::vector<double> fPosGlobalY;
-		std::vector<double> fPosGlobalZ;
-		std::vector<int> fStripStopped;
-		std::vector<int> fRingNr;
-		std::vector<double> fRingEnergy;
-		std::vector<int> fRingA;
-		std::vector<int> fRingZ;
-		std::vector<int> fRingTrackID;
-		std::vector<double> fRingTime;
-		std::vector<int> fRingStopped;
+		IntArray fStripNr;
+		DoubleArray fStripEnergy;
+		IntArray fStripA;
+		IntArray fStripZ;
+		IntArray fStripTrackID;
+		DoubleArray fStripTime;
+		DoubleArray fPosGlobalX;
+		DoubleArray fPosGlobalY;
+		DoubleArray fPosGlobalZ;
+		IntArray fStripStopped;
+		IntArray fRingNr;
+		DoubleArray fRingEnergy;
+		IntArray fRingA;
+		IntArray fRingZ;
+		IntArray fRingTrackID;
+		DoubleArray fRingTime;
+		IntArray fRingStopped;
 		int fA;
 		int fZ;
 		int fTrackID;
@@ -0,0 +1,127 @@
+#include "RNTupleOutput.hh"
+
+#include <iostream>
+
+bool RNTupleOutput::Available() {
+#ifdef NTUPLE_HAS_RNTUPLE
+    return true;
+#else
+    return false;
+#endif
+}
+
+#ifdef NTUPLE_HAS_RNTUPLE
+
+RNTupleOutput::RNTupleOutput(TFile* file, const std::string& name, const std::vector<std::pair<std::string, std::vector<Detector>*> >& collections, std::vector<Particle>* particles)
+    : fOpen(false), fParticles(particles) {
+    auto model = RNTupleApi::RNTupleModel::Create();
+    fEventNumber = model->MakeField<Int_t>("eventNumber");
+    for(auto collection = collections.begin(); collection != collections.end(); ++collection) {
+        const std::string& prefix = collection->first;
+        Collection newCollection;
+        newCollection.fHits = collection->second;
+        newCollection.fDetector = model->MakeField<std::vector<Int_t> >(prefix + "_detector");
+        newCollection.fCrystal = model->MakeField<std::vector<Int_t> >(prefix + "_crystal");
+        newCollection.fEnergy = model->MakeField<std::vector<Float_t> >(prefix + "_energy");
+        newCollection.fSimulationEnergy = model->MakeField<std::vector<Float_t> >(prefix + "_simEnergy");
+        newCollection.fX = model->MakeField<std::vector<Float_t> >(prefix + "_x");
+        newCollection.fY = model->MakeField<std::vector<Float_t> >(prefix + "_y");
+        newCollection.fZ = model->MakeField<std::vector<Float_t> >(prefix + "_z");
+        newCollection.fTime = model->MakeField<std::vector<Double_t> >(prefix + "_time");
+        fCollections.push_back(newCollection);
+    }
+    fParticleType = model->MakeField<std::vector<Int_t> >("TISTARParticle_type");
+    fParticleDetector = model->MakeField<std::vector<Int_t> >("TISTARParticle_detector");
+    fParticleEnergy = model->MakeField<std::vector<Float_t> >("TISTARParticle_energy");
+    fParticleRecEnergy = model->MakeField<std::vector<Float_t> >("TISTARParticle_recEnergy");
+    fParticleDeltaE = model->MakeField<std::vector<Float_t> >("TISTARParticle_deltaE");
+    fParticleERest = model->MakeField<std::vector<Float_t> >("TISTARParticle_eRest");
+    fParticleX = model->MakeField<std::vector<Float_t> >("TISTARParticle_x");
+    fParticleY = model->MakeField<std::vector<Float_t> >("TISTARParticle_y");
+    fParticleZ = model->MakeField<std::vector<Float_t> >("TISTARParticle_z");
+    fParticleTime = model->MakeField<std::vector<Double_t> >("TISTARParticle_time");
+
+    try {
+        // use the compression settings of the file, like a TTree would
+        RNTupleApi::RNTupleWriteOptions options;
+        options.SetCompression(file->GetCompressionSettings());
+        fWriter = RNTupleApi::RNTupleWriter::Append(std::move(model), name, *file, options);
+        fOpen = true;
+    } catch(const std::exception& e) {
+        std::cerr<<"Failed to create RNTuple '"<<name<<"' in file "<<file->GetName()<<": "<<e.what()<<std::endl;
+    }
+}
+
+RNTupleOutput::~RNTupleOutput() {
+    // destroying the writer commits the remaining clusters and the footer
+    fWriter.reset();
+}
+
+void RNTupleOutput::Fill(Int_t eventNumber) {
+    if(!fOpen) {
+        return;
+    }
+    *fEventNumber = eventNumber;
+    for(auto collection = fCollections.begin(); collection != fCollections.end(); ++collection) {
+        std::vector<Detector>& hits = *(collection->fHits);
+        collection->fDetector->resize(hits.size());
+        collection->fCrystal->resize(hits.size());
+        collection->fEnergy->resize(hits.size());
+        collection->fSimulationEnergy->resize(hits.size());
+        collection->fX->resize(hits.size());
+        collection->fY->resize(hits.size());
+        collection->fZ->resize(hits.size());
+        collection->fTime->resize(hits.size());
+        for(size_t i = 0; i < hits.size(); ++i) {
+            TVector3 position = hits[i].Position();
+            (*collection->fDetector)[i] = hits[i].DetectorId();
+            (*collection->fCrystal)[i] = hits[i].CrystalId();
+            (*collection->fEnergy)[i] = hits[i].Energy();
+            (*collection->fSimulationEnergy)[i] = hits[i].SimulationEnergy();
+            (*collection->fX)[i] = position.X();
+            (*collection->fY)[i] = position.Y();
+            (*collection->fZ)[i] = position.Z();
+            (*collection->fTime)[i] = hits[i].Time();
+        }
+    }
+    std::vector<Particle>& particles = *fParticles;
+    fParticleType->resize(particles.size());
+    fParticleDetector->resize(particles.size());
+    fParticleEnergy->resize(particles.size());
+    fParticleRecEnergy->resize(particles.size());
+    fParticleDeltaE->resize(particles.size());
+    fParticleERest->resize(particles.size());
+    fParticleX->resize(particles.size());
+    fParticleY->resize(particles.size());
+    fParticleZ->resize(particles.size());
+    fParticleTime->resize(particles.size());
+    for(size_t i = 0; i < particles.size(); ++i) {
+        TVector3 position = particles[i].GetPosition();
+        (*fParticleType)[i] = particles[i].GetType();
+        (*fParticleDetector)[i] = particles[i].GetDetector();
+        (*fParticleEnergy)[i] = particles[i].GetEnergy();
+        (*fParticleRecEnergy)[i] = particles[i].GetRecEnergy();
+        (*fParticleDeltaE)[i] = particles[i].GetDeltaE();
+        (*fParticleERest)[i] = particles[i].GetERest();
+        (*fParticleX)[i] = position.X();
+        (*fParticleY)[i] = position.Y();
+        (*fParticleZ)[i] = position.Z();
+        (*fParticleTime)[i] = particles[i].GetTime();
+    }
+    fWriter->Fill();
+}
+
+#else
+
+RNTupleOutput::RNTupleOutput(TFile* file, const std::string& name, const std::vector<std::pair<std::string, std::vector<Detector>*> >&, std::vector<Particle>* particles)
+    : fOpen(false), fParticles(particles) {
+    std::cerr<<"RNTuple output requires ROOT 6.34 or newer and C++17, can't write '"<<name<<"' to "<<file->GetName()<<"!"<<std::endl;
+}
+
+RNTupleOutput::~RNTupleOutput() {
+}
+
+void RNTupleOutput::Fill(Int_t) {
+}
+
+#endif
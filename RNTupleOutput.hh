@@ -0,0 +1,78 @@
+#ifndef __RNTUPLEOUTPUT_HH
+#define __RNTUPLEOUTPUT_HH
+
+#include <vector>
+#include <string>
+#include <utility>
+#include <memory>
+
+#include "RVersion.h"
+#include "TFile.h"
+
+#include "Griffin.hh"
+#include "Particle.hh"
+
+// RNTuple is usable from ROOT 6.34 on, which needs C++17 (build with "make CXXSTD=c++17")
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,34,0) && __cplusplus >= 201703L
+#define NTUPLE_HAS_RNTUPLE 1
+#include "ROOT/RNTupleModel.hxx"
+#include "ROOT/RNTupleWriter.hxx"
+// the model, writer, and write options only left ROOT::Experimental with ROOT 6.36
+#if ROOT_VERSION_CODE >= ROOT_VERSION(6,36,0)
+namespace RNTupleApi = ROOT;
+#else
+namespace RNTupleApi = ROOT::Experimental;
+#endif
+#endif
+
+// Writes the converted events as an RNTuple instead of a TTree.
+// Every hit collection becomes one column per field (detector, crystal, energies, position, time),
+// the TI-STAR particles are written the same way with their main quantities.
+class RNTupleOutput {
+public:
+    RNTupleOutput(TFile* file, const std::string& name, const std::vector<std::pair<std::string, std::vector<Detector>*> >& collections, std::vector<Particle>* particles);
+    // the data set is only complete once the writer has been destroyed, this has to happen before the file is closed
+    ~RNTupleOutput();
+
+    static bool Available();
+    bool IsOpen() {
+        return fOpen;
+    }
+
+    void Fill(Int_t eventNumber);
+
+private:
+    bool fOpen;
+    std::vector<Particle>* fParticles;
+
+#ifdef NTUPLE_HAS_RNTUPLE
+    struct Collection {
+        std::vector<Detector>* fHits;
+        std::shared_ptr<std::vector<Int_t> > fDetector;
+        std::shared_ptr<std::vector<Int_t> > fCrystal;
+        std::shared_ptr<std::vector<Float_t> > fEnergy;
+        std::shared_ptr<std::vector<Float_t> > fSimulationEnergy;
+        std::shared_ptr<std::vector<Float_t> > fX;
+        std::shared_ptr<std::vector<Float_t> > fY;
+        std::shared_ptr<std::vector<Float_t> > fZ;
+        std::shared_ptr<std::vector<Double_t> > fTime;
+    };
+    std::vector<Collection> fCollections;
+
+    std::shared_ptr<Int_t> fEventNumber;
+    std::shared_ptr<std::vector<Int_t> > fParticleType;
+    std::shared_ptr<std::vector<Int_t> > fParticleDetector;
+    std::shared_ptr<std::vector<Float_t> > fParticleEnergy;
+    std::shared_ptr<std::vector<Float_t> > fParticleRecEnergy;
+    std::shared_ptr<std::vector<Float_t> > fParticleDeltaE;
+    std::shared_ptr<std::vector<Float_t> > fParticleERest;
+    std::shared_ptr<std::vector<Float_t> > fParticleX;
+    std::shared_ptr<std::vector<Float_t> > fParticleY;
+    std::shared_ptr<std::vector<Float_t> > fParticleZ;
+    std::shared_ptr<std::vector<Double_t> > fParticleTime;
+
+    std::unique_ptr<RNTupleApi::RNTupleWriter> fWriter;
+#endif
+};
+
+#endif
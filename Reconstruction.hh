@@ -9,6 +9,7 @@
 #include <iostream>
 #include <fstream>
 #include <string>
+#include <vector>
 
 #include "TMath.h"
 #include "TSpline.h"
@@ -32,11 +33,22 @@ class Reconstruction {
 		}
 		void SetProj(Nucleus* projectile){
 			fProj = projectile;
+			fCoefficients.clear();
+			fRangeTable.fEnergy.clear();
 		}
 		void SetTarget(Compound* target){
 			fTarget = target;
+			fCoefficients.clear();
+			fRangeTable.fEnergy.clear();
+		}
+		Nucleus* GetProj(){
+			return fProj;
+		}
+		Compound* GetTarget(){
+			return fTarget;
 		}
 		double StoppingPower(double energy, bool gaseous = true); // total stopping power of the target
+		void StoppingPower(const double* energies, double* stopping, size_t n, bool gaseous = true); // total stopping power of the target for n energies
 		double StoppingPower(Nucleus* target, double energy, bool gaseous = true); // stopping power of a single target element
 		double CompoundRange(double energy, int limit, bool gaseous = true); // range of the projectile in the target
 		double EnergyAfter(double energy, int limit, bool gaseous = true); // energy after target        //ueberall auf true fuer Gastarget
@@ -50,13 +62,42 @@ class Reconstruction {
 		TSpline3* Thickness2EnergyAfter(double energy, double maxThickness, double stepSize, bool gaseous);
 		TGraph* EnergyAfter2Energy(double emax, double size, bool gaseous = true);
 	private:
+		// range in mg/cm^2 vs. energy in MeV at the steps of one adaptive integration, interpolated in between
+		struct RangeTable {
+			std::vector<double> fEnergy;
+			std::vector<double> fRange;
+			std::vector<double> fStopping;
+			double fEmax; // grid the table was integrated for
+			double fSize;
+			bool fGaseous;
+			double Range(double energy) const;
+			double Energy(double range) const;
+		};
+		void IntegrateRange(double emax, const std::vector<double>& energies, RangeTable& table, bool gaseous);
+		const RangeTable& GetRangeTable(double emax, double size, bool gaseous); // integrates the range only if the grid changed
+		double EnergyAfter(const RangeTable& table, double energy); // energy after fTargetThickness
+
 		double fTargetThickness;
 		Nucleus* fProj;
 		Compound* fTarget;
-		// the following arrays are needed for the calulation of the stopping power
-		double a_h(int index, int z); 
-		double a_he(int index, int z);
-		double b_he(int index, int z);
+		// everything in the stopping power of the projectile in one target element that doesn't depend on the energy
+		struct StoppingCoefficients {
+			bool fValid;
+			int fZp;
+			double fAp;
+			double fFactor;
+			double fEps;
+			double fNuclear;
+			double fZpTwoThirds;
+			double fZeffScale;
+			const double* fAh;
+			const double* fAhe;
+			const double* fBhe;
+		};
+		std::vector<StoppingCoefficients> fCoefficients; // for each element of the target, filled on first use
+		RangeTable fRangeTable; // of the last grid used, cleared with fCoefficients
+		void SetStoppingCoefficients(Nucleus* target, StoppingCoefficients& coefficients);
+		double StoppingPower(const StoppingCoefficients& coefficients, double energy, bool gaseous);
 		double shell_correction(int z); // shell correction for Bethe formula for hydrogen as projectile
 		//ClassDef(Reconstruction, 1);
 };
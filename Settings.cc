@@ -1,5 +1,8 @@
 #include "Settings.hh"
 
+#include <iostream>
+#include <sstream>
+
 #include "TEnv.h"
 #include "TString.h"
 
@@ -15,12 +18,23 @@ Settings::Settings(std::string fileName, int verbosityLevel) :
 
     fBufferSize = env.GetValue("BufferSize",1024000);
 
+    fCompressionAlgorithm = env.GetValue("Compression.Algorithm","");
+    fCompressionLevel = env.GetValue("Compression.Level",-1);
+    fImplicitMTThreads = env.GetValue("ImplicitMT.Threads",0);
+
     fSortNumberOfEvents = env.GetValue("SortNumberOfEvents",0);
 
     fWriteTree = env.GetValue("WriteTree",true);
 
+    fFlatTree = env.GetValue("FlatTree",false);
+
+    fOutputFormat = env.GetValue("OutputFormat","TTree");
+
     fWrite2DHist = env.GetValue("Write2DHist",false);
 
+    fHistogramWriteThreads = env.GetValue("Histograms.WriteThreads",1);
+    fSeparateHistogramFiles = env.GetValue("Histograms.SeparateFiles",false);
+
     //fWrite3DHist = env.GetValue("Write3DHist",false);
         
     fWriteNDHist = env.GetValue("WriteNDHist",false);
@@ -35,6 +49,63 @@ Settings::Settings(std::string fileName, int verbosityLevel) :
 
     fGriffinAddbackVectorCrystalFaceDistancemm = env.GetValue("GriffinAddbackVectorCrystalFaceDistancemm",110.0);
 
+    fGeometryFile = env.GetValue("GeometryFile","");
+
+    fUseEventBuilder = env.GetValue("EventBuilder",false);
+
+    fOverlayRate = env.GetValue("Overlay.Rate.Hz",0.);
+
+    fOverlayWindow = env.GetValue("Overlay.Window.sec",1.e-5);
+
+    fPrescan = env.GetValue("Prescan",false);
+
+    std::istringstream triggerSystems(env.GetValue("Trigger.Systems",""));
+    int systemId;
+    while(triggerSystems>>systemId) {
+        fTriggerSystems.push_back(systemId);
+    }
+
+    fTriggerMultiplicity = env.GetValue("Trigger.Multiplicity",1);
+
+    fTriggerHitThreshold = env.GetValue("Trigger.HitThreshold.keV",0.);
+
+    fTriggerEnergySum = env.GetValue("Trigger.EnergySum.keV",0.);
+
+    fSampleMaxEvents = env.GetValue("Sample.MaxEvents",0);
+
+    // event number ranges as "first-last", separated by spaces
+    std::istringstream sampleRanges(env.GetValue("Sample.EventRanges",""));
+    std::string range;
+    while(sampleRanges>>range) {
+        int first;
+        int last;
+        char dash;
+        std::istringstream str(range);
+        if(!(str>>first>>dash>>last) || dash != '-' || last < first) {
+            std::cerr<<"Failed to parse event range '"<<range<<"', expected 'first-last', ignoring it!"<<std::endl;
+            continue;
+        }
+        fSampleRanges.push_back(std::make_pair(first, last));
+    }
+
+    fSampleFraction = env.GetValue("Sample.Fraction",1.);
+
+    fSampleSeed = env.GetValue("Sample.Seed",1);
+
+    fSampleStride = env.GetValue("Sample.Stride",1);
+    if(fSampleStride < 1) {
+        std::cerr<<"Sample stride has to be at least 1, not "<<fSampleStride<<", using 1!"<<std::endl;
+        fSampleStride = 1;
+    }
+
+    fSkimFile = env.GetValue("Skim.File","");
+
+    fSkimRequireTistar = env.GetValue("Skim.RequireTistar",true);
+
+    fSkimExcitationEnergyLow = env.GetValue("Skim.ExcitationEnergy.Low.keV",-1.e9);
+
+    fSkimExcitationEnergyHigh = env.GetValue("Skim.ExcitationEnergy.High.keV",1.e9);
+
     // TI-STAR detector/run variables
     // assuming 2 pixelated strips
     fTISTARGenNtupleName =      env.GetValue("TISTAR.GenNtupleName","/treeGen");
@@ -46,6 +117,16 @@ Settings::Settings(std::string fileName, int verbosityLevel) :
     fTISTARStripWidthZ[0] =  env.GetValue("TISTAR.Layer0.StripWidthZ", 0.1); // in mm
     fTISTARStripWidthY[1] =  env.GetValue("TISTAR.Layer1.StripWidthY", 0.1); // in mm
     fTISTARStripWidthZ[1] =  env.GetValue("TISTAR.Layer1.StripWidthZ", 0.1); // in mm
+    // uniform-grid tables replacing the energy loss splines in the reconstruction, the tolerance is relative to the range of the tabulated values
+    fTISTARTableTolerance =  env.GetValue("TISTAR.Table.Tolerance", 1e-5);
+    fTISTARTableCubic =      env.GetValue("TISTAR.Table.Cubic", true);
+    // grid of the table of the energy loss in foil and target over (energy, path factor = 1/sin(theta))
+    fTISTARTableEnergyPoints =     env.GetValue("TISTAR.Table.EnergyPoints", 1001);
+    fTISTARTableMaxPathFactor =    env.GetValue("TISTAR.Table.MaxPathFactor", 10.);
+    fTISTARTablePathFactorPoints = env.GetValue("TISTAR.Table.PathFactorPoints", 181);
+    fTISTARTableMaxError =         env.GetValue("TISTAR.Table.MaxError", 1.);
+    // directory to keep the energy loss and kinematics splines in between runs, empty means no cache
+    fTISTARCacheDirectory =        env.GetValue("TISTAR.CacheDirectory", "");
     
     fTISTARDetNtupleName =      env.GetValue("TISTAR.DetNtupleName","/treeDet");
 
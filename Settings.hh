@@ -34,6 +34,18 @@ public:
         return fBufferSize;
     }
 
+    std::string CompressionAlgorithm() {
+        return fCompressionAlgorithm;
+    }
+
+    int CompressionLevel() {
+        return fCompressionLevel;
+    }
+
+    int ImplicitMTThreads() {
+        return fImplicitMTThreads;
+    }
+
     int SortNumberOfEvents() {
         return fSortNumberOfEvents;
     }
@@ -42,10 +54,26 @@ public:
         return fWriteTree;
     }
 
+    bool FlatTree() {
+        return fFlatTree;
+    }
+
+    std::string OutputFormat() {
+        return fOutputFormat;
+    }
+
     bool Write2DHist() {
         return fWrite2DHist;
     }
 
+    int HistogramWriteThreads() {
+        return fHistogramWriteThreads;
+    }
+
+    bool SeparateHistogramFiles() {
+        return fSeparateHistogramFiles;
+    }
+
     //bool Write3DHist() {
     //    return fWrite3DHist;
     //}
@@ -74,6 +102,83 @@ public:
         return fGriffinAddbackVectorCrystalFaceDistancemm;
     }
 
+    std::string GeometryFile() {
+        return fGeometryFile;
+    }
+
+    bool UseEventBuilder() {
+        return fUseEventBuilder;
+    }
+
+    double OverlayRate() {
+        return fOverlayRate;
+    }
+
+    double OverlayWindow() {
+        return fOverlayWindow;
+    }
+
+    bool Prescan() {
+        return fPrescan;
+    }
+
+    std::vector<int>& TriggerSystems() {
+        return fTriggerSystems;
+    }
+
+    int TriggerMultiplicity() {
+        return fTriggerMultiplicity;
+    }
+
+    double TriggerHitThreshold() {
+        return fTriggerHitThreshold;
+    }
+
+    double TriggerEnergySum() {
+        return fTriggerEnergySum;
+    }
+
+    // sampling of events, done on the event index before any event is sorted
+    bool Sampling() {
+        return fSampleMaxEvents > 0 || !fSampleRanges.empty() || fSampleFraction < 1. || fSampleStride > 1;
+    }
+
+    Long64_t SampleMaxEvents() {
+        return fSampleMaxEvents;
+    }
+
+    std::vector<std::pair<int,int> >& SampleRanges() {
+        return fSampleRanges;
+    }
+
+    double SampleFraction() {
+        return fSampleFraction;
+    }
+
+    UInt_t SampleSeed() {
+        return fSampleSeed;
+    }
+
+    int SampleStride() {
+        return fSampleStride;
+    }
+
+    std::string SkimFile() {
+        return fSkimFile;
+    }
+
+    bool SkimRequireTistar() {
+        return fSkimRequireTistar;
+    }
+
+    double SkimExcitationEnergyLow() {
+        return fSkimExcitationEnergyLow;
+    }
+
+    double SkimExcitationEnergyHigh() {
+        return fSkimExcitationEnergyHigh;
+    }
+
     double Resolution(int systemID, int detectorID, int crystalID, double en) {
         if(fResolution.find(systemID) != fResolution.end()) {
             try{ 
@@ -155,6 +260,13 @@ public:
     double GetTISTARnStripsZ(int stripN) { return fTISTARnStripsZ[stripN]; }
     double GetTISTARStripWidthY(int stripN) { return fTISTARStripWidthY[stripN]; }
     double GetTISTARStripWidthZ(int stripN) { return fTISTARStripWidthZ[stripN]; }
+    double GetTISTARTableTolerance() { return fTISTARTableTolerance; }
+    bool GetTISTARTableCubic() { return fTISTARTableCubic; }
+    int GetTISTARTableEnergyPoints() { return fTISTARTableEnergyPoints; }
+    double GetTISTARTableMaxPathFactor() { return fTISTARTableMaxPathFactor; }
+    int GetTISTARTablePathFactorPoints() { return fTISTARTablePathFactorPoints; }
+    double GetTISTARTableMaxError() { return fTISTARTableMaxError; }
+    std::string GetTISTARCacheDirectory() { return fTISTARCacheDirectory; }
 
     //double ProtonCoeff(int i) { return fProtonCoeff[i]; }
     //double DeuteronCoeff(int i) { return fDeuteronCoeff[i]; }
@@ -175,10 +287,17 @@ private:
 
     int fVerbosityLevel;
     int fBufferSize;
+    std::string fCompressionAlgorithm;
+    int fCompressionLevel;
+    int fImplicitMTThreads;
     int fSortNumberOfEvents;
 
     bool fWriteTree;
+    bool fFlatTree;
+    std::string fOutputFormat;
     bool fWrite2DHist;
+    int fHistogramWriteThreads;
+    bool fSeparateHistogramFiles;
     //bool fWrite3DHist;
     bool fWriteNDHist;
     bool fWrite2DSGGHist;
@@ -188,6 +307,30 @@ private:
     double fGriffinAddbackVectorDepthmm;
     double fGriffinAddbackVectorCrystalFaceDistancemm;
 
+    std::string fGeometryFile;
+
+    bool fUseEventBuilder;
+
+    double fOverlayRate;
+    double fOverlayWindow;
+
+    bool fPrescan;
+    std::vector<int> fTriggerSystems;
+    int fTriggerMultiplicity;
+    double fTriggerHitThreshold;
+    double fTriggerEnergySum;
+
+    Long64_t fSampleMaxEvents;
+    std::vector<std::pair<int,int> > fSampleRanges;
+    double fSampleFraction;
+    UInt_t fSampleSeed;
+    int fSampleStride;
+
+    std::string fSkimFile;
+    bool fSkimRequireTistar;
+    double fSkimExcitationEnergyLow;
+    double fSkimExcitationEnergyHigh;
+
     std::map<int,std::vector<std::vector<TF1> > > fResolution;
     std::map<int,std::vector<std::vector<double> > > fThreshold;
     std::map<int,std::vector<std::vector<double> > > fThresholdWidth;
@@ -214,6 +357,13 @@ private:
     std::vector<int> fTISTARnStripsZ;
     std::vector<double>  fTISTARStripWidthY;
     std::vector<double>  fTISTARStripWidthZ;
+    double fTISTARTableTolerance;
+    bool fTISTARTableCubic;
+    int fTISTARTableEnergyPoints;
+    double fTISTARTableMaxPathFactor;
+    int fTISTARTablePathFactorPoints;
+    double fTISTARTableMaxError;
+    std::string fTISTARCacheDirectory;
     
     std::string fTISTARDetNtupleName;
     TistarSettings * fTistarSettings;
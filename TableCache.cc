@@ -0,0 +1,152 @@
+#include "TableCache.hh"
+
+#include <iostream>
+#include <iomanip>
+#include <cstdio>
+#include <unistd.h>
+
+#include "TFile.h"
+#include "TDirectory.h"
+#include "TNamed.h"
+#include "TSystem.h"
+
+TableCache::TableCache(const std::string& directory, int verbosityLevel)
+    : fDirectory(directory), fVerbosityLevel(verbosityLevel) {
+}
+
+void TableCache::Describe(std::ostringstream& description, Reconstruction* reconstruction) {
+    // all numbers with full precision, so any change of the setup gives a different description
+    description<<std::setprecision(17);
+    Nucleus* projectile = reconstruction->GetProj();
+    Compound* material = reconstruction->GetTarget();
+    description<<"version "<<kVersion<<"; projectile "<<projectile->GetZ()<<" "<<projectile->GetA()<<"; material";
+    for(size_t i = 0; i < material->GetNofElements(); ++i) {
+        description<<" "<<material->GetNucleus(i)->GetZ()<<" "<<material->GetNucleus(i)->GetA()<<" "<<material->GetFrac(i);
+    }
+    description<<"; density "<<material->GetDensity();
+}
+
+// 64 bit FNV-1a hash of the description, the description itself is stored in the file to catch collisions
+std::string TableCache::FileName(const std::string& kind, const std::string& description) {
+    unsigned long long hash = 14695981039346656037ULL;
+    for(size_t i = 0; i < description.size(); ++i) {
+        hash ^= static_cast<unsigned char>(description[i]);
+        hash *= 1099511628211ULL;
+    }
+    std::ostringstream fileName;
+    fileName<<fDirectory<<"/"<<kind<<"_"<<std::hex<<std::setw(16)<<std::setfill('0')<<hash<<".root";
+    return fileName.str();
+}
+
+TSpline3* TableCache::Load(const std::string& kind, const std::string& description) {
+    if(!Enabled()) {
+        return nullptr;
+    }
+    std::string fileName = FileName(kind, description);
+    if(gSystem->AccessPathName(fileName.c_str())) { // true means the file does NOT exist
+        if(fVerbosityLevel > 0) std::cout<<"no cached "<<kind<<" in "<<fileName<<std::endl;
+        return nullptr;
+    }
+    // opening the file changes the current directory, which the splines are written to later on
+    TDirectory::TContext context;
+    TFile file(fileName.c_str());
+    if(!file.IsOpen()) {
+        std::cerr<<"Failed to open cache file "<<fileName<<", recalculating "<<kind<<"!"<<std::endl;
+        return nullptr;
+    }
+    TNamed* key = dynamic_cast<TNamed*>(file.Get("key"));
+    TSpline3* spline = dynamic_cast<TSpline3*>(file.Get("spline"));
+    if(key == nullptr || spline == nullptr || description != key->GetTitle()) {
+        std::cerr<<"Cache file "<<fileName<<" doesn't hold the "<<kind<<" for '"<<description<<"', recalculating it!"<<std::endl;
+        delete spline;
+        delete key;
+        return nullptr;
+    }
+    delete key;
+    file.Close();
+    if(fVerbosityLevel > 0) std::cout<<"loaded "<<kind<<" from "<<fileName<<std::endl;
+    return spline;
+}
+
+void TableCache::Store(const std::string& kind, const std::string& description, TSpline3* spline) {
+    if(!Enabled()) {
+        return;
+    }
+    if(gSystem->mkdir(fDirectory.c_str(), true) != 0 && gSystem->AccessPathName(fDirectory.c_str())) {
+        std::cerr<<"Failed to create cache directory "<<fDirectory<<", not caching "<<kind<<"!"<<std::endl;
+        return;
+    }
+    std::string fileName = FileName(kind, description);
+    // write to a temporary file first and rename it, so a job running in parallel never reads a partial file
+    std::ostringstream tmpName;
+    tmpName<<fileName<<".tmp"<<getpid();
+    TDirectory::TContext context;
+    TFile file(tmpName.str().c_str(), "recreate");
+    if(!file.IsOpen()) {
+        std::cerr<<"Failed to open cache file "<<tmpName.str()<<", not caching "<<kind<<"!"<<std::endl;
+        return;
+    }
+    TNamed key("key", description.c_str());
+    key.Write();
+    spline->Write("spline");
+    file.Close();
+    if(std::rename(tmpName.str().c_str(), fileName.c_str()) != 0) {
+        std::cerr<<"Failed to rename "<<tmpName.str()<<" to "<<fileName<<", not caching "<<kind<<"!"<<std::endl;
+        std::remove(tmpName.str().c_str());
+        return;
+    }
+    if(fVerbosityLevel > 0) std::cout<<"stored "<<kind<<" in "<<fileName<<std::endl;
+}
+
+TSpline3* TableCache::Energy2Range(Reconstruction* reconstruction, double emax, double size, bool gaseous) {
+    std::ostringstream description;
+    Describe(description, reconstruction);
+    description<<"; emax "<<emax<<"; size "<<size<<"; gaseous "<<gaseous;
+    TSpline3* spline = Load("Energy2Range", description.str());
+    if(spline == nullptr) {
+        spline = reconstruction->Energy2Range(emax, size, gaseous);
+        Store("Energy2Range", description.str(), spline);
+    }
+    return spline;
+}
+
+TSpline3* TableCache::Range2Energy(Reconstruction* reconstruction, double emax, double size, bool gaseous) {
+    std::ostringstream description;
+    Describe(description, reconstruction);
+    description<<"; emax "<<emax<<"; size "<<size<<"; gaseous "<<gaseous;
+    TSpline3* spline = Load("Range2Energy", description.str());
+    if(spline == nullptr) {
+        spline = reconstruction->Range2Energy(emax, size, gaseous);
+        Store("Range2Energy", description.str(), spline);
+    }
+    return spline;
+}
+
+TSpline3* TableCache::Thickness2EnergyAfter(Reconstruction* reconstruction, double energy, double maxThickness, double stepSize, bool gaseous) {
+    std::ostringstream description;
+    Describe(description, reconstruction);
+    description<<"; energy "<<energy<<"; thickness "<<maxThickness<<"; step "<<stepSize<<"; gaseous "<<gaseous;
+    TSpline3* spline = Load("Thickness2EnergyAfter", description.str());
+    if(spline == nullptr) {
+        spline = reconstruction->Thickness2EnergyAfter(energy, maxThickness, stepSize, gaseous);
+        Store("Thickness2EnergyAfter", description.str(), spline);
+    }
+    return spline;
+}
+
+TSpline3* TableCache::Evslab(Kinematics* kinematics, double thmin, double thmax, double size, int part, bool upper) {
+    std::ostringstream description;
+    description<<std::setprecision(17);
+    description<<"version "<<kVersion<<"; masses";
+    for(int i = 0; i < 4; ++i) {
+        description<<" "<<kinematics->GetM(i);
+    }
+    description<<"; Q "<<kinematics->GetQValue()<<"; beam energy "<<kinematics->GetEBeam()
+               <<"; theta "<<thmin<<" "<<thmax<<" "<<size<<"; part "<<part<<"; upper "<<upper;
+    TSpline3* spline = Load("Evslab", description.str());
+    if(spline == nullptr) {
+        spline = kinematics->Evslab(thmin, thmax, size, part, upper);
+        Store("Evslab", description.str(), spline);
+    }
+    return spline;
+}
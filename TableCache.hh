@@ -0,0 +1,42 @@
+#ifndef __TABLECACHE_HH
+#define __TABLECACHE_HH
+
+#include <string>
+#include <sstream>
+
+#include "TSpline.h"
+
+#include "Reconstruction.hh"
+#include "Kinematics.hh"
+
+// On-disk cache of the energy loss and kinematics splines. Each spline is stored in its own file in the cache directory,
+// named after a hash of everything it is calculated from (projectile, composition and density of the material,
+// thickness, grid), so a changed setup simply misses the cache. An empty directory disables the cache.
+class TableCache {
+public:
+    TableCache(const std::string& directory, int verbosityLevel);
+
+    // same as the Reconstruction and Kinematics functions, but loaded from the cache if it has been calculated before
+    TSpline3* Energy2Range(Reconstruction* reconstruction, double emax, double size, bool gaseous);
+    TSpline3* Range2Energy(Reconstruction* reconstruction, double emax, double size, bool gaseous);
+    TSpline3* Thickness2EnergyAfter(Reconstruction* reconstruction, double energy, double maxThickness, double stepSize, bool gaseous);
+    TSpline3* Evslab(Kinematics* kinematics, double thmin, double thmax, double size, int part = 2, bool upper = false);
+
+    bool Enabled() const {
+        return !fDirectory.empty();
+    }
+
+private:
+    // bump this whenever the calculation of the splines changes, so old cache files are not used any more
+    static const int kVersion = 1;
+
+    void Describe(std::ostringstream& description, Reconstruction* reconstruction);
+    std::string FileName(const std::string& kind, const std::string& description);
+    TSpline3* Load(const std::string& kind, const std::string& description);
+    void Store(const std::string& kind, const std::string& description, TSpline3* spline);
+
+    std::string fDirectory;
+    int fVerbosityLevel;
+};
+
+#endif
@@ -0,0 +1,66 @@
+#include "TabulatedFunction.hh"
+
+#include <iostream>
+#include <algorithm>
+#include <cmath>
+
+// no table gets more points than this, even if the tolerance isn't reached
+static const size_t kMaxNofPoints = 1<<22;
+
+TabulatedFunction::TabulatedFunction(TSpline3* spline, double tolerance, bool cubic)
+    : fCubic(cubic), fMaxError(0.) {
+    Sample(spline, spline->GetXmin(), spline->GetXmax(), tolerance);
+}
+
+TabulatedFunction::TabulatedFunction(TSpline3* spline, double xMin, double xMax, double tolerance, bool cubic)
+    : fCubic(cubic), fMaxError(0.) {
+    Sample(spline, xMin, xMax, tolerance);
+}
+
+TabulatedFunction::TabulatedFunction(const std::vector<double>& values, double xMin, double xMax, bool cubic)
+    : fValues(values), fCubic(cubic), fMaxError(0.) {
+    if(fValues.size() < 2) {
+        std::cerr<<"Need at least two values for a tabulated function, not "<<fValues.size()<<"!"<<std::endl;
+        fValues.resize(2, fValues.empty() ? 0. : fValues[0]);
+    }
+    SetGrid(xMin, xMax, fValues.size());
+}
+
+void TabulatedFunction::SetGrid(double xMin, double xMax, size_t nofPoints) {
+    fXmin = xMin;
+    fStep = (xMax - xMin)/(nofPoints - 1);
+    fInvStep = (fStep > 0.) ? 1./fStep : 0.;
+}
+
+void TabulatedFunction::Sample(TSpline3* spline, double xMin, double xMax, double tolerance) {
+    // start with about as many points as the spline has knots
+    size_t nofPoints = std::max(spline->GetNp(), 4);
+    double minValue = spline->Eval(xMin);
+    double maxValue = minValue;
+    while(true) {
+        SetGrid(xMin, xMax, nofPoints);
+        fValues.resize(nofPoints);
+        for(size_t i = 0; i < nofPoints; ++i) {
+            fValues[i] = spline->Eval(xMin + i*fStep);
+            minValue = std::min(minValue, fValues[i]);
+            maxValue = std::max(maxValue, fValues[i]);
+        }
+        // the interpolation is worst between the grid points, so check there
+        fMaxError = 0.;
+        for(size_t i = 0; i + 1 < nofPoints; ++i) {
+            for(double f = 0.25; f < 1.; f += 0.25) {
+                double x = xMin + (i + f)*fStep;
+                fMaxError = std::max(fMaxError, std::fabs(Eval(x) - spline->Eval(x)));
+            }
+        }
+        if(fMaxError <= tolerance*(maxValue - minValue)) {
+            break;
+        }
+        if(2*nofPoints - 1 > kMaxNofPoints) {
+            std::cerr<<"Tabulating spline "<<spline->GetName()<<" with "<<nofPoints<<" points only reaches a maximum deviation of "<<fMaxError<<", not "<<tolerance*(maxValue - minValue)<<"!"<<std::endl;
+            break;
+        }
+        // doubling the intervals keeps the old grid points
+        nofPoints = 2*nofPoints - 1;
+    }
+}
@@ -0,0 +1,69 @@
+#ifndef __TABULATEDFUNCTION_HH
+#define __TABULATEDFUNCTION_HH
+
+#include <vector>
+#include <cstddef>
+
+#include "TSpline.h"
+
+// Function sampled on a uniform grid: finding the interval is a single multiplication instead of the binary search
+// TSpline3::Eval does, and the interpolation is linear or cubic (Lagrange polynomial through the four closest points).
+// Outside of the grid the first/last interval is extrapolated linearly.
+class TabulatedFunction {
+public:
+    // Samples the spline between its first and last knot (or xMin and xMax), doubling the number of points until the
+    // interpolation deviates from the spline by no more than tolerance times the range of the function values.
+    TabulatedFunction(TSpline3* spline, double tolerance, bool cubic = true);
+    TabulatedFunction(TSpline3* spline, double xMin, double xMax, double tolerance, bool cubic = true);
+    // takes values already sampled on the uniform grid from xMin to xMax
+    TabulatedFunction(const std::vector<double>& values, double xMin, double xMax, bool cubic = true);
+
+    double Eval(double x) const {
+        double t = (x - fXmin)*fInvStep;
+        size_t last = fValues.size() - 1;
+        if(t <= 0.) {
+            return fValues[0] + t*(fValues[1] - fValues[0]);
+        }
+        if(t >= last) {
+            return fValues[last] + (t - last)*(fValues[last] - fValues[last-1]);
+        }
+        size_t i = static_cast<size_t>(t);
+        double f = t - i;
+        if(!fCubic || i == 0 || i + 2 > last) {
+            return fValues[i] + f*(fValues[i+1] - fValues[i]);
+        }
+        const double* p = &fValues[i-1];
+        return -f*(f - 1.)*(f - 2.)/6.*p[0] + (f + 1.)*(f - 1.)*(f - 2.)/2.*p[1]
+               - (f + 1.)*f*(f - 2.)/2.*p[2] + (f + 1.)*f*(f - 1.)/6.*p[3];
+    }
+
+    double GetXmin() const {
+        return fXmin;
+    }
+    double GetXmax() const {
+        return fXmin + (fValues.size() - 1)*fStep;
+    }
+    size_t GetNofPoints() const {
+        return fValues.size();
+    }
+    // largest deviation from the spline found while sampling it (0 if constructed from values)
+    double GetMaxError() const {
+        return fMaxError;
+    }
+    const std::vector<double>& GetValues() const {
+        return fValues;
+    }
+
+private:
+    void Sample(TSpline3* spline, double xMin, double xMax, double tolerance);
+    void SetGrid(double xMin, double xMax, size_t nofPoints);
+
+    double fXmin;
+    double fStep;
+    double fInvStep;
+    std::vector<double> fValues;
+    bool fCubic;
+    double fMaxError;
+};
+
+#endif